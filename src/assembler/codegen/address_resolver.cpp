@@ -1,4 +1,5 @@
 #include "address_resolver.h"
+#include "parallel_chunks.h"
 
 namespace lvm {
 namespace assembler {
@@ -38,11 +39,7 @@ namespace assembler {
         
         // Pass 1.5: Resolve DA (address array) references
         // This must be done after all data addresses are assigned
-        for (auto& block : graph_.data_blocks()) {
-            if (block->is_address_array()) {
-                resolve_address_array(block.get());
-            }
-        }
+        resolve_address_arrays();
         
         // Code segment addresses start at 0 (separate address space from data)
         code_segment_start_ = 0;
@@ -63,45 +60,99 @@ namespace assembler {
         }
     }
 
+    template <typename Fn>
+    void AddressResolver::for_each_chunk(size_t count, Fn&& fn) {
+        // One error list per chunk, appended in chunk order afterwards
+        unsigned threads = resolve_thread_count(thread_count_);
+        std::vector<std::vector<std::string>> chunk_errors(threads);
+        size_t chunks = parallel_chunks(count, threads, PARALLEL_MIN_CHUNK,
+                                        [&](size_t chunk, size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                fn(i, chunk_errors[chunk]);
+            }
+        });
+        
+        for (size_t chunk = 0; chunk < chunks; ++chunk) {
+            errors_.insert(errors_.end(), chunk_errors[chunk].begin(), chunk_errors[chunk].end());
+        }
+    }
+
+    void AddressResolver::resolve_address_arrays() {
+        auto& blocks = graph_.data_blocks();
+        for_each_chunk(blocks.size(), [&](size_t i, std::vector<std::string>& errors) {
+            if (blocks[i]->is_address_array()) {
+                resolve_address_array(blocks[i].get(), errors);
+            }
+        });
+    }
+
     void AddressResolver::resolve_operand_addresses() {
-        for (auto& node : graph_.code_nodes()) {
-            auto* instr = dynamic_cast<CodeInstructionNode*>(node.get());
-            if (!instr) continue;
-            
-            for (auto& operand : instr->operands()) {
-                if (operand.type == InstructionOperand::Type::ADDRESS) {
-                    // Simple symbol reference
-                    const Symbol* symbol = symbol_table_.get(operand.symbol_name);
-                    if (!symbol) {
-                        error("Undefined symbol '" + operand.symbol_name + "'");
-                        continue;
-                    }
-                    if (!symbol->address_resolved) {
-                        error("Symbol '" + operand.symbol_name + "' address not resolved");
-                        continue;
-                    }
-                    operand.address = symbol->address;
-                    
-                } else if (operand.type == InstructionOperand::Type::EXPRESSION) {
-                    // Complex expression: LABEL + offset + register
-                    operand.address = resolve_expression(operand);
+        auto& nodes = graph_.code_nodes();
+        for_each_chunk(nodes.size(), [&](size_t i, std::vector<std::string>& errors) {
+            if (auto* instr = dynamic_cast<CodeInstructionNode*>(nodes[i].get())) {
+                resolve_operands(instr, errors);
+            }
+        });
+    }
+
+    void AddressResolver::resolve_operands(CodeInstructionNode* instr, std::vector<std::string>& errors) const {
+        const SymbolTable& symbols = symbol_table_;
+        
+        for (auto& operand : instr->operands()) {
+            if (operand.type == InstructionOperand::Type::ADDRESS) {
+                // Simple symbol reference
+                const Symbol* symbol = symbols.get(operand.symbol_name);
+                if (!symbol) {
+                    errors.push_back("Undefined symbol '" + operand.symbol_name + "'");
+                    continue;
                 }
+                if (!symbol->address_resolved) {
+                    errors.push_back("Symbol '" + operand.symbol_name + "' address not resolved");
+                    continue;
+                }
+                operand.address = symbol->address;
+                
+            } else if (operand.type == InstructionOperand::Type::EXPRESSION) {
+                // Complex expression: LABEL + offset + register
+                operand.address = resolve_expression(operand, errors);
+            } else {
+                continue;
             }
+            
+            if (!operand.wide && beyond_paged_reach(operand.symbol_name, operand.address)) {
+                errors.push_back(instr->mnemonic() + ": '" + operand.symbol_name + "' resolves to data address " +
+                                 std::to_string(operand.address) +
+                                 ", past the 64KB a paged operand reaches; use LDX/STX");
+            }
+        }
+    }
+
+    bool AddressResolver::beyond_paged_reach(const std::string& symbol_name, uint32_t address) const {
+        // Paged operands encode only the low 16 bits; with linear addressing
+        // no PAGE switch supplies the rest, so they would just be dropped
+        if (!linear_addressing_ || address <= 0xFFFF || symbol_name.empty()) {
+            return false;
         }
+        const Symbol* symbol = symbol_table_.get(symbol_name);
+        return symbol && (symbol->type == SymbolType::DATA_BYTE ||
+                          symbol->type == SymbolType::DATA_WORD ||
+                          symbol->type == SymbolType::INLINE_DATA);
     }
 
-    uint32_t AddressResolver::resolve_expression(const InstructionOperand& operand) {
+    uint32_t AddressResolver::resolve_expression(const InstructionOperand& operand,
+                                                 std::vector<std::string>& errors) const {
+        const SymbolTable& symbols = symbol_table_;
         uint32_t base_address = 0;
         
         // Get base address from symbol
         if (!operand.symbol_name.empty()) {
-            const Symbol* symbol = symbol_table_.get(operand.symbol_name);
+            const Symbol* symbol = symbols.get(operand.symbol_name);
             if (!symbol) {
-                error("Undefined symbol '" + operand.symbol_name + "'");
+                errors.push_back("Undefined symbol '" + operand.symbol_name + "'");
                 return 0;
             }
             if (!symbol->address_resolved) {
-                error("Symbol '" + operand.symbol_name + "' address not resolved");
+                errors.push_back("Symbol '" + operand.symbol_name + "' address not resolved");
                 return 0;
             }
             base_address = symbol->address;
@@ -117,11 +168,13 @@ namespace assembler {
         return base_address;
     }
 
-    void AddressResolver::resolve_address_array(DataBlockNode* block) {
+    void AddressResolver::resolve_address_array(DataBlockNode* block,
+                                                std::vector<std::string>& errors) const {
         // Resolve DA (Define Address) array
         // The data block contains placeholder bytes (0x0000) for each address
         // We need to fill in the actual addresses based on label references
         
+        const SymbolTable& symbols = symbol_table_;
         auto& data = block->mutable_data();
         const auto& refs = block->address_references();
         
@@ -130,14 +183,21 @@ namespace assembler {
         
         for (const auto& label_ref : refs) {
             // Look up the symbol
-            const Symbol* symbol = symbol_table_.get(label_ref);
+            const Symbol* symbol = symbols.get(label_ref);
             if (!symbol) {
-                error("DA: Undefined label '" + label_ref + "' in array '" + block->label() + "'");
+                errors.push_back("DA: Undefined label '" + label_ref + "' in array '" + block->label() + "'");
                 continue;
             }
             
             if (!symbol->address_resolved) {
-                error("DA: Label '" + label_ref + "' address not resolved in array '" + block->label() + "'");
+                errors.push_back("DA: Label '" + label_ref + "' address not resolved in array '" + block->label() + "'");
+                continue;
+            }
+            
+            if (beyond_paged_reach(label_ref, symbol->address)) {
+                errors.push_back("DA: Label '" + label_ref + "' at data address " + std::to_string(symbol->address) +
+                                 " does not fit a 16-bit entry in array '" + block->label() + "'");
+                byte_offset += 2;
                 continue;
             }
             
@@ -150,9 +210,5 @@ namespace assembler {
         }
     }
 
-    void AddressResolver::error(const std::string& message) {
-        errors_.push_back(message);
-    }
-
 } // namespace assembler
 } // namespace lvm
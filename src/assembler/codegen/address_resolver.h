@@ -17,6 +17,11 @@ namespace assembler {
      * - Labels get code addresses
      * - Data definitions get data addresses
      * - Expression operands get resolved to absolute addresses
+     * 
+     * Layout is a serial prefix sum; the fix-ups that follow it (DA arrays
+     * and instruction operands) only read the finished symbol table, so they
+     * run over contiguous chunks on worker threads. Errors are collected per
+     * chunk and merged in chunk order, matching the serial report exactly.
      */
     class AddressResolver {
     public:
@@ -39,19 +44,43 @@ namespace assembler {
          */
         uint32_t code_segment_start() const { return code_segment_start_; }
         
+        /**
+         * Worker threads for post-layout fix-ups (0 = one per hardware thread,
+         * 1 = serial). Small graphs stay serial regardless.
+         */
+        void set_thread_count(unsigned threads) { thread_count_ = threads; }
+        unsigned thread_count() const { return thread_count_; }
+        
+        /**
+         * Linear data addressing: data may run past 64KB with no PAGE switch,
+         * so a 16-bit operand or DA entry naming data beyond the first 64KB
+         * is reported rather than truncated. Only LDX/STX operands are wide.
+         */
+        void set_linear_addressing(bool enabled) { linear_addressing_ = enabled; }
+        
+        // Minimum nodes per chunk before fix-up work is split across threads
+        static constexpr size_t PARALLEL_MIN_CHUNK = 512;
+        
     private:
         SymbolTable& symbol_table_;
         CodeGraph& graph_;
         std::vector<std::string> errors_;
         
         uint32_t code_segment_start_;
+        unsigned thread_count_ = 0;
+        bool linear_addressing_ = false;
         
-        void error(const std::string& message);
         void resolve_data_addresses();
         void resolve_code_addresses();
         void resolve_operand_addresses();
-        void resolve_address_array(DataBlockNode* block);
-        uint32_t resolve_expression(const InstructionOperand& operand);
+        void resolve_address_arrays();
+        void resolve_address_array(DataBlockNode* block, std::vector<std::string>& errors) const;
+        void resolve_operands(CodeInstructionNode* instr, std::vector<std::string>& errors) const;
+        uint32_t resolve_expression(const InstructionOperand& operand, std::vector<std::string>& errors) const;
+        bool beyond_paged_reach(const std::string& symbol_name, uint32_t address) const;
+        
+        template <typename Fn>
+        void for_each_chunk(size_t count, Fn&& fn);
     };
 
 } // namespace assembler
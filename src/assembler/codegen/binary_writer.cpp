@@ -1,7 +1,9 @@
 #include "binary_writer.h"
+#include "parallel_chunks.h"
 #include <fstream>
 #include <stdexcept>
 #include <cstring>
+#include <algorithm>
 
 namespace lvm {
 
@@ -71,46 +73,66 @@ std::vector<uint8_t> BinaryWriter::generate_binary(const CodeGraph& graph,
     // Write program name
     write_string(binary, truncated_program_name);
     
-    // Get data segment bytes
-    std::vector<uint8_t> data_segment;
-    for (const auto& data_block : graph.data_blocks()) {
-        const std::vector<uint8_t>& block_bytes = data_block->data();
-        data_segment.insert(data_segment.end(), block_bytes.begin(), block_bytes.end());
-    }
+    // Layout is final, so both segments can be sized before any encoding
+    uint32_t data_size = graph.data_segment_size();
+    uint32_t code_size = graph.code_segment_size();
     
     // Write data segment size (4 bytes, little-endian)
-    write_uint32(binary, static_cast<uint32_t>(data_segment.size()));
+    write_uint32(binary, data_size);
+    size_t data_offset = binary.size();
+    binary.resize(data_offset + data_size);
     
-    // Write data segment
-    for (uint8_t b : data_segment) {
-        binary.push_back(b);
-    }
+    // Write code segment size (4 bytes, little-endian)
+    write_uint32(binary, code_size);
+    size_t code_offset = binary.size();
+    binary.resize(code_offset + code_size);
     
-    // Get code segment bytes
-    std::vector<uint8_t> code_segment;
-    for (const auto& code_node : graph.code_nodes()) {
-        // Skip labels (they have size 0)
-        if (code_node->size() == 0) {
-            continue;
-        }
-        
-        // Cast to CodeInstructionNode to get encode() method
-        auto* instruction = dynamic_cast<assembler::CodeInstructionNode*>(code_node.get());
-        if (instruction) {
-            std::vector<uint8_t> node_bytes = instruction->encode();
-            code_segment.insert(code_segment.end(), node_bytes.begin(), node_bytes.end());
-        }
-    }
+    write_data_segment(graph, binary.data() + data_offset);
+    write_code_segment(graph, binary.data() + code_offset);
     
-    // Write code segment size (4 bytes, little-endian)
-    write_uint32(binary, static_cast<uint32_t>(code_segment.size()));
+    return binary;
+}
+
+void BinaryWriter::write_data_segment(const CodeGraph& graph, uint8_t* out) const {
+    const auto& blocks = graph.data_blocks();
+    
+    std::vector<uint32_t> offsets(blocks.size());
+    uint32_t offset = 0;
+    for (size_t i = 0; i < blocks.size(); ++i) {
+        offsets[i] = offset;
+        offset += blocks[i]->size();
+    }
     
-    // Write code segment
-    for (uint8_t b : code_segment) {
-        binary.push_back(b);
+    assembler::parallel_chunks(blocks.size(), assembler::resolve_thread_count(thread_count_), PARALLEL_MIN_CHUNK,
+                               [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::vector<uint8_t>& block_bytes = blocks[i]->data();
+            std::copy(block_bytes.begin(), block_bytes.end(), out + offsets[i]);
+        }
+    });
+}
+
+void BinaryWriter::write_code_segment(const CodeGraph& graph, uint8_t* out) const {
+    const auto& nodes = graph.code_nodes();
+    
+    // Prefix sum of node sizes gives each instruction its slot in the segment
+    std::vector<uint32_t> offsets(nodes.size());
+    uint32_t offset = 0;
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        offsets[i] = offset;
+        offset += nodes[i]->size();
     }
     
-    return binary;
+    assembler::parallel_chunks(nodes.size(), assembler::resolve_thread_count(thread_count_), PARALLEL_MIN_CHUNK,
+                               [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // Labels have no bytes; only instructions are encoded
+            auto* instruction = dynamic_cast<const assembler::CodeInstructionNode*>(nodes[i].get());
+            if (instruction) {
+                instruction->encode_into(out + offsets[i]);
+            }
+        }
+    });
 }
 
 void BinaryWriter::write_uint8(std::vector<uint8_t>& data, uint8_t value) {
@@ -17,6 +17,10 @@ using assembler::CodeGraph;
  * - Header with version, machine name/version, program name
  * - Data segment (size + bytes)
  * - Code segment (size + bytes)
+ *
+ * Segment sizes and per-node offsets are known once layout is done, so the
+ * output buffer is sized up front and nodes are encoded straight into their
+ * slots, in contiguous chunks across worker threads for large graphs.
  */
 class BinaryWriter {
 public:
@@ -43,8 +47,24 @@ public:
      */
     std::vector<uint8_t> generate_binary(const CodeGraph& graph,
                                          const std::string& program_name = "Program");
+    
+    /**
+     * Worker threads used to encode segments (0 = one per hardware thread,
+     * 1 = serial). Output is byte-identical whatever the count.
+     */
+    void set_thread_count(unsigned threads) { thread_count_ = threads; }
+    unsigned thread_count() const { return thread_count_; }
+    
+    // Minimum nodes per chunk before encoding is split across threads
+    static constexpr size_t PARALLEL_MIN_CHUNK = 1024;
 
 private:
+    unsigned thread_count_ = 0;
+    
+    // Encode segments into binary at offset, which must already be sized
+    void write_data_segment(const CodeGraph& graph, uint8_t* out) const;
+    void write_code_segment(const CodeGraph& graph, uint8_t* out) const;
+    
     // Write helper functions
     void write_uint8(std::vector<uint8_t>& data, uint8_t value);
     void write_uint16(std::vector<uint8_t>& data, uint16_t value);
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace lvm {
+namespace assembler {
+
+    /**
+     * Resolve a requested worker count: 0 means one per hardware thread
+     */
+    inline unsigned resolve_thread_count(unsigned requested) {
+        if (requested != 0) return requested;
+        unsigned hw = std::thread::hardware_concurrency();
+        return hw == 0 ? 1 : hw;
+    }
+
+    /**
+     * Split [0, count) into contiguous chunks and run fn(chunk, begin, end) on each
+     *
+     * Chunk boundaries depend only on count, thread count and min_chunk, so
+     * callers that merge per-chunk results by chunk index get the same
+     * output as a serial run. Chunk 0 runs on the calling thread. If any chunk
+     * throws, the exception from the lowest-numbered failing chunk is rethrown
+     * after all workers have joined.
+     *
+     * @return Number of chunks used (1 means the work ran serially)
+     */
+    template <typename Fn>
+    size_t parallel_chunks(size_t count, unsigned threads, size_t min_chunk, Fn&& fn) {
+        size_t max_chunks = min_chunk == 0 ? count : count / min_chunk;
+        size_t chunks = std::clamp<size_t>(max_chunks, 1, std::max(1u, threads));
+        if (chunks == 1) {
+            fn(size_t{0}, size_t{0}, count);
+            return 1;
+        }
+
+        size_t per_chunk = count / chunks;
+        size_t remainder = count % chunks;
+        auto bounds = [&](size_t chunk) {
+            size_t begin = chunk * per_chunk + std::min(chunk, remainder);
+            return std::make_pair(begin, begin + per_chunk + (chunk < remainder ? 1 : 0));
+        };
+
+        std::vector<std::exception_ptr> failures(chunks);
+        std::vector<std::thread> workers;
+        workers.reserve(chunks - 1);
+        for (size_t chunk = 1; chunk < chunks; ++chunk) {
+            workers.emplace_back([&, chunk] {
+                auto [begin, end] = bounds(chunk);
+                try {
+                    fn(chunk, begin, end);
+                } catch (...) {
+                    failures[chunk] = std::current_exception();
+                }
+            });
+        }
+
+        try {
+            auto [begin, end] = bounds(0);
+            fn(size_t{0}, begin, end);
+        } catch (...) {
+            failures[0] = std::current_exception();
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        for (auto& failure : failures) {
+            if (failure) std::rethrow_exception(failure);
+        }
+        return chunks;
+    }
+
+} // namespace assembler
+} // namespace lvm
@@ -33,7 +33,7 @@ namespace assembler {
                     total += 2;
                     break;
                 case InstructionOperand::Type::ADDRESS:
-                    total += 2;  // 16-bit address (matches encode() implementation)
+                    total += operand.wide ? 4 : 2;  // 16-bit address, 32-bit for linear forms (matches encode())
                     break;
                 case InstructionOperand::Type::REGISTER:
                     // Registers are encoded as 1 byte
@@ -41,7 +41,7 @@ namespace assembler {
                     break;
                 case InstructionOperand::Type::EXPRESSION:
                     // Complex expressions become addresses after resolution
-                    total += 2;  // 16-bit address (matches encode() implementation)
+                    total += operand.wide ? 4 : 2;  // 16-bit address, 32-bit for linear forms (matches encode())
                     break;
             }
         }
@@ -50,37 +50,47 @@ namespace assembler {
     }
 
     std::vector<uint8_t> CodeInstructionNode::encode() const {
-        std::vector<uint8_t> bytes;
-        bytes.push_back(opcode_);
+        std::vector<uint8_t> bytes(size());
+        encode_into(bytes.data());
+        return bytes;
+    }
+
+    uint32_t CodeInstructionNode::encode_into(uint8_t* out) const {
+        uint8_t* cursor = out;
+        *cursor++ = opcode_;
         
         for (const auto& operand : operands_) {
             switch (operand.type) {
                 case InstructionOperand::Type::IMMEDIATE_BYTE:
-                    bytes.push_back(static_cast<uint8_t>(operand.immediate_value));
+                    *cursor++ = static_cast<uint8_t>(operand.immediate_value);
                     break;
                     
                 case InstructionOperand::Type::IMMEDIATE_WORD:
                     // Little-endian
-                    bytes.push_back(static_cast<uint8_t>(operand.immediate_value & 0xFF));
-                    bytes.push_back(static_cast<uint8_t>((operand.immediate_value >> 8) & 0xFF));
+                    *cursor++ = static_cast<uint8_t>(operand.immediate_value & 0xFF);
+                    *cursor++ = static_cast<uint8_t>((operand.immediate_value >> 8) & 0xFF);
                     break;
                     
                 case InstructionOperand::Type::ADDRESS:
                 case InstructionOperand::Type::EXPRESSION:
-                    // For now, emit addresses as 16-bit values (page 0 only)
-                    // TODO: Support full 32-bit addresses when paging is implemented
-                    bytes.push_back(static_cast<uint8_t>(operand.address & 0xFF));
-                    bytes.push_back(static_cast<uint8_t>((operand.address >> 8) & 0xFF));
+                    // Paged forms take a 16-bit offset within the current page
+                    *cursor++ = static_cast<uint8_t>(operand.address & 0xFF);
+                    *cursor++ = static_cast<uint8_t>((operand.address >> 8) & 0xFF);
+                    if (operand.wide) {
+                        // Linear forms (LDX/STX) take the whole 32-bit data address
+                        *cursor++ = static_cast<uint8_t>((operand.address >> 16) & 0xFF);
+                        *cursor++ = static_cast<uint8_t>((operand.address >> 24) & 0xFF);
+                    }
                     break;
                     
                 case InstructionOperand::Type::REGISTER:
                     // Encode register as 1 byte
-                    bytes.push_back(register_name_to_code(operand.register_name));
+                    *cursor++ = register_name_to_code(operand.register_name);
                     break;
             }
         }
         
-        return bytes;
+        return static_cast<uint32_t>(cursor - out);
     }
 
     uint32_t CodeGraph::data_segment_size() const {
@@ -89,8 +89,10 @@ namespace assembler {
         std::string symbol_name;    // For EXPRESSION/ADDRESS (symbol reference)
         int32_t offset;             // For EXPRESSION (constant offset)
         std::string offset_register;// For EXPRESSION (register offset)
+        bool dereference;           // For EXPRESSION: [expr] operates on the memory there
+        bool wide;                  // For ADDRESS/EXPRESSION: 32-bit linear address (LDX/STX)
         
-        InstructionOperand() : type(Type::IMMEDIATE_BYTE), immediate_value(0), address(0), offset(0) {}
+        InstructionOperand() : type(Type::IMMEDIATE_BYTE), immediate_value(0), address(0), offset(0), dereference(false), wide(false) {}
     };
 
     /**
@@ -104,6 +106,14 @@ namespace assembler {
         const std::string& mnemonic() const { return mnemonic_; }
         uint8_t opcode() const { return opcode_; }
         
+        /**
+         * Replace the encoding (used by encoding selection before layout)
+         */
+        void set_encoding(const std::string& mnemonic, uint8_t opcode) {
+            mnemonic_ = mnemonic;
+            opcode_ = opcode;
+        }
+        
         void add_operand(const InstructionOperand& operand) {
             operands_.push_back(operand);
         }
@@ -118,6 +128,12 @@ namespace assembler {
          */
         std::vector<uint8_t> encode() const;
         
+        /**
+         * Encode instruction in place; out must have room for size() bytes
+         * @return Number of bytes written
+         */
+        uint32_t encode_into(uint8_t* out) const;
+        
     private:
         std::string mnemonic_;
         uint8_t opcode_;
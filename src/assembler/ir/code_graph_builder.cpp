@@ -105,9 +105,14 @@ namespace assembler {
             operands.push_back(current_operand_);
         }
         
+        // Linear forms (LDX/STX) carry the whole data address and never need a PAGE
+        std::string mnemonic = node.mnemonic();
+        bool linear = select_linear_form(mnemonic, operands, node);
+        
         // Check if any operand references a DATA symbol and inject PAGE instruction if needed
         // Only inject for data symbols (not code labels like CALL/JMP targets)
         for (const auto& op : operands) {
+            if (linear) break;
             if ((op.type == InstructionOperand::Type::ADDRESS || 
                  op.type == InstructionOperand::Type::EXPRESSION) && 
                 !op.symbol_name.empty()) {
@@ -126,11 +131,21 @@ namespace assembler {
             }
         }
         
+        // The ALU always targets AX, so an explicit "AX," destination has no encoding
+        if (is_accumulator_instruction(mnemonic) && operands.size() == 2 &&
+            operands[0].type == InstructionOperand::Type::REGISTER) {
+            std::string dest = operands[0].register_name;
+            std::transform(dest.begin(), dest.end(), dest.begin(), ::toupper);
+            if (dest == "AX") {
+                operands.erase(operands.begin());
+            }
+        }
+        
         // Get opcode with disambiguation based on operand types
-        uint8_t opcode = get_opcode_for_instruction_with_operands(node.mnemonic(), operands);
+        uint8_t opcode = get_opcode_for_instruction_with_operands(mnemonic, operands);
         
         // Check mnemonic for special handling
-        std::string upper_mnem = node.mnemonic();
+        std::string upper_mnem = mnemonic;
         std::transform(upper_mnem.begin(), upper_mnem.end(), upper_mnem.begin(), ::toupper);
         
         // Special handling for CALL: add return value flag byte (defaults to 0)
@@ -145,7 +160,7 @@ namespace assembler {
         }
         
         // Create instruction node
-        auto instr = std::make_unique<CodeInstructionNode>(node.mnemonic(), opcode);
+        auto instr = std::make_unique<CodeInstructionNode>(mnemonic, opcode);
         
         // Add operands to instruction
         for (const auto& op : operands) {
@@ -208,6 +223,7 @@ namespace assembler {
             case OperandNode::Type::MEMORY_ACCESS:
                 // Square brackets: [expression] - memory dereference
                 current_operand_.type = InstructionOperand::Type::EXPRESSION;
+                current_operand_.dereference = true;
                 node.expression()->accept(*this);
                 break;
                 
@@ -312,6 +328,75 @@ namespace assembler {
         errors_.emplace_back(message, line, column);
     }
 
+    bool CodeGraphBuilder::select_linear_form(std::string& mnemonic,
+                                              std::vector<InstructionOperand>& operands,
+                                              const InstructionNode& node) {
+        std::string upper = mnemonic;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        
+        auto is_address = [](const InstructionOperand& op) {
+            return op.type == InstructionOperand::Type::ADDRESS ||
+                   op.type == InstructionOperand::Type::EXPRESSION;
+        };
+        
+        // Explicit LDX/LDXL/STX/STXL: an address operand is always 32 bits wide,
+        // a register pair (hi, lo) takes the place of the address otherwise
+        if (upper == "LDX" || upper == "LDXL" || upper == "STX" || upper == "STXL") {
+            if (operands.size() == 2 && !is_address(operands[upper[0] == 'L' ? 1 : 0])) {
+                error(upper + " takes a data label, [address] or a register pair",
+                      node.line(), node.column());
+            }
+            for (auto& op : operands) {
+                if (!is_address(op)) continue;
+                if (!op.offset_register.empty()) {
+                    error(upper + " cannot add a register to a linear address; use a register pair",
+                          node.line(), node.column());
+                }
+                op.wide = true;
+            }
+            return true;
+        }
+        
+        if (!linear_addressing_ || operands.size() != 2) {
+            return false;
+        }
+        
+        // Direct loads and register stores to data become their linear form
+        static const std::pair<const char*, const char*> linear_forms[] = {
+            {"LDA", "LDX"}, {"LDAL", "LDXL"}, {"STA", "STX"}, {"STAL", "STXL"}
+        };
+        const char* linear_name = nullptr;
+        for (const auto& [paged, linear] : linear_forms) {
+            if (upper == paged) linear_name = linear;
+        }
+        if (!linear_name) {
+            return false;
+        }
+        
+        bool load = upper[0] == 'L';
+        InstructionOperand& address = operands[load ? 1 : 0];
+        const InstructionOperand& value = operands[load ? 0 : 1];
+        if (!is_address(address) || !address.offset_register.empty() ||
+            value.type != InstructionOperand::Type::REGISTER) {
+            return false;
+        }
+        
+        // Absolute numbers are data addresses already; symbols must name data
+        if (!address.symbol_name.empty()) {
+            const Symbol* symbol = symbol_table_.get(address.symbol_name);
+            if (!symbol ||
+                (symbol->type != SymbolType::DATA_BYTE &&
+                 symbol->type != SymbolType::DATA_WORD &&
+                 symbol->type != SymbolType::INLINE_DATA)) {
+                return false;
+            }
+        }
+        
+        mnemonic = linear_name;
+        address.wide = true;
+        return true;
+    }
+
     void CodeGraphBuilder::inject_page_instruction_if_needed(uint16_t target_page) {
         // Inject PAGE instruction if:
         // 1. Target page differs from last page, OR
@@ -439,6 +524,7 @@ namespace assembler {
         if (upper == "LDAB") return 0x0A;
         if (upper == "LDAH") return 0x0B;    // Multiple variants
         if (upper == "LDAL") return 0x0C;    // Multiple variants
+        if (upper == "STA") return 0x0D;
         
         // Stack operations
         if (upper == "PUSH") return 0x10;
@@ -563,6 +649,18 @@ namespace assembler {
         if (upper == "PUSHW") return 0x75;
         if (upper == "PUSHB") return 0x76;
         
+        // Register-mask push/pop
+        if (upper == "PUSHM") return 0xA8;
+        if (upper == "POPM") return 0xA9;
+        if (upper == "PUSHA") return 0xAA;
+        if (upper == "POPA") return 0xAB;
+        
+        // Linear data addressing (32-bit address forms; register pairs are +4)
+        if (upper == "LDX") return 0xAC;
+        if (upper == "LDXL") return 0xAD;
+        if (upper == "STX") return 0xAE;
+        if (upper == "STXL") return 0xAF;
+        
         // System call
         if (upper == "SYSCALL" || upper == "SYS") return 0x7F;
         
@@ -611,8 +709,115 @@ namespace assembler {
             }
         }
         
+        // LDX reg, hi, lo / STX hi, lo, reg address through a register pair
+        if ((upper == "LDX" || upper == "LDXL" || upper == "STX" || upper == "STXL") &&
+            operands.size() == 3) {
+            return get_opcode_for_instruction(upper) + 4;  // OPCODE_LDX_REG_PAIR_W ... OPCODE_STXL_PAIR_REG_B
+        }
+        
+        uint8_t memory_opcode = get_memory_operand_opcode(upper, operands);
+        if (memory_opcode != 0) {
+            return memory_opcode;
+        }
+        
+        uint8_t base = get_opcode_for_instruction(mnemonic);
+        bool register_source = !operands.empty() &&
+                               operands.back().type == InstructionOperand::Type::REGISTER;
+        
+        // Register-to-register loads follow their immediate form
+        if ((upper == "LD" || upper == "LDH" || upper == "LDL") && operands.size() >= 2 && register_source) {
+            return base + 1;  // OPCODE_LD_REG_REG_W / OPCODE_LDH_REG_REG_B / OPCODE_LDL_REG_REG_B
+        }
+        
+        // Compares against an immediate follow the register-register form
+        if ((upper == "CMP" || upper == "CPH" || upper == "CPL") && operands.size() >= 2 && !register_source) {
+            return base + 1;  // OPCODE_CMP_REG_IMM_W / OPCODE_CPH_REG_IMM_B / OPCODE_CPL_REG_IMM_B
+        }
+        
+        // Word ALU operations take a register in the slot after the immediate form
+        if (upper == "ADD" || upper == "SUB" || upper == "MUL" || upper == "DIV" || upper == "REM" ||
+            upper == "AND" || upper == "OR" || upper == "XOR" || upper == "SHL" || upper == "SHR" ||
+            upper == "ROL" || upper == "ROR") {
+            // A destination other than AX (an AX destination was already dropped)
+            // selects the extended form: OPCODE_ADD_REG_REG_W, then _REG_IMM_W
+            static const std::pair<const char*, uint8_t> register_destination[] = {
+                {"ADD", 0x90}, {"SUB", 0x92}, {"MUL", 0x94}, {"DIV", 0x96},
+                {"REM", 0x98}, {"AND", 0x9A}, {"OR", 0x9C}, {"XOR", 0x9E},
+                {"SHL", 0xA0}, {"SHR", 0xA2}, {"ROL", 0xA4}, {"ROR", 0xA6}
+            };
+            if (operands.size() == 2 && operands[0].type == InstructionOperand::Type::REGISTER &&
+                !operands[1].dereference) {
+                for (const auto& [name, opcode] : register_destination) {
+                    if (upper == name) return register_source ? opcode : opcode + 1;
+                }
+            }
+            if (register_source) {
+                return base + 1;  // e.g. OPCODE_ADD_REG_W
+            }
+        }
+        
         // For all other instructions, use base opcode lookup
-        return get_opcode_for_instruction(mnemonic);
+        return base;
+    }
+
+    uint8_t CodeGraphBuilder::get_memory_operand_opcode(
+        const std::string& upper,
+        const std::vector<InstructionOperand>& operands) {
+        
+        auto is_memory = [](const InstructionOperand& op) {
+            return op.type == InstructionOperand::Type::EXPRESSION && op.dereference;
+        };
+        auto is_immediate = [](const InstructionOperand& op) {
+            return op.type == InstructionOperand::Type::IMMEDIATE_WORD ||
+                   op.type == InstructionOperand::Type::IMMEDIATE_BYTE;
+        };
+        
+        // ADD AX, [addr] (the AX destination has already been dropped)
+        static const std::pair<const char*, uint8_t> memory_source[] = {
+            {"ADD", 0x80}, {"SUB", 0x81}, {"MUL", 0x82}, {"DIV", 0x83},
+            {"REM", 0x84}, {"AND", 0x85}, {"OR", 0x86}, {"XOR", 0x87}
+        };
+        // ADD [addr], immediate
+        static const std::pair<const char*, uint8_t> memory_destination[] = {
+            {"ADD", 0x88}, {"SUB", 0x89}, {"AND", 0x8A}, {"OR", 0x8B}, {"XOR", 0x8C}
+        };
+        
+        if (operands.size() == 1 && is_memory(operands[0])) {
+            if (upper == "INC") return 0x8D;  // OPCODE_INC_ADDR
+            if (upper == "DEC") return 0x8E;  // OPCODE_DEC_ADDR
+            for (const auto& [name, opcode] : memory_source) {
+                if (upper == name) return opcode;
+            }
+        }
+        
+        if (operands.size() == 2 && is_memory(operands[0]) && is_immediate(operands[1])) {
+            for (const auto& [name, opcode] : memory_destination) {
+                if (upper == name) return opcode;
+            }
+        }
+        
+        // STA addr, immediate (with or without brackets)
+        if (upper == "STA" && operands.size() == 2 && is_immediate(operands[1])) {
+            return 0x8F;  // OPCODE_STA_ADDR_IMM_W
+        }
+        
+        return 0;
+    }
+
+    bool CodeGraphBuilder::is_accumulator_instruction(const std::string& mnemonic) const {
+        std::string upper = mnemonic;
+        std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+        
+        // Arithmetic, logic, shift and rotate families (AX = AX op src)
+        static const char* const ops[] = {
+            "ADD", "ADB", "ADH", "ADL", "SUB", "SBB", "SBH", "SBL",
+            "MUL", "MLB", "MLH", "MLL", "DIV", "DVB", "DVH", "DVL",
+            "REM", "RMB", "RMH", "RML", "AND", "ANB", "ANH", "ANL",
+            "OR", "ORB", "ORH", "ORL", "XOR", "XOB", "XOH", "XOL",
+            "SHL", "SLB", "SLH", "SLL", "SHR", "SHRB", "SHRH", "SHRL",
+            "ROL", "ROLB", "ROLH", "ROLL", "ROR", "RORB", "RORH", "RORL"
+        };
+        return std::find(std::begin(ops), std::end(ops), upper) != std::end(ops);
     }
 
     bool CodeGraphBuilder::instruction_expects_word_immediate(const std::string& mnemonic) const {
@@ -638,6 +843,7 @@ namespace assembler {
                 upper == "ROL" ||     // ROL AX, immediate16
                 upper == "ROR" ||     // ROR AX, immediate16
                 upper == "CMP" ||     // CMP reg, immediate16
+                upper == "STA" ||     // STA [addr], immediate16
                 upper == "PAGE");     // PAGE immediate16
     }
 
@@ -649,6 +855,8 @@ namespace assembler {
         return (upper == "LDH" ||     // LDH reg, immediate8
                 upper == "LDL" ||     // LDL reg, immediate8
                 upper == "PUSHB" ||   // PUSHB immediate8
+                upper == "PUSHM" ||   // PUSHM mask8
+                upper == "POPM" ||    // POPM mask8
                 upper == "ADB" ||     // ADB AX, immediate8
                 upper == "SBB" ||     // SBB AX, immediate8
                 upper == "MLB" ||     // MLB AX, immediate8
@@ -55,6 +55,13 @@ namespace assembler {
         const std::vector<CodeGraphError>& errors() const { return errors_; }
         bool has_errors() const { return !errors_.empty(); }
         
+        /**
+         * Linear data addressing: direct LDA/LDAL/STA/STAL accesses to data
+         * are emitted as LDX/LDXL/STX/STXL with a 32-bit address and no PAGE
+         */
+        void set_linear_addressing(bool enabled) { linear_addressing_ = enabled; }
+        bool linear_addressing() const { return linear_addressing_; }
+        
         // Visitor methods
         void visit(ProgramNode& node) override;
         void visit(DataSectionNode& node) override;
@@ -86,15 +93,24 @@ namespace assembler {
         // Anonymous data counter
         uint32_t anonymous_counter_;
         
+        bool linear_addressing_ = false;
+        
         // Helper methods
         void error(const std::string& message, size_t line, size_t column);
         void inject_page_instruction_if_needed(uint16_t target_page);
+        // Picks the LDX/STX family for an instruction; true if it addresses data linearly
+        bool select_linear_form(std::string& mnemonic, std::vector<InstructionOperand>& operands,
+                                const InstructionNode& node);
         std::vector<uint8_t> data_definition_to_bytes(const DataDefinitionNode& node);
         std::vector<uint8_t> inline_data_to_bytes(const InlineDataNode& node);
         std::vector<uint8_t> string_to_bytes(const std::string& str);
         uint8_t get_opcode_for_instruction(const std::string& mnemonic);
         uint8_t get_opcode_for_instruction_with_operands(const std::string& mnemonic, 
                                                          const std::vector<InstructionOperand>& operands);
+        // Extended memory-operand forms ([addr] operands); 0 if none applies
+        uint8_t get_memory_operand_opcode(const std::string& upper,
+                                          const std::vector<InstructionOperand>& operands);
+        bool is_accumulator_instruction(const std::string& mnemonic) const;
         bool instruction_expects_word_immediate(const std::string& mnemonic) const;
         bool instruction_expects_byte_immediate(const std::string& mnemonic) const;
     };
@@ -0,0 +1,609 @@
+#include "dataflow_optimizer.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace lvm {
+namespace assembler {
+
+    namespace {
+        // Opcodes the optimizer gives special treatment (see opcodes.h)
+        constexpr uint8_t OP_LD_REG_IMM = 0x02;
+        constexpr uint8_t OP_LD_REG_REG = 0x03;
+        constexpr uint8_t OP_STA = 0x0D;
+        constexpr uint8_t OP_STAH = 0x0E;
+        constexpr uint8_t OP_STAL = 0x0F;
+        constexpr uint8_t OP_FIRST_ALU = 0x29;     // ADD imm
+        constexpr uint8_t OP_FIRST_TRAPPING = 0x38;  // DIV imm
+        constexpr uint8_t OP_LAST_TRAPPING = 0x41;   // RML
+        constexpr uint8_t OP_FIRST_NOT = 0x51;
+        constexpr uint8_t OP_LAST_NOT = 0x55;
+        constexpr uint8_t OP_LAST_ALU = 0x69;      // RORL
+        constexpr uint8_t OP_FIRST_MEM_SOURCE = 0x80;  // ADD AX, [addr]
+        constexpr uint8_t OP_LAST_MEM_SOURCE = 0x87;   // XOR AX, [addr]
+        constexpr uint8_t OP_FIRST_MEM_UPDATE = 0x88;  // ADD [addr], imm
+        constexpr uint8_t OP_LAST_MEM_UPDATE = 0x8E;   // DEC [addr]
+        constexpr uint8_t OP_STA_IMM = 0x8F;
+        constexpr uint8_t OP_FIRST_REG_DEST = 0x90;    // ADD reg, reg
+        constexpr uint8_t OP_FIRST_REG_DEST_TRAPPING = 0x96;  // DIV reg, reg
+        constexpr uint8_t OP_LAST_REG_DEST_TRAPPING = 0x99;   // REM reg, imm
+        constexpr uint8_t OP_LAST_REG_DEST = 0xA7;     // ROR reg, imm
+        constexpr uint8_t OP_STX = 0xAE;               // STX addr32, reg
+        constexpr uint8_t OP_STXL = 0xAF;
+
+        constexpr uint8_t AX_BIT = 1u << 0;
+        constexpr uint8_t EVERYTHING = DataflowOptimizer::ALL_REGISTERS | DataflowOptimizer::FLAGS_BIT;
+
+        // Repeat until a fixed point; each round exposes the next link of a chain
+        constexpr int MAX_ROUNDS = 16;
+
+        int register_index(const std::string& name) {
+            char first = static_cast<char>(std::toupper(name.empty() ? 0 : name[0]));
+            if (first >= 'A' && first <= 'E') {
+                return first - 'A';
+            }
+            return -1;
+        }
+
+        uint8_t register_bit(const std::string& name) {
+            int index = register_index(name);
+            return index < 0 ? 0 : static_cast<uint8_t>(1u << index);
+        }
+
+        // Copies are tracked as (destination, source) register pairs
+        uint32_t copy_bit(int dst, int src) {
+            return 1u << (dst * DataflowOptimizer::REGISTER_COUNT + src);
+        }
+
+        constexpr uint32_t ALL_COPIES = (1u << (DataflowOptimizer::REGISTER_COUNT * DataflowOptimizer::REGISTER_COUNT)) - 1;
+
+        uint32_t kill_copies(uint32_t copies, uint8_t defs) {
+            for (int reg = 0; reg < DataflowOptimizer::REGISTER_COUNT; ++reg) {
+                if (!(defs & (1u << reg))) {
+                    continue;
+                }
+                for (int other = 0; other < DataflowOptimizer::REGISTER_COUNT; ++other) {
+                    copies &= ~(copy_bit(reg, other) | copy_bit(other, reg));
+                }
+            }
+            return copies;
+        }
+
+        bool is_self_copy(const CodeInstructionNode& node) {
+            const auto& ops = node.operands();
+            return node.opcode() == OP_LD_REG_REG && ops.size() == 2 &&
+                   register_index(ops[0].register_name) >= 0 &&
+                   register_index(ops[0].register_name) == register_index(ops[1].register_name);
+        }
+    }
+
+    uint32_t DataflowOptimizer::optimize(CodeGraph& graph) {
+        removed_count_ = 0;
+        propagated_count_ = 0;
+        dead_store_count_ = 0;
+        uint32_t before = graph.code_segment_size();
+
+        for (int round = 0; round < MAX_ROUNDS; ++round) {
+            if (!build(graph)) {
+                break;
+            }
+            compute_liveness();
+            size_t renamed = propagate_copies();
+            propagated_count_ += renamed;
+            if (renamed > 0) {
+                // Renaming shortens live ranges; redo liveness before removing
+                build(graph);
+                compute_liveness();
+            }
+
+            std::vector<bool> dead_writes = find_dead_writes();
+            std::vector<bool> dead_stores = find_dead_stores();
+            std::unordered_set<const CodeGraphNode*> dead;
+            for (size_t i = 0; i < instructions_.size(); ++i) {
+                if (dead_writes[i]) {
+                    dead.insert(instructions_[i].node);
+                    removed_count_++;
+                } else if (dead_stores[i]) {
+                    dead.insert(instructions_[i].node);
+                    dead_store_count_++;
+                }
+            }
+            if (dead.empty() && renamed == 0) {
+                break;
+            }
+            std::erase_if(graph.code_nodes(), [&dead](const std::unique_ptr<CodeGraphNode>& node) {
+                return dead.count(node.get()) > 0;
+            });
+        }
+
+        instructions_.clear();
+        return before - graph.code_segment_size();
+    }
+
+    bool DataflowOptimizer::build(CodeGraph& graph) {
+        instructions_.clear();
+        block_start_.clear();
+        label_targets_.clear();
+
+        bool after_label = false;
+        for (auto& node : graph.code_nodes()) {
+            if (auto* label = dynamic_cast<CodeLabelNode*>(node.get())) {
+                label_targets_[label->name()] = instructions_.size();
+                after_label = true;
+            } else if (auto* instr = dynamic_cast<CodeInstructionNode*>(node.get())) {
+                Instruction entry;
+                entry.node = instr;
+                classify(entry);
+                instructions_.push_back(std::move(entry));
+                block_start_.push_back(after_label);
+                after_label = false;
+            }
+        }
+        return link_successors();
+    }
+
+    void DataflowOptimizer::classify(Instruction& instr) {
+        const auto& ops = instr.node->operands();
+        uint8_t opcode = instr.node->opcode();
+
+        // Registers named inside address expressions are only read
+        for (const auto& operand : ops) {
+            if (operand.type == InstructionOperand::Type::EXPRESSION && !operand.offset_register.empty()) {
+                instr.uses |= register_bit(operand.offset_register);
+            }
+        }
+
+        auto reg = [&ops](size_t i) -> uint8_t {
+            return i < ops.size() && ops[i].type == InstructionOperand::Type::REGISTER
+                ? register_bit(ops[i].register_name) : 0;
+        };
+        auto use = [&](size_t i) {
+            if (reg(i)) {
+                instr.uses |= reg(i);
+                instr.use_operands.push_back(i);
+            }
+        };
+        auto def = [&](size_t i) { instr.defs |= reg(i); };
+        // Partial writes (one byte, increments) keep the rest of the register
+        auto use_def = [&](size_t i) {
+            instr.uses |= reg(i);
+            instr.defs |= reg(i);
+        };
+        // A mask that is not a literal may name any register
+        auto register_mask = [&ops]() -> uint8_t {
+            bool literal = !ops.empty() && (ops[0].type == InstructionOperand::Type::IMMEDIATE_BYTE ||
+                                            ops[0].type == InstructionOperand::Type::IMMEDIATE_WORD);
+            return literal ? ops[0].immediate_value & ALL_REGISTERS : ALL_REGISTERS;
+        };
+        auto opaque = [&]() {
+            instr.uses = EVERYTHING;
+            instr.defs = EVERYTHING;
+            instr.use_operands.clear();
+            instr.removable = false;
+            instr.reads_memory = true;
+            instr.barrier = true;
+        };
+
+        switch (opcode) {
+            case 0x00:  // NOP
+                return;
+            case 0x01:  // HALT
+                instr.flow = Flow::HALT;
+                instr.barrier = true;
+                return;
+            case OP_LD_REG_IMM:
+                def(0);
+                instr.removable = true;
+                return;
+            case OP_LD_REG_REG:
+                def(0);
+                use(1);
+                instr.removable = true;
+                return;
+            case 0x04:  // SWP
+                use_def(0);
+                use_def(1);
+                instr.removable = true;
+                return;
+            case 0x05: case 0x07:  // LDH/LDL reg, imm
+                use_def(0);
+                instr.removable = true;
+                return;
+            case 0x06: case 0x08:  // LDH/LDL reg, reg
+                use_def(0);
+                use(1);
+                instr.removable = true;
+                return;
+            case 0x09:  // LDA reg, addr
+                def(0);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0x0B: case 0x0C:  // LDAH/LDAL reg, addr
+                use_def(0);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case OP_STA: case OP_STAH: case OP_STAL:
+                use(1);
+                return;
+            case 0xAC:  // LDX reg, addr32
+                def(0);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0xAD:  // LDXL reg, addr32
+                use_def(0);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case OP_STX: case OP_STXL:
+                use(1);
+                return;
+            case 0xB0:  // LDX reg, hi, lo
+                def(0);
+                use(1);
+                use(2);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0xB1:  // LDXL reg, hi, lo
+                use_def(0);
+                use(1);
+                use(2);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0xB2: case 0xB3:  // STX/STXL hi, lo, reg
+                use(0);
+                use(1);
+                use(2);
+                return;
+            case 0x72:  // LDA reg, [reg]
+                if (!reg(0)) {
+                    break;  // Not a register destination: leave it alone
+                }
+                def(0);
+                use(1);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0x73: case 0x74:  // LDAH/LDAL reg, [reg]
+                if (!reg(0)) {
+                    break;
+                }
+                use_def(0);
+                use(1);
+                instr.reads_memory = true;
+                instr.removable = true;
+                return;
+            case 0x10: case 0x11: case 0x12:  // PUSH/PUSHH/PUSHL
+                use(0);
+                return;
+            case 0x13: case 0x16: case 0x17:  // POP, PEEK, PEEKF (stack bounds are checked)
+                def(0);
+                return;
+            case 0x14: case 0x15: case 0x18: case 0x19:  // POPH/POPL, PEEKB/PEEKFB
+                use_def(0);
+                return;
+            case 0x1A: case 0x1D: case 0x75: case 0x76:  // FLSH, SETF, PUSHW, PUSHB
+                return;
+            case 0xA8:  // PUSHM mask: bit n is register n, like the bit sets here
+                instr.uses |= register_mask();
+                return;
+            case 0xA9:  // POPM mask
+                instr.defs |= register_mask();
+                return;
+            case 0xAA:  // PUSHA
+                instr.uses |= ALL_REGISTERS;
+                return;
+            case 0xAB:  // POPA
+                instr.defs |= ALL_REGISTERS;
+                return;
+            case 0x1B:  // PAGE imm: later addresses mean something else
+                instr.barrier = true;
+                return;
+            case 0x1C:  // PAGE reg
+                use(0);
+                instr.barrier = true;
+                return;
+            case 0x1E:  // JMP
+                instr.flow = Flow::JUMP;
+                instr.barrier = true;
+                return;
+            case 0x27:  // CALL: arguments and results may travel in any register
+                instr.flow = Flow::CALL;
+                instr.uses = EVERYTHING;
+                instr.defs = EVERYTHING;
+                instr.reads_memory = true;
+                instr.barrier = true;
+                return;
+            case 0x28:  // RET: the caller may read any register
+                instr.flow = Flow::RETURN;
+                instr.uses = EVERYTHING;
+                instr.barrier = true;
+                return;
+            case 0x6A: case 0x6B:  // INC/DEC
+                use_def(0);
+                instr.defs |= FLAGS_BIT;
+                instr.removable = true;
+                return;
+            case 0x6C: case 0x6E: case 0x70:  // CMP/CPH/CPL reg, reg
+                // AX is loaded with the left operand before the right one is
+                // read, so a right-hand AX reads the left operand. The right
+                // operand is therefore never renamed.
+                use(0);
+                if (reg(1) != AX_BIT) {
+                    instr.uses |= reg(1);
+                }
+                instr.defs |= AX_BIT | FLAGS_BIT;
+                instr.removable = true;
+                return;
+            case 0x6D: case 0x6F: case 0x71:  // CMP/CPH/CPL reg, imm
+                use(0);
+                instr.defs |= AX_BIT | FLAGS_BIT;
+                instr.removable = true;
+                return;
+            case 0x7F:  // SYS: reads guest memory and the stack, not registers
+                instr.reads_memory = true;
+                instr.barrier = true;
+                return;
+            default:
+                break;
+        }
+
+        if (opcode >= 0x1F && opcode <= 0x26) {  // Conditional jumps
+            instr.flow = Flow::BRANCH;
+            instr.uses |= FLAGS_BIT;
+            instr.barrier = true;
+            return;
+        }
+
+        if (opcode >= OP_FIRST_MEM_SOURCE && opcode <= OP_LAST_MEM_SOURCE) {
+            // AX = AX op [addr]; DIV and REM trap on zero
+            instr.uses |= AX_BIT;
+            instr.defs |= AX_BIT | FLAGS_BIT;
+            instr.reads_memory = true;
+            instr.removable = opcode != 0x83 && opcode != 0x84;
+            return;
+        }
+
+        if (opcode >= OP_FIRST_MEM_UPDATE && opcode <= OP_LAST_MEM_UPDATE) {
+            // [addr] = [addr] op imm: reads the old value, so never a dead store
+            instr.defs |= FLAGS_BIT;
+            instr.reads_memory = true;
+            return;
+        }
+
+        if (opcode == OP_STA_IMM) {
+            return;
+        }
+
+        if (opcode >= OP_FIRST_REG_DEST && opcode <= OP_LAST_REG_DEST) {
+            // reg = reg op src, where even opcodes take a source register
+            use_def(0);
+            if ((opcode & 1) == 0) {
+                use(1);
+            }
+            instr.defs |= FLAGS_BIT;
+            instr.removable = opcode < OP_FIRST_REG_DEST_TRAPPING || opcode > OP_LAST_REG_DEST_TRAPPING;
+            return;
+        }
+
+        if (opcode >= OP_FIRST_ALU && opcode <= OP_LAST_ALU && ops.size() <= 1) {
+            // AX = AX op src (NOT: AX = op src)
+            bool is_not = opcode >= OP_FIRST_NOT && opcode <= OP_LAST_NOT;
+            if (!is_not) {
+                instr.uses |= AX_BIT;
+            }
+            use(0);
+            instr.defs |= AX_BIT | FLAGS_BIT;
+            instr.removable = opcode < OP_FIRST_TRAPPING || opcode > OP_LAST_TRAPPING;
+            return;
+        }
+
+        opaque();
+    }
+
+    bool DataflowOptimizer::link_successors() {
+        if (!instructions_.empty()) {
+            instructions_[0].entry = true;
+        }
+        for (size_t i = 0; i < instructions_.size(); ++i) {
+            Instruction& instr = instructions_[i];
+            bool falls_through = instr.flow == Flow::NEXT || instr.flow == Flow::BRANCH || instr.flow == Flow::CALL;
+            if (falls_through && i + 1 < instructions_.size()) {
+                instr.successors.push_back(i + 1);
+            }
+            if (instr.flow != Flow::JUMP && instr.flow != Flow::BRANCH && instr.flow != Flow::CALL) {
+                continue;
+            }
+
+            // The target must be a plain code label; anything else could land anywhere
+            const InstructionOperand* target = nullptr;
+            for (const auto& operand : instr.node->operands()) {
+                if (operand.type == InstructionOperand::Type::ADDRESS ||
+                    operand.type == InstructionOperand::Type::EXPRESSION) {
+                    target = &operand;
+                    break;
+                }
+            }
+            if (!target || target->offset != 0 || !target->offset_register.empty()) {
+                return false;
+            }
+            auto it = label_targets_.find(target->symbol_name);
+            if (it == label_targets_.end()) {
+                return false;
+            }
+            if (it->second >= instructions_.size()) {
+                continue;  // Label at the very end: execution runs off the code
+            }
+            if (instr.flow == Flow::CALL) {
+                instructions_[it->second].entry = true;
+            } else {
+                instr.successors.push_back(it->second);
+            }
+        }
+        return true;
+    }
+
+    void DataflowOptimizer::compute_liveness() {
+        // Backward dataflow to a fixed point: in = use + (out - def)
+        std::vector<uint8_t> live_in(instructions_.size(), 0);
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = instructions_.size(); i-- > 0;) {
+                Instruction& instr = instructions_[i];
+                uint8_t out = 0;
+                for (size_t succ : instr.successors) {
+                    out |= live_in[succ];
+                }
+                uint8_t in = static_cast<uint8_t>(instr.uses | (out & ~instr.defs));
+                if (in != live_in[i] || out != instr.live_out) {
+                    live_in[i] = in;
+                    instr.live_out = out;
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    size_t DataflowOptimizer::propagate_copies() {
+        // Forward dataflow over available copies: a copy (dst, src) holds on
+        // entry to an instruction when every path to it executed LD dst, src
+        // and wrote neither register since
+        size_t count = instructions_.size();
+        std::vector<std::vector<size_t>> predecessors(count);
+        for (size_t i = 0; i < count; ++i) {
+            for (size_t succ : instructions_[i].successors) {
+                predecessors[succ].push_back(i);
+            }
+        }
+
+        auto transfer = [this](size_t i, uint32_t in) {
+            const Instruction& instr = instructions_[i];
+            uint32_t out = kill_copies(in, instr.defs);
+            const auto& ops = instr.node->operands();
+            if (instr.node->opcode() == OP_LD_REG_REG && ops.size() == 2) {
+                int dst = register_index(ops[0].register_name);
+                int src = register_index(ops[1].register_name);
+                if (dst >= 0 && src >= 0 && dst != src) {
+                    out |= copy_bit(dst, src);
+                }
+            }
+            return out;
+        };
+
+        std::vector<uint32_t> available_in(count);
+        for (size_t i = 0; i < count; ++i) {
+            bool unknown_entry = instructions_[i].entry || predecessors[i].empty();
+            available_in[i] = unknown_entry ? 0 : ALL_COPIES;
+        }
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = 0; i < count; ++i) {
+                if (instructions_[i].entry || predecessors[i].empty()) {
+                    continue;
+                }
+                uint32_t in = ALL_COPIES;
+                for (size_t pred : predecessors[i]) {
+                    in &= transfer(pred, available_in[pred]);
+                }
+                if (in != available_in[i]) {
+                    available_in[i] = in;
+                    changed = true;
+                }
+            }
+        }
+
+        size_t renamed = 0;
+        for (size_t i = 0; i < count; ++i) {
+            Instruction& instr = instructions_[i];
+            uint32_t copies = available_in[i];
+            if (copies == 0) {
+                continue;
+            }
+            for (size_t index : instr.use_operands) {
+                InstructionOperand& operand = instr.node->operands()[index];
+                int reg = register_index(operand.register_name);
+                for (int src = 0; src < REGISTER_COUNT; ++src) {
+                    if (copies & copy_bit(reg, src)) {
+                        // Keep the H/L/X suffix so byte operands stay byte operands
+                        std::string name = operand.register_name;
+                        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+                        name[0] = static_cast<char>('A' + src);
+                        operand.register_name = name;
+                        renamed++;
+                        break;
+                    }
+                }
+            }
+        }
+        return renamed;
+    }
+
+    std::vector<bool> DataflowOptimizer::find_dead_writes() const {
+        std::vector<bool> dead(instructions_.size(), false);
+        for (size_t i = 0; i < instructions_.size(); ++i) {
+            const Instruction& instr = instructions_[i];
+            if (is_self_copy(*instr.node)) {
+                dead[i] = true;
+            } else if (instr.removable && instr.defs != 0 && (instr.defs & instr.live_out) == 0) {
+                dead[i] = true;
+            }
+        }
+        return dead;
+    }
+
+    std::vector<bool> DataflowOptimizer::find_dead_stores() const {
+        struct PendingStore {
+            size_t index;
+            const std::string* symbol;
+            int32_t first;
+            int32_t last;
+        };
+
+        std::vector<bool> dead(instructions_.size(), false);
+        std::vector<PendingStore> pending;
+        for (size_t i = 0; i < instructions_.size(); ++i) {
+            const Instruction& instr = instructions_[i];
+            if (block_start_[i]) {
+                pending.clear();  // Reachable from elsewhere
+            }
+            uint8_t opcode = instr.node->opcode();
+            if (opcode != OP_STA && opcode != OP_STAH && opcode != OP_STAL && opcode != OP_STA_IMM &&
+                opcode != OP_STX && opcode != OP_STXL) {
+                if (instr.reads_memory || instr.barrier) {
+                    pending.clear();
+                }
+                continue;
+            }
+
+            const auto& address = instr.node->operands()[0];
+            if (address.type != InstructionOperand::Type::ADDRESS &&
+                address.type != InstructionOperand::Type::EXPRESSION) {
+                pending.clear();
+                continue;
+            }
+            if (!address.offset_register.empty()) {
+                continue;  // Unknown address: cannot kill, but does not read either
+            }
+            int32_t first = address.offset;
+            int32_t last = first + (opcode == OP_STA || opcode == OP_STA_IMM || opcode == OP_STX ? 1 : 0);
+
+            std::erase_if(pending, [&](const PendingStore& store) {
+                bool covered = *store.symbol == address.symbol_name && store.first >= first && store.last <= last;
+                if (covered) {
+                    dead[store.index] = true;
+                }
+                return covered;
+            });
+            pending.push_back({i, &address.symbol_name, first, last});
+        }
+        return dead;
+    }
+
+} // namespace assembler
+} // namespace lvm
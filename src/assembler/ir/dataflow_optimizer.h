@@ -0,0 +1,90 @@
+#pragma once
+
+#include "code_graph.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvm {
+namespace assembler {
+
+    /**
+     * Data-flow optimizer (Pass 3.3, -O2)
+     *
+     * Works on the control-flow graph of the code section (fall-through,
+     * jumps and branches between instructions) and repeats until nothing
+     * changes:
+     * - Copy propagation: after LD dst, src, later reads of dst that are
+     *   reached only while both registers still hold that copy read src
+     *   instead, so LD chains collapse onto their source
+     * - Dead register writes: instructions whose only effect is writing
+     *   registers or flags that are never read afterwards are removed
+     * - Dead stores: a store to a fixed data address that is overwritten
+     *   later in the same basic block, with no load, syscall or PAGE in
+     *   between, is removed
+     *
+     * Conventions: CALL may read and clobber every register and the flags,
+     * and every register and the flags are live at RET, since subroutines
+     * take and return values in registers. SYS reads memory and the stack
+     * but leaves registers alone. DIV and REM, which trap on zero, and
+     * anything that touches the stack, memory or control flow are never
+     * removed. Opcodes the optimizer does not model are treated as reading
+     * and writing everything. If a jump target cannot be tied to a code
+     * label the graph is left untouched.
+     */
+    class DataflowOptimizer {
+    public:
+        DataflowOptimizer() = default;
+
+        /**
+         * Optimize the code section of the graph in place
+         * @return Number of code bytes saved
+         */
+        uint32_t optimize(CodeGraph& graph);
+
+        size_t removed_count() const { return removed_count_; }
+        size_t propagated_count() const { return propagated_count_; }
+        size_t dead_store_count() const { return dead_store_count_; }
+
+        // Registers AX-EX occupy bits 0-4, the flags bit 5
+        static constexpr int REGISTER_COUNT = 5;
+        static constexpr uint8_t FLAGS_BIT = 1u << REGISTER_COUNT;
+        static constexpr uint8_t ALL_REGISTERS = (1u << REGISTER_COUNT) - 1;
+
+    private:
+        enum class Flow { NEXT, JUMP, BRANCH, CALL, RETURN, HALT };
+
+        struct Instruction {
+            CodeInstructionNode* node;
+            Flow flow = Flow::NEXT;
+            uint8_t uses = 0;           // Registers and flags read
+            uint8_t defs = 0;           // Registers and flags written
+            bool removable = false;     // No effect besides writing defs
+            bool reads_memory = false;
+            bool barrier = false;       // Ends a run of store elimination
+            std::vector<size_t> use_operands;   // Register operands that may be renamed
+            std::vector<size_t> successors;
+            bool entry = false;         // Program start or CALL target
+            uint8_t live_out = 0;
+        };
+
+        std::vector<Instruction> instructions_;
+        std::vector<bool> block_start_;     // Instruction follows a label
+        std::unordered_map<std::string, size_t> label_targets_;
+        size_t removed_count_ = 0;
+        size_t propagated_count_ = 0;
+        size_t dead_store_count_ = 0;
+
+        bool build(CodeGraph& graph);
+        void classify(Instruction& instr);
+        bool link_successors();
+        void compute_liveness();
+        size_t propagate_copies();
+        std::vector<bool> find_dead_writes() const;
+        std::vector<bool> find_dead_stores() const;
+    };
+
+} // namespace assembler
+} // namespace lvm
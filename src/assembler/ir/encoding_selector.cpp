@@ -0,0 +1,159 @@
+#include "encoding_selector.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace lvm {
+namespace assembler {
+
+    namespace {
+        struct ByteForm {
+            uint8_t word_opcode;
+            const char* mnemonic;
+            uint8_t byte_opcode;
+        };
+
+        // Word-immediate opcode -> byte-immediate equivalent
+        const ByteForm BYTE_FORMS[] = {
+            { 0x29, "ADB",  0x2B },   // ADD
+            { 0x2E, "SBB",  0x30 },   // SUB
+            { 0x33, "MLB",  0x35 },   // MUL
+            { 0x38, "DVB",  0x3A },   // DIV
+            { 0x3D, "RMB",  0x3F },   // REM
+            { 0x42, "ANB",  0x44 },   // AND
+            { 0x47, "ORB",  0x49 },   // OR
+            { 0x4C, "XOB",  0x4E },   // XOR
+            { 0x56, "SLB",  0x58 },   // SHL
+            { 0x5B, "SHRB", 0x5D },   // SHR
+            { 0x60, "ROLB", 0x62 },   // ROL
+            { 0x65, "RORB", 0x67 },   // ROR
+        };
+
+        constexpr uint8_t OP_PUSH = 0x10;
+        constexpr uint8_t OP_POP = 0x13;
+        constexpr uint8_t OP_PUSHM = 0xA8;
+        constexpr uint8_t OP_POPM = 0xA9;
+        constexpr uint8_t OP_PUSHA = 0xAA;
+        constexpr uint8_t OP_POPA = 0xAB;
+        constexpr uint8_t ALL_REGISTERS = 0x1F;   // Mask bit n is register n (AX-EX)
+
+        // Register index (AX = 0 .. EX = 4) of a word PUSH/POP, or -1
+        int stack_register(const CodeGraphNode* node, uint8_t opcode) {
+            auto* instr = dynamic_cast<const CodeInstructionNode*>(node);
+            if (!instr || instr->opcode() != opcode || instr->operands().size() != 1 ||
+                instr->operands()[0].type != InstructionOperand::Type::REGISTER) {
+                return -1;
+            }
+            const std::string& name = instr->operands()[0].register_name;
+            if (name.size() != 2 || std::toupper(name[1]) != 'X') {
+                return -1;
+            }
+            int index = std::toupper(name[0]) - 'A';
+            return index >= 0 && index < 5 ? index : -1;
+        }
+    }
+
+    uint32_t EncodingSelector::select(CodeGraph& graph) {
+        rewritten_count_ = 0;
+        merged_count_ = 0;
+        uint32_t saved = merge_stack_runs_ ? merge_stack_runs(graph) : 0;
+
+        for (auto& node : graph.code_nodes()) {
+            auto* instr = dynamic_cast<CodeInstructionNode*>(node.get());
+            if (!instr) {
+                continue;
+            }
+
+            uint32_t before = instr->size();
+            if (narrow_immediate(*instr)) {
+                saved += before - instr->size();
+                rewritten_count_++;
+            }
+        }
+
+        return saved;
+    }
+
+    uint32_t EncodingSelector::merge_stack_runs(CodeGraph& graph) {
+        auto& nodes = graph.code_nodes();
+        std::unordered_set<const CodeGraphNode*> merged;
+        uint32_t saved = 0;
+
+        for (size_t i = 0; i < nodes.size();) {
+            uint8_t opcode = OP_PUSH;
+            int reg = stack_register(nodes[i].get(), OP_PUSH);
+            if (reg < 0) {
+                opcode = OP_POP;
+                reg = stack_register(nodes[i].get(), OP_POP);
+            }
+            if (reg < 0) {
+                ++i;
+                continue;
+            }
+
+            // PUSHM pushes AX first and POPM pops EX first
+            uint8_t mask = static_cast<uint8_t>(1u << reg);
+            size_t end = i + 1;
+            for (int last = reg; end < nodes.size(); ++end) {
+                int next = stack_register(nodes[end].get(), opcode);
+                if (next < 0 || (opcode == OP_PUSH ? next <= last : next >= last)) {
+                    break;
+                }
+                mask |= static_cast<uint8_t>(1u << next);
+                last = next;
+            }
+
+            if (end - i >= 2) {
+                auto* instr = static_cast<CodeInstructionNode*>(nodes[i].get());
+                uint32_t before = 0;
+                for (size_t j = i; j < end; ++j) {
+                    before += nodes[j]->size();
+                    if (j > i) {
+                        merged.insert(nodes[j].get());
+                    }
+                }
+
+                instr->operands().clear();
+                if (mask == ALL_REGISTERS) {
+                    instr->set_encoding(opcode == OP_PUSH ? "PUSHA" : "POPA", opcode == OP_PUSH ? OP_PUSHA : OP_POPA);
+                } else {
+                    instr->set_encoding(opcode == OP_PUSH ? "PUSHM" : "POPM", opcode == OP_PUSH ? OP_PUSHM : OP_POPM);
+                    InstructionOperand operand;
+                    operand.type = InstructionOperand::Type::IMMEDIATE_BYTE;
+                    operand.immediate_value = mask;
+                    instr->add_operand(operand);
+                }
+                saved += before - instr->size();
+                merged_count_++;
+            }
+            i = end;
+        }
+
+        std::erase_if(nodes, [&merged](const std::unique_ptr<CodeGraphNode>& node) {
+            return merged.count(node.get()) > 0;
+        });
+        return saved;
+    }
+
+    bool EncodingSelector::narrow_immediate(CodeInstructionNode& instr) {
+        // Only the single-operand accumulator form (AX implied) has a byte variant
+        if (instr.operands().size() != 1) {
+            return false;
+        }
+        InstructionOperand& operand = instr.operands()[0];
+        if (operand.type != InstructionOperand::Type::IMMEDIATE_WORD || operand.immediate_value > 0xFF) {
+            return false;
+        }
+
+        for (const auto& form : BYTE_FORMS) {
+            if (form.word_opcode == instr.opcode()) {
+                instr.set_encoding(form.mnemonic, form.byte_opcode);
+                operand.type = InstructionOperand::Type::IMMEDIATE_BYTE;
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace assembler
+} // namespace lvm
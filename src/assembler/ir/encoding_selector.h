@@ -0,0 +1,57 @@
+#pragma once
+
+#include "code_graph.h"
+#include <cstdint>
+#include <string>
+
+namespace lvm {
+namespace assembler {
+
+    /**
+     * Encoding selector (Pass 3.5)
+     *
+     * Rewrites instructions in the code graph to the shortest encoding with
+     * identical behaviour, before addresses are laid out:
+     * - Word-immediate ALU operations whose value fits in a byte use the
+     *   byte-immediate form (ADD -> ADB, SHL -> SLB, ...). The byte forms
+     *   zero-extend into the same 16-bit operation, so results and flags match.
+     * - Runs of two or more PUSH reg in ascending register order (AX..EX)
+     *   become one PUSHM mask, and runs of POP reg in descending order one
+     *   POPM mask; all five registers use PUSHA/POPA. The stack ends up
+     *   with the same words in the same places. A label ends a run.
+     *   Only done when merging is enabled (-O1 and up).
+     *
+     * Forms that only look equivalent are left alone: PUSHB pushes one byte
+     * rather than a word, and CPH/CPL compare a single byte of the register.
+     */
+    class EncodingSelector {
+    public:
+        explicit EncodingSelector(bool merge_stack_runs = true) : merge_stack_runs_(merge_stack_runs) {}
+
+        /**
+         * Select encodings for every instruction in the graph
+         * @return Number of code bytes saved
+         */
+        uint32_t select(CodeGraph& graph);
+
+        /**
+         * Number of instructions given a shorter encoding by the last select()
+         */
+        size_t rewritten_count() const { return rewritten_count_; }
+
+        /**
+         * Number of PUSH/POP runs merged into one instruction by the last select()
+         */
+        size_t merged_count() const { return merged_count_; }
+
+    private:
+        size_t rewritten_count_ = 0;
+        size_t merged_count_ = 0;
+        bool merge_stack_runs_;
+
+        bool narrow_immediate(CodeInstructionNode& instr);
+        uint32_t merge_stack_runs(CodeGraph& graph);
+    };
+
+} // namespace assembler
+} // namespace lvm
@@ -0,0 +1,97 @@
+#include "char_scan.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace lvm {
+namespace assembler {
+namespace char_scan {
+
+    namespace {
+        bool is_blank(char c) {
+            return c == ' ' || c == '\t' || c == '\r';
+        }
+
+        bool is_identifier_char(char c) {
+            return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                   (c >= '0' && c <= '9') || c == '_';
+        }
+
+#if defined(__SSE2__)
+        // Bytes of v in [lo, lo + span], as a compare mask
+        __m128i in_range(__m128i v, char lo, char span) {
+            __m128i offset = _mm_sub_epi8(v, _mm_set1_epi8(lo));
+            return _mm_cmpeq_epi8(_mm_subs_epu8(offset, _mm_set1_epi8(span)), _mm_setzero_si128());
+        }
+
+        // Index of the first byte outside the class within a full chunk, or
+        // 16 if every byte belongs to it
+        template <typename Classify>
+        size_t run_length(const char* chunk, Classify classify) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(chunk));
+            unsigned outside = ~static_cast<unsigned>(_mm_movemask_epi8(classify(v))) & 0xFFFF;
+            return outside ? static_cast<size_t>(__builtin_ctz(outside)) : 16;
+        }
+#endif
+    }
+
+    size_t skip_blanks(const char* data, size_t pos, size_t size) {
+        // Most runs are a single separator; settle those without a vector load
+        if (pos < size && !is_blank(data[pos])) {
+            return pos;
+        }
+#if defined(__SSE2__)
+        auto blank = [](__m128i v) {
+            __m128i space = _mm_cmpeq_epi8(v, _mm_set1_epi8(' '));
+            __m128i tab = _mm_cmpeq_epi8(v, _mm_set1_epi8('\t'));
+            __m128i cr = _mm_cmpeq_epi8(v, _mm_set1_epi8('\r'));
+            return _mm_or_si128(space, _mm_or_si128(tab, cr));
+        };
+        for (; pos + 16 <= size; pos += 16) {
+            size_t run = run_length(data + pos, blank);
+            if (run < 16) {
+                return pos + run;
+            }
+        }
+#endif
+        while (pos < size && is_blank(data[pos])) {
+            ++pos;
+        }
+        return pos;
+    }
+
+    size_t find_newline(const char* data, size_t pos, size_t size) {
+        if (pos >= size) {
+            return size;
+        }
+        const void* found = std::memchr(data + pos, '\n', size - pos);
+        return found ? static_cast<size_t>(static_cast<const char*>(found) - data) : size;
+    }
+
+    size_t skip_identifier(const char* data, size_t pos, size_t size) {
+#if defined(__SSE2__)
+        auto identifier = [](__m128i v) {
+            // OR-ing 0x20 folds A-Z onto a-z and maps nothing else there
+            __m128i letter = in_range(_mm_or_si128(v, _mm_set1_epi8(0x20)), 'a', 'z' - 'a');
+            __m128i digit = in_range(v, '0', '9' - '0');
+            __m128i underscore = _mm_cmpeq_epi8(v, _mm_set1_epi8('_'));
+            return _mm_or_si128(letter, _mm_or_si128(digit, underscore));
+        };
+        for (; pos + 16 <= size; pos += 16) {
+            size_t run = run_length(data + pos, identifier);
+            if (run < 16) {
+                return pos + run;
+            }
+        }
+#endif
+        while (pos < size && is_identifier_char(data[pos])) {
+            ++pos;
+        }
+        return pos;
+    }
+
+} // namespace char_scan
+} // namespace assembler
+} // namespace lvm
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+
+namespace lvm {
+namespace assembler {
+
+    /**
+     * Character-class scans used by the lexer to skip whole runs at once
+     *
+     * Each function returns the index of the first character at or after pos
+     * that ends the run, or size if the run reaches the end of the buffer.
+     * Runs are classified 16 bytes at a time with SSE2 when available, with
+     * a scalar loop for the tail and for other targets. The newline search
+     * uses memchr, which the C library already vectorizes for the host CPU.
+     */
+    namespace char_scan {
+
+        // Blanks within a line: ' ', '\t' and '\r'
+        size_t skip_blanks(const char* data, size_t pos, size_t size);
+
+        // Next '\n'
+        size_t find_newline(const char* data, size_t pos, size_t size);
+
+        // Identifier characters: A-Z, a-z, 0-9 and '_'
+        size_t skip_identifier(const char* data, size_t pos, size_t size);
+
+    } // namespace char_scan
+
+} // namespace assembler
+} // namespace lvm
@@ -1,4 +1,5 @@
 #include "lexer.h"
+#include "char_scan.h"
 #include <cctype>
 #include <stdexcept>
 #include <algorithm>
@@ -7,7 +8,7 @@ namespace lvm {
 namespace assembler {
 
     Lexer::Lexer(const std::string& source)
-        : source_(source), current_(0), start_(0), line_(1), column_(1), has_peek_(false) {
+        : source_(source), current_(0), start_(0), line_(1), line_start_(0), has_peek_(false) {
     }
 
     std::vector<Token> Lexer::tokenize() {
@@ -49,7 +50,7 @@ namespace assembler {
         switch (c) {
             case '\n':
                 line_++;
-                column_ = 1;
+                line_start_ = current_;
                 return make_token(TokenType::END_OF_LINE);
             case ':': return make_token(TokenType::COLON);
             case ',': return make_token(TokenType::COMMA);
@@ -71,6 +72,8 @@ namespace assembler {
             case '"':
             case '\'':
                 return string_literal(c);
+            case '%':
+                return virtual_register();
         }
         
         // Numbers
@@ -93,7 +96,7 @@ namespace assembler {
             size_t saved_current = current_;
             size_t saved_start = start_;
             size_t saved_line = line_;
-            size_t saved_column = column_;
+            size_t saved_line_start = line_start_;
             
             peek_cache_ = next_token();
             has_peek_ = true;
@@ -101,7 +104,7 @@ namespace assembler {
             current_ = saved_current;
             start_ = saved_start;
             line_ = saved_line;
-            column_ = saved_column;
+            line_start_ = saved_line_start;
         }
         
         return peek_cache_;
@@ -128,31 +131,22 @@ namespace assembler {
     void Lexer::advance() {
         if (!is_at_end()) {
             current_++;
-            column_++;
         }
     }
 
     void Lexer::skip_whitespace() {
-        while (!is_at_end()) {
-            char c = current_char();
-            if (c == ' ' || c == '\t' || c == '\r') {
-                advance();
-            } else {
-                break;
-            }
-        }
+        current_ = char_scan::skip_blanks(source_.data(), current_, source_.length());
     }
 
     void Lexer::skip_comment() {
         // Comment goes to end of line
-        while (!is_at_end() && current_char() != '\n') {
-            advance();
-        }
+        current_ = char_scan::find_newline(source_.data(), current_, source_.length());
     }
 
     Token Lexer::make_token(TokenType type) {
         std::string lexeme = source_.substr(start_, current_ - start_);
-        return Token(type, lexeme, line_, column_ - lexeme.length());
+        // Columns are 1-based from the start of the token; END_OF_LINE gets 0
+        return Token(type, lexeme, line_, start_ + 1 - line_start_);
     }
 
     Token Lexer::make_token(TokenType type, const std::string& value) {
@@ -174,9 +168,7 @@ namespace assembler {
     }
 
     Token Lexer::identifier_or_keyword() {
-        while (is_alphanumeric(current_char()) || current_char() == '_') {
-            advance();
-        }
+        current_ = char_scan::skip_identifier(source_.data(), current_, source_.length());
         
         std::string text = source_.substr(start_, current_ - start_);
         
@@ -194,6 +186,23 @@ namespace assembler {
         return make_token(TokenType::IDENTIFIER);
     }
 
+    Token Lexer::virtual_register() {
+        // Virtual register: %v<N>, replaced by the register allocator
+        if (current_char() != 'v' && current_char() != 'V') {
+            return error_token("Expected virtual register after '%'");
+        }
+        advance();
+        
+        if (!is_digit(current_char())) {
+            return error_token("Expected virtual register number after '%v'");
+        }
+        while (is_digit(current_char())) {
+            advance();
+        }
+        
+        return make_token(TokenType::REGISTER);
+    }
+
     Token Lexer::number() {
         bool is_negative = false;
         if (current_char() == '-') {
@@ -252,7 +261,7 @@ namespace assembler {
             } else {
                 if (current_char() == '\n') {
                     line_++;
-                    column_ = 0;
+                    line_start_ = current_ + 1;
                 }
                 value += current_char();
                 advance();
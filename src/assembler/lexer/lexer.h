@@ -20,6 +20,11 @@ namespace assembler {
      * - Operators and punctuation
      * - Comments (;)
      * - Whitespace (ignored except for EOL)
+     *
+     * Whitespace, comments and identifiers are skipped a run at a time (see
+     * char_scan.h). Columns are not counted per character: the lexer keeps
+     * the offset where the current line starts and derives a token's column
+     * from it when the token is made.
      */
     class Lexer {
     public:
@@ -58,7 +63,7 @@ namespace assembler {
         size_t current_;        // Current position in source
         size_t start_;          // Start of current token
         size_t line_;           // Current line number
-        size_t column_;         // Current column number
+        size_t line_start_;     // Offset of the first character of the current line
         Token peek_cache_;      // Cached peek token
         bool has_peek_;         // Whether peek cache is valid
         
@@ -78,6 +83,7 @@ namespace assembler {
         
         // Specific token parsers
         Token identifier_or_keyword();
+        Token virtual_register();
         Token number();
         Token string_literal(char quote);
         
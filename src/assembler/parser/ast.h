@@ -134,6 +134,10 @@ namespace assembler {
             statements_.push_back(std::move(statement));
         }
         
+        std::vector<std::unique_ptr<ASTNode>>& statements() {
+            return statements_;
+        }
+        
         const std::vector<std::unique_ptr<ASTNode>>& statements() const {
             return statements_;
         }
@@ -0,0 +1,788 @@
+#include "register_allocator.h"
+#include <algorithm>
+#include <cctype>
+#include <unordered_set>
+
+namespace lvm {
+namespace assembler {
+
+    namespace {
+        const char* const REGISTER_NAMES[] = { "AX", "BX", "CX", "DX", "EX" };
+
+        // Destination is overwritten
+        const std::unordered_set<std::string> DEF_FIRST = {
+            "LD", "LDA", "LDAB", "LDX", "POP", "PEEK", "PEEKF"
+        };
+
+        // Destination is read and written (partial writes, increments)
+        const std::unordered_set<std::string> USE_DEF_FIRST = {
+            "LDH", "LDL", "LDAH", "LDAL", "LDXL", "POPH", "POPL", "PEEKB", "PEEKFB", "INC", "DEC"
+        };
+
+        // Word families with a form for any destination register (reg = reg op src)
+        const std::unordered_set<std::string> REGISTER_DESTINATION_OPS = {
+            "ADD", "SUB", "MUL", "DIV", "REM", "AND", "OR", "XOR", "SHL", "SHR", "ROL", "ROR"
+        };
+
+        // AX = AX op src
+        const std::unordered_set<std::string> ALU_OPS = {
+            "ADD", "ADB", "ADH", "ADL", "SUB", "SBB", "SBH", "SBL",
+            "MUL", "MLB", "MLH", "MLL", "DIV", "DVB", "DVH", "DVL",
+            "REM", "RMB", "RMH", "RML", "AND", "ANB", "ANH", "ANL",
+            "OR", "ORB", "ORH", "ORL", "XOR", "XOB", "XOH", "XOL",
+            "SHL", "SLB", "SLH", "SLL", "SHR", "SHRB", "SHRH", "SHRL",
+            "ROL", "ROLB", "ROLH", "ROLL", "ROR", "RORB", "RORH", "RORL"
+        };
+
+        // AX = op src
+        const std::unordered_set<std::string> NOT_OPS = { "NOT", "NOTB", "NOTH", "NOTL" };
+
+        // Left operand is copied into AX before the right one is read
+        const std::unordered_set<std::string> COMPARE_OPS = { "CMP", "CPH", "CPL" };
+
+        const std::unordered_set<std::string> BRANCH_OPS = {
+            "JPZ", "JZ", "JPNZ", "JNZ", "JPC", "JC", "JPNC", "JNC",
+            "JPS", "JS", "JPNS", "JNS", "JPO", "JO", "JPNO", "JNO"
+        };
+
+        // Instructions that move SP; a scratch register cannot be saved around them
+        const std::unordered_set<std::string> STACK_OPS = {
+            "PUSH", "PUSHH", "PUSHL", "POP", "POPH", "POPL", "PEEK", "PEEKF", "PEEKB", "PEEKFB",
+            "PUSHW", "PUSHB", "PUSHM", "POPM", "PUSHA", "POPA", "FLSH", "SETF", "CALL", "RET", "SYS", "SYSCALL"
+        };
+
+        // Registers saved or restored by PUSHM/POPM (literal mask) and PUSHA/POPA
+        uint8_t register_mask_operand(const InstructionNode& node, const std::string& mnemonic) {
+            constexpr uint8_t ALL = 0x1F;  // AX-EX
+            if ((mnemonic == "PUSHM" || mnemonic == "POPM") && node.operands().size() == 1) {
+                const ExpressionNode* expr = node.operands()[0]->expression();
+                if (expr && expr->type() == ExpressionNode::Type::NUMBER) {
+                    return static_cast<uint8_t>(expr->number() & ALL);
+                }
+            }
+            return ALL;
+        }
+
+        std::string to_upper(std::string text) {
+            std::transform(text.begin(), text.end(), text.begin(), ::toupper);
+            return text;
+        }
+
+        bool is_byte_register(const std::string& name) {
+            return name.size() == 2 && (std::toupper(name[1]) == 'H' || std::toupper(name[1]) == 'L');
+        }
+
+        uint8_t register_bit(int reg) {
+            return static_cast<uint8_t>(1u << reg);
+        }
+
+        std::unique_ptr<OperandNode> register_operand(int reg, const ASTNode& at) {
+            auto expr = std::make_unique<ExpressionNode>(ExpressionNode::Type::REGISTER);
+            expr->set_register(REGISTER_NAMES[reg]);
+            expr->set_location(at.line(), at.column());
+            auto operand = std::make_unique<OperandNode>(OperandNode::Type::REGISTER);
+            operand->set_expression(std::move(expr));
+            operand->set_location(at.line(), at.column());
+            return operand;
+        }
+
+        std::unique_ptr<OperandNode> spill_operand(size_t slot, const ASTNode& at) {
+            auto base = std::make_unique<ExpressionNode>(ExpressionNode::Type::IDENTIFIER);
+            base->set_identifier(RegisterAllocator::SPILL_AREA_LABEL);
+            base->set_location(at.line(), at.column());
+            auto offset = std::make_unique<ExpressionNode>(ExpressionNode::Type::NUMBER);
+            offset->set_number(slot * 2);
+            offset->set_location(at.line(), at.column());
+            auto expr = std::make_unique<ExpressionNode>(ExpressionNode::Type::BINARY_OP);
+            expr->set_operator('+');
+            expr->set_left(std::move(base));
+            expr->set_right(std::move(offset));
+            expr->set_location(at.line(), at.column());
+            auto operand = std::make_unique<OperandNode>(OperandNode::Type::ADDRESS_EXPR);
+            operand->set_expression(std::move(expr));
+            operand->set_location(at.line(), at.column());
+            return operand;
+        }
+
+        std::unique_ptr<InstructionNode> make_instruction(const std::string& mnemonic, const ASTNode& at,
+                                                          std::unique_ptr<OperandNode> first,
+                                                          std::unique_ptr<OperandNode> second = nullptr) {
+            auto instr = std::make_unique<InstructionNode>(mnemonic);
+            instr->set_location(at.line(), at.column());
+            instr->add_operand(std::move(first));
+            if (second) {
+                instr->add_operand(std::move(second));
+            }
+            return instr;
+        }
+
+        void collect_expression_registers(ExpressionNode* expr, std::vector<ExpressionNode*>& out) {
+            if (!expr) {
+                return;
+            }
+            if (expr->type() == ExpressionNode::Type::REGISTER) {
+                out.push_back(expr);
+            } else if (expr->type() == ExpressionNode::Type::BINARY_OP) {
+                collect_expression_registers(expr->left(), out);
+                collect_expression_registers(expr->right(), out);
+            }
+        }
+    }
+
+    bool RegisterAllocator::is_virtual_register(const std::string& name) {
+        if (name.size() < 3 || name[0] != '%' || std::tolower(name[1]) != 'v') {
+            return false;
+        }
+        return std::all_of(name.begin() + 2, name.end(), ::isdigit);
+    }
+
+    std::string RegisterAllocator::assigned_register(const std::string& vreg) const {
+        std::string key = vreg;
+        std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+        auto it = vreg_ids_.find(key);
+        if (it == vreg_ids_.end()) {
+            return "";
+        }
+        int reg = assignment_[it->second - PHYSICAL_REGISTER_COUNT];
+        return reg < 0 ? "" : REGISTER_NAMES[reg];
+    }
+
+    bool RegisterAllocator::allocate(ProgramNode& program) {
+        sites_.clear();
+        label_sites_.clear();
+        vreg_ids_.clear();
+        vreg_names_.clear();
+        prefers_ax_.clear();
+        intervals_.clear();
+        assignment_.clear();
+        spill_slots_.clear();
+        owner_.clear();
+        errors_.clear();
+
+        collect_sites(program);
+
+        // Programs written against physical registers only pass through untouched
+        if (vreg_names_.empty()) {
+            return true;
+        }
+
+        link_successors();
+        compute_liveness();
+        assign_registers();
+        check_reentrant_spills();
+        rewrite(program);
+        add_spill_area(program);
+
+        return !has_errors();
+    }
+
+    void RegisterAllocator::collect_sites(ProgramNode& program) {
+        for (auto& section : program.sections()) {
+            auto* code = dynamic_cast<CodeSectionNode*>(section.get());
+            if (!code) {
+                continue;
+            }
+            for (auto& stmt : code->statements()) {
+                if (auto* label = dynamic_cast<LabelNode*>(stmt.get())) {
+                    label_sites_[label->name()] = sites_.size();
+                } else if (auto* instr = dynamic_cast<InstructionNode*>(stmt.get())) {
+                    Site site;
+                    site.instr = instr;
+                    classify(site);
+                    sites_.push_back(std::move(site));
+                }
+            }
+        }
+    }
+
+    int RegisterAllocator::value_for(const std::string& reg_name) {
+        if (is_virtual_register(reg_name)) {
+            std::string key = reg_name;
+            std::transform(key.begin(), key.end(), key.begin(), ::tolower);
+            auto it = vreg_ids_.find(key);
+            if (it != vreg_ids_.end()) {
+                return it->second;
+            }
+            int value = PHYSICAL_REGISTER_COUNT + static_cast<int>(vreg_names_.size());
+            vreg_ids_[key] = value;
+            vreg_names_.push_back(key);
+            prefers_ax_.push_back(false);
+            return value;
+        }
+
+        char first = static_cast<char>(std::toupper(reg_name.empty() ? 0 : reg_name[0]));
+        if (first >= 'A' && first <= 'E') {
+            return first - 'A';
+        }
+        return -1;  // Reported by the semantic analyzer
+    }
+
+    void RegisterAllocator::classify(Site& site) {
+        InstructionNode& node = *site.instr;
+        std::string mnemonic = to_upper(node.mnemonic());
+        size_t operand_count = node.operands().size();
+
+        bool is_alu = ALU_OPS.count(mnemonic) > 0;
+        bool is_not = NOT_OPS.count(mnemonic) > 0;
+        // Memory sources only exist for AX, so those still go through it
+        bool any_destination = REGISTER_DESTINATION_OPS.count(mnemonic) > 0 && operand_count == 2 &&
+                               node.operands()[1]->type() != OperandNode::Type::MEMORY_ACCESS;
+
+        if (mnemonic == "JMP") {
+            site.flow = Flow::JUMP;
+        } else if (BRANCH_OPS.count(mnemonic)) {
+            site.flow = Flow::BRANCH;
+        } else if (mnemonic == "CALL") {
+            site.flow = Flow::CALL;
+        } else if (mnemonic == "RET" || mnemonic == "HALT") {
+            site.flow = Flow::EXIT;
+        }
+
+        for (size_t i = 0; i < operand_count; ++i) {
+            OperandNode& operand = *node.operands()[i];
+
+            if (operand.type() == OperandNode::Type::IDENTIFIER && site.target.empty() && operand.expression()) {
+                site.target = operand.expression()->identifier();
+                continue;
+            }
+
+            if (operand.type() != OperandNode::Type::REGISTER) {
+                // Registers inside address expressions are only read
+                std::vector<ExpressionNode*> regs;
+                collect_expression_registers(operand.expression(), regs);
+                for (ExpressionNode* expr : regs) {
+                    int value = value_for(expr->register_name());
+                    if (value >= 0) {
+                        site.refs.push_back({expr, value, Role::USE});
+                    }
+                }
+                continue;
+            }
+
+            ExpressionNode* expr = operand.expression();
+            int value = value_for(expr->register_name());
+            if (value < 0) {
+                continue;
+            }
+
+            // Writing half of a physical register keeps the other half alive
+            Role full_def = is_byte_register(expr->register_name()) ? Role::USE_DEF : Role::DEF;
+            Role role = Role::USE;
+            if (i == 0 && DEF_FIRST.count(mnemonic)) {
+                role = full_def;
+            } else if (i == 0 && USE_DEF_FIRST.count(mnemonic)) {
+                role = Role::USE_DEF;
+            } else if (mnemonic == "SWP") {
+                role = Role::USE_DEF;
+            } else if (i == 0 && operand_count == 2 && (is_alu || is_not)) {
+                role = is_alu ? Role::USE_DEF : full_def;
+                if (value >= PHYSICAL_REGISTER_COUNT) {
+                    // AX keeps the shorter encoding even where any register works
+                    if (!any_destination) {
+                        site.accumulator = static_cast<int>(site.refs.size());
+                    }
+                    prefers_ax_[value - PHYSICAL_REGISTER_COUNT] = true;
+                }
+            }
+            site.refs.push_back({expr, value, role});
+        }
+
+        for (const auto& ref : site.refs) {
+            if (ref.role != Role::DEF) {
+                site.uses.push_back(ref.value);
+            }
+            if (ref.role != Role::USE) {
+                site.defs.push_back(ref.value);
+            }
+        }
+
+        // Implicit accumulator traffic
+        if (is_alu && operand_count < 2) {
+            site.uses.push_back(REG_AX);
+            site.defs.push_back(REG_AX);
+        } else if (is_not && operand_count < 2) {
+            site.defs.push_back(REG_AX);
+        } else if (COMPARE_OPS.count(mnemonic)) {
+            site.early_clobber |= register_bit(REG_AX);
+            site.defs.push_back(REG_AX);
+        }
+
+        if (mnemonic == "PUSHM" || mnemonic == "PUSHA" || mnemonic == "POPM" || mnemonic == "POPA") {
+            uint8_t mask = register_mask_operand(node, mnemonic);
+            bool push = mnemonic == "PUSHM" || mnemonic == "PUSHA";
+            for (int reg = 0; reg < PHYSICAL_REGISTER_COUNT; ++reg) {
+                if (mask & register_bit(reg)) {
+                    (push ? site.uses : site.defs).push_back(reg);
+                }
+            }
+        }
+
+        // Subroutines may use any register
+        if (site.flow == Flow::CALL) {
+            for (int reg = 0; reg < PHYSICAL_REGISTER_COUNT; ++reg) {
+                site.defs.push_back(reg);
+            }
+        }
+    }
+
+    void RegisterAllocator::link_successors() {
+        for (size_t i = 0; i < sites_.size(); ++i) {
+            Site& site = sites_[i];
+            if (site.flow != Flow::JUMP && site.flow != Flow::EXIT && i + 1 < sites_.size()) {
+                site.successors.push_back(i + 1);
+            }
+            if (site.flow == Flow::JUMP || site.flow == Flow::BRANCH) {
+                auto it = label_sites_.find(site.target);
+                if (it != label_sites_.end() && it->second < sites_.size()) {
+                    site.successors.push_back(it->second);
+                }
+            }
+        }
+    }
+
+    void RegisterAllocator::compute_liveness() {
+        size_t values = value_count();
+        for (auto& site : sites_) {
+            site.live_in.assign(values, false);
+            site.live_out.assign(values, false);
+        }
+
+        // Backward dataflow to a fixed point: in = use + (out - def)
+        bool changed = true;
+        while (changed) {
+            changed = false;
+            for (size_t i = sites_.size(); i-- > 0;) {
+                Site& site = sites_[i];
+
+                std::vector<bool> out(values, false);
+                for (size_t succ : site.successors) {
+                    const auto& succ_in = sites_[succ].live_in;
+                    for (size_t v = 0; v < values; ++v) {
+                        if (succ_in[v]) {
+                            out[v] = true;
+                        }
+                    }
+                }
+
+                std::vector<bool> in = out;
+                for (int v : site.defs) {
+                    in[v] = false;
+                }
+                for (int v : site.uses) {
+                    in[v] = true;
+                }
+
+                if (in != site.live_in || out != site.live_out) {
+                    site.live_in = std::move(in);
+                    site.live_out = std::move(out);
+                    changed = true;
+                }
+            }
+        }
+    }
+
+    bool RegisterAllocator::register_free(int reg, size_t start, size_t end) const {
+        for (size_t slot = start; slot <= end; ++slot) {
+            if (owner_[slot][reg] != -1) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void RegisterAllocator::occupy(int reg, size_t start, size_t end, int owner) {
+        for (size_t slot = start; slot <= end; ++slot) {
+            owner_[slot][reg] = owner;
+        }
+    }
+
+    void RegisterAllocator::assign_registers() {
+        size_t slots = sites_.size() * 2;
+        owner_.assign(slots, std::vector<int>(PHYSICAL_REGISTER_COUNT, -1));
+
+        // Physical registers named in the source are fixed
+        for (size_t i = 0; i < sites_.size(); ++i) {
+            const Site& site = sites_[i];
+            for (int reg = 0; reg < PHYSICAL_REGISTER_COUNT; ++reg) {
+                if (site.live_in[reg] || (site.early_clobber & register_bit(reg))) {
+                    owner_[2 * i][reg] = -2;
+                }
+                if (site.live_out[reg]) {
+                    owner_[2 * i + 1][reg] = -2;
+                }
+            }
+            for (int v : site.defs) {
+                if (v < PHYSICAL_REGISTER_COUNT) {
+                    owner_[2 * i + 1][v] = -2;
+                }
+            }
+        }
+
+        // One conservative interval per virtual register, from first to last live slot
+        for (size_t k = 0; k < vreg_names_.size(); ++k) {
+            intervals_.push_back({k, slots, 0});
+        }
+        for (size_t i = 0; i < sites_.size(); ++i) {
+            const Site& site = sites_[i];
+            for (size_t k = 0; k < vreg_names_.size(); ++k) {
+                size_t value = PHYSICAL_REGISTER_COUNT + k;
+                bool defined = std::find(site.defs.begin(), site.defs.end(), static_cast<int>(value)) != site.defs.end();
+                if (site.live_in[value]) {
+                    intervals_[k].start = std::min(intervals_[k].start, 2 * i);
+                    intervals_[k].end = std::max(intervals_[k].end, 2 * i);
+                }
+                if (site.live_out[value] || defined) {
+                    intervals_[k].start = std::min(intervals_[k].start, 2 * i + 1);
+                    intervals_[k].end = std::max(intervals_[k].end, 2 * i + 1);
+                }
+            }
+        }
+
+        std::vector<size_t> order(vreg_names_.size());
+        for (size_t k = 0; k < order.size(); ++k) {
+            order[k] = k;
+        }
+        std::stable_sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+            return intervals_[a].start < intervals_[b].start;
+        });
+
+        assignment_.assign(vreg_names_.size(), -1);
+        for (size_t k : order) {
+            const Interval& current = intervals_[k];
+            if (current.start > current.end) {
+                continue;  // Never reached
+            }
+
+            static const int ACCUMULATOR_ORDER[] = { 0, 1, 2, 3, 4 };
+            static const int GENERAL_ORDER[] = { 1, 2, 3, 4, 0 };
+            const int* preference = prefers_ax_[k] ? ACCUMULATOR_ORDER : GENERAL_ORDER;
+
+            int chosen = -1;
+            for (int n = 0; n < PHYSICAL_REGISTER_COUNT && chosen < 0; ++n) {
+                if (register_free(preference[n], current.start, current.end)) {
+                    chosen = preference[n];
+                }
+            }
+
+            if (chosen < 0) {
+                // Evict the single interval blocking a register if it lives longer
+                int victim = -1;
+                for (int n = 0; n < PHYSICAL_REGISTER_COUNT; ++n) {
+                    int reg = preference[n];
+                    int blocker = -1;
+                    bool single = true;
+                    for (size_t slot = current.start; slot <= current.end && single; ++slot) {
+                        int owner = owner_[slot][reg];
+                        if (owner == -1) {
+                            continue;
+                        }
+                        if (owner == -2 || (blocker >= 0 && owner != blocker)) {
+                            single = false;
+                        }
+                        blocker = owner;
+                    }
+                    if (single && blocker >= 0 && intervals_[blocker].end > current.end &&
+                        (victim < 0 || intervals_[blocker].end > intervals_[victim].end)) {
+                        victim = blocker;
+                        chosen = reg;
+                    }
+                }
+                if (victim >= 0) {
+                    occupy(chosen, intervals_[victim].start, intervals_[victim].end, -1);
+                    assignment_[victim] = -1;
+                    spill_slots_.emplace(static_cast<size_t>(victim), spill_slots_.size());
+                }
+            }
+
+            if (chosen >= 0) {
+                assignment_[k] = chosen;
+                occupy(chosen, current.start, current.end, static_cast<int>(k));
+            } else {
+                spill_slots_.emplace(k, spill_slots_.size());
+            }
+        }
+    }
+
+    void RegisterAllocator::check_reentrant_spills() {
+        if (spill_slots_.empty()) {
+            return;
+        }
+
+        // Subroutines are CALL targets; a body is every site reachable from
+        // the entry, with each CALL treated as returning to the next site
+        std::vector<std::string> names;
+        std::unordered_map<std::string, size_t> ids;
+        for (const auto& site : sites_) {
+            if (site.flow != Flow::CALL || ids.count(site.target)) {
+                continue;
+            }
+            auto it = label_sites_.find(site.target);
+            if (it != label_sites_.end() && it->second < sites_.size()) {
+                ids[site.target] = names.size();
+                names.push_back(site.target);
+            }
+        }
+
+        std::vector<std::vector<bool>> body(names.size(), std::vector<bool>(sites_.size(), false));
+        for (size_t s = 0; s < names.size(); ++s) {
+            std::vector<size_t> pending = { label_sites_[names[s]] };
+            while (!pending.empty()) {
+                size_t i = pending.back();
+                pending.pop_back();
+                if (body[s][i]) {
+                    continue;
+                }
+                body[s][i] = true;
+                for (size_t succ : sites_[i].successors) {
+                    pending.push_back(succ);
+                }
+            }
+        }
+
+        // reaches[t][s]: calling t can enter s again before it returns
+        std::vector<std::vector<bool>> reaches(names.size(), std::vector<bool>(names.size(), false));
+        for (size_t t = 0; t < names.size(); ++t) {
+            std::vector<size_t> pending = { t };
+            while (!pending.empty()) {
+                size_t s = pending.back();
+                pending.pop_back();
+                if (reaches[t][s]) {
+                    continue;
+                }
+                reaches[t][s] = true;
+                for (size_t i = 0; i < sites_.size(); ++i) {
+                    if (body[s][i] && sites_[i].flow == Flow::CALL && ids.count(sites_[i].target)) {
+                        pending.push_back(ids[sites_[i].target]);
+                    }
+                }
+            }
+        }
+
+        // Spill slots are one global word per vreg, so a value kept there
+        // across a CALL that re-enters its own subroutine gets overwritten
+        for (size_t i = 0; i < sites_.size(); ++i) {
+            const Site& site = sites_[i];
+            if (site.flow != Flow::CALL || !ids.count(site.target)) {
+                continue;
+            }
+            size_t callee = ids[site.target];
+            for (size_t s = 0; s < names.size(); ++s) {
+                if (!body[s][i] || !reaches[callee][s]) {
+                    continue;
+                }
+                for (size_t vreg = 0; vreg < vreg_names_.size(); ++vreg) {
+                    if (spill_slots_.count(vreg) && site.live_out[PHYSICAL_REGISTER_COUNT + vreg]) {
+                        error("Virtual register '" + vreg_names_[vreg] + "' is spilled across a CALL to '" +
+                              site.target + "', which can re-enter '" + names[s] +
+                              "'; spill slots are shared by every activation",
+                              site.instr->line(), site.instr->column());
+                    }
+                }
+                break;
+            }
+        }
+    }
+
+    void RegisterAllocator::rewrite(ProgramNode& program) {
+        size_t index = 0;
+        for (auto& section : program.sections()) {
+            auto* code = dynamic_cast<CodeSectionNode*>(section.get());
+            if (!code) {
+                continue;
+            }
+            std::vector<std::unique_ptr<ASTNode>> rewritten;
+            for (auto& stmt : code->statements()) {
+                if (dynamic_cast<InstructionNode*>(stmt.get())) {
+                    emit_site(index++, std::move(stmt), rewritten);
+                } else {
+                    rewritten.push_back(std::move(stmt));
+                }
+            }
+            code->statements() = std::move(rewritten);
+        }
+    }
+
+    void RegisterAllocator::emit_site(size_t index, std::unique_ptr<ASTNode> statement,
+                                      std::vector<std::unique_ptr<ASTNode>>& out) {
+        Site& site = sites_[index];
+        const ASTNode& at = *site.instr;
+        std::string mnemonic = to_upper(site.instr->mnemonic());
+
+        // Registers the instruction touches once virtual registers are resolved
+        uint8_t in_use = 0;
+        for (int v : site.uses) {
+            if (v < PHYSICAL_REGISTER_COUNT) in_use |= register_bit(v);
+        }
+        for (int v : site.defs) {
+            if (v < PHYSICAL_REGISTER_COUNT) in_use |= register_bit(v);
+        }
+        for (const auto& ref : site.refs) {
+            if (ref.value >= PHYSICAL_REGISTER_COUNT && assignment_[ref.value - PHYSICAL_REGISTER_COUNT] >= 0) {
+                in_use |= register_bit(assignment_[ref.value - PHYSICAL_REGISTER_COUNT]);
+            }
+        }
+
+        // Spilled virtual registers borrow a scratch register for this one instruction
+        struct Reload {
+            size_t vreg;
+            int reg;
+            bool used;
+            bool defined;
+        };
+        std::vector<Reload> reloads;
+        std::vector<int> saved;
+        for (size_t r = 0; r < site.refs.size(); ++r) {
+            const RegisterRef& ref = site.refs[r];
+            if (ref.value < PHYSICAL_REGISTER_COUNT) {
+                continue;
+            }
+            size_t vreg = ref.value - PHYSICAL_REGISTER_COUNT;
+            if (assignment_[vreg] >= 0 ||
+                std::any_of(reloads.begin(), reloads.end(), [vreg](const Reload& rl) { return rl.vreg == vreg; })) {
+                continue;
+            }
+
+            Reload reload{vreg, -1, false, false};
+            for (const auto& other : site.refs) {
+                if (other.value == ref.value) {
+                    reload.used |= other.role != Role::DEF;
+                    reload.defined |= other.role != Role::USE;
+                }
+            }
+
+            static const int ACCUMULATOR_ORDER[] = { 0, 1, 2, 3, 4 };
+            static const int GENERAL_ORDER[] = { 1, 2, 3, 4, 0 };
+            const int* preference = site.accumulator == static_cast<int>(r) ? ACCUMULATOR_ORDER : GENERAL_ORDER;
+            for (int n = 0; n < PHYSICAL_REGISTER_COUNT && reload.reg < 0; ++n) {
+                int reg = preference[n];
+                if ((in_use & register_bit(reg)) ||
+                    (reload.used && owner_[2 * index][reg] != -1) ||
+                    (reload.defined && owner_[2 * index + 1][reg] != -1)) {
+                    continue;
+                }
+                reload.reg = reg;
+            }
+
+            // Nothing free: borrow a live register and put it back afterwards
+            if (reload.reg < 0 && !STACK_OPS.count(mnemonic)) {
+                for (int n = 0; n < PHYSICAL_REGISTER_COUNT && reload.reg < 0; ++n) {
+                    if (!(in_use & register_bit(preference[n]))) {
+                        reload.reg = preference[n];
+                        saved.push_back(reload.reg);
+                    }
+                }
+            }
+
+            if (reload.reg < 0) {
+                error("No register available for spilled virtual register '" + vreg_names_[vreg] + "'",
+                      at.line(), at.column());
+                out.push_back(std::move(statement));
+                return;
+            }
+            in_use |= register_bit(reload.reg);
+            reloads.push_back(reload);
+        }
+
+        auto resolved = [&](const RegisterRef& ref) -> std::string {
+            if (ref.value < PHYSICAL_REGISTER_COUNT) {
+                return ref.expr->register_name();
+            }
+            size_t vreg = ref.value - PHYSICAL_REGISTER_COUNT;
+            if (assignment_[vreg] >= 0) {
+                return REGISTER_NAMES[assignment_[vreg]];
+            }
+            for (const auto& reload : reloads) {
+                if (reload.vreg == vreg) {
+                    return REGISTER_NAMES[reload.reg];
+                }
+            }
+            return ref.expr->register_name();
+        };
+
+        for (int reg : saved) {
+            out.push_back(make_instruction("PUSH", at, register_operand(reg, at)));
+        }
+        for (const auto& reload : reloads) {
+            if (reload.used) {
+                out.push_back(make_instruction("LDA", at, register_operand(reload.reg, at),
+                                               spill_operand(spill_slots_[reload.vreg], at)));
+            }
+        }
+
+        std::vector<std::string> names;
+        for (const auto& ref : site.refs) {
+            names.push_back(resolved(ref));
+        }
+
+        // The other ALU forms only write AX: swap the accumulator in and out around them
+        int swap_with = -1;
+        if (site.accumulator >= 0) {
+            std::string dest = names[site.accumulator];
+            int dest_reg = std::toupper(dest[0]) - 'A';
+            if (dest_reg != REG_AX) {
+                swap_with = dest_reg;
+                for (size_t r = 0; r < names.size(); ++r) {
+                    if (static_cast<int>(r) == site.accumulator) {
+                        names[r] = "AX";
+                        continue;
+                    }
+                    int reg = std::toupper(names[r][0]) - 'A';
+                    if (reg == REG_AX) {
+                        names[r][0] = dest[0];
+                    } else if (reg == dest_reg) {
+                        names[r][0] = 'A';
+                    }
+                }
+            }
+        }
+        for (size_t r = 0; r < site.refs.size(); ++r) {
+            site.refs[r].expr->set_register(names[r]);
+        }
+
+        if (swap_with >= 0) {
+            out.push_back(make_instruction("SWP", at, register_operand(REG_AX, at), register_operand(swap_with, at)));
+        }
+        out.push_back(std::move(statement));
+        if (swap_with >= 0) {
+            out.push_back(make_instruction("SWP", at, register_operand(REG_AX, at), register_operand(swap_with, at)));
+        }
+
+        for (const auto& reload : reloads) {
+            if (reload.defined) {
+                out.push_back(make_instruction("STA", at, spill_operand(spill_slots_[reload.vreg], at),
+                                               register_operand(reload.reg, at)));
+            }
+        }
+        for (auto it = saved.rbegin(); it != saved.rend(); ++it) {
+            out.push_back(make_instruction("POP", at, register_operand(*it, at)));
+        }
+    }
+
+    void RegisterAllocator::add_spill_area(ProgramNode& program) {
+        if (spill_slots_.empty()) {
+            return;
+        }
+
+        auto area = std::make_unique<DataDefinitionNode>(SPILL_AREA_LABEL, DataDefinitionNode::Type::WORD);
+        for (size_t i = 0; i < spill_slots_.size(); ++i) {
+            area->add_numeric_value(0);
+        }
+
+        for (auto& section : program.sections()) {
+            if (auto* data = dynamic_cast<DataSectionNode*>(section.get())) {
+                data->add_item(std::move(area));
+                return;
+            }
+        }
+
+        auto data = std::make_unique<DataSectionNode>();
+        data->add_item(std::move(area));
+        program.add_section(std::move(data));
+    }
+
+    void RegisterAllocator::error(const std::string& message, size_t line, size_t column) {
+        errors_.emplace_back(message, line, column);
+    }
+
+} // namespace assembler
+} // namespace lvm
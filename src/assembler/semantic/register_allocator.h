@@ -0,0 +1,122 @@
+#pragma once
+
+#include "semantic_analyzer.h"
+#include "../parser/ast.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace lvm {
+namespace assembler {
+
+    /**
+     * Register allocator (Pass 1.6)
+     *
+     * Replaces virtual registers (%v0, %v1, ...) with AX-EX:
+     * - Liveness analysis over the code's control flow (fall-through, jumps, calls)
+     * - Linear-scan allocation; ALU accumulators prefer AX, everything else
+     *   prefers BX-EX so AX stays free for the ALU
+     * - Word ALU families write any register directly; other accumulators
+     *   placed outside AX are bracketed with SWP AX, reg
+     * - Registers that run out are spilled to word slots in a data block
+     *   (__vreg_spill) and reloaded around each use with LDA/STA. The slots
+     *   are global, not per call frame (there is no frame-relative store),
+     *   so a spilled value live across a CALL that can re-enter the calling
+     *   subroutine (directly or through other calls) is reported as an error
+     *
+     * Physical registers named in the source are left untouched and treated
+     * as pre-coloured. CALL is assumed to clobber every register, and nothing
+     * is considered live past RET or HALT.
+     */
+    class RegisterAllocator {
+    public:
+        static constexpr const char* SPILL_AREA_LABEL = "__vreg_spill";
+
+        RegisterAllocator() = default;
+
+        /**
+         * Allocate all virtual registers in the program
+         * @return true if successful, false if errors found
+         */
+        bool allocate(ProgramNode& program);
+
+        const std::vector<SemanticError>& errors() const { return errors_; }
+        bool has_errors() const { return !errors_.empty(); }
+
+        /**
+         * Number of virtual registers that were given a spill slot
+         */
+        size_t spilled_count() const { return spill_slots_.size(); }
+
+        /**
+         * Physical register chosen for a virtual register ("" if spilled or unknown)
+         */
+        std::string assigned_register(const std::string& vreg) const;
+
+        static bool is_virtual_register(const std::string& name);
+
+    private:
+        // Values are numbered with the physical registers first
+        static constexpr int PHYSICAL_REGISTER_COUNT = 5;
+        static constexpr int REG_AX = 0;
+
+        enum class Role { USE, DEF, USE_DEF };
+        enum class Flow { NEXT, JUMP, BRANCH, CALL, EXIT };
+
+        struct RegisterRef {
+            ExpressionNode* expr;
+            int value;
+            Role role;
+        };
+
+        struct Site {
+            InstructionNode* instr;
+            Flow flow = Flow::NEXT;
+            std::string target;              // Label for JUMP/BRANCH
+            std::vector<RegisterRef> refs;
+            std::vector<int> uses;
+            std::vector<int> defs;
+            uint8_t early_clobber = 0;       // Physical registers destroyed before operands are read
+            int accumulator = -1;            // Index into refs of the ALU destination
+            std::vector<size_t> successors;
+            std::vector<bool> live_in;
+            std::vector<bool> live_out;
+        };
+
+        struct Interval {
+            size_t vreg;
+            size_t start;   // Slots: 2*site reads operands, 2*site+1 writes results
+            size_t end;
+        };
+
+        std::vector<Site> sites_;
+        std::unordered_map<std::string, size_t> label_sites_;   // Label -> index of following site
+        std::unordered_map<std::string, int> vreg_ids_;
+        std::vector<std::string> vreg_names_;
+        std::vector<bool> prefers_ax_;
+        std::vector<Interval> intervals_;
+        std::vector<int> assignment_;                 // Per vreg: physical register or -1
+        std::unordered_map<size_t, size_t> spill_slots_; // vreg -> slot index
+        std::vector<std::vector<int>> owner_;         // Per slot, per register: -1 free, -2 fixed, else vreg
+        std::vector<SemanticError> errors_;
+
+        void collect_sites(ProgramNode& program);
+        void classify(Site& site);
+        int value_for(const std::string& reg_name);
+        void link_successors();
+        void compute_liveness();
+        void assign_registers();
+        void check_reentrant_spills();
+        bool register_free(int reg, size_t start, size_t end) const;
+        void occupy(int reg, size_t start, size_t end, int owner);
+        void rewrite(ProgramNode& program);
+        void emit_site(size_t index, std::unique_ptr<ASTNode> statement,
+                       std::vector<std::unique_ptr<ASTNode>>& out);
+        void add_spill_area(ProgramNode& program);
+
+        size_t value_count() const { return PHYSICAL_REGISTER_COUNT + vreg_names_.size(); }
+        void error(const std::string& message, size_t line, size_t column);
+    };
+
+} // namespace assembler
+} // namespace lvm
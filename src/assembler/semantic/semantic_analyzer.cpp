@@ -69,7 +69,7 @@ namespace assembler {
         
         // Validate that previous page didn't exceed 64KB
         constexpr uint32_t MAX_PAGE_SIZE = 65536;  // 64KB
-        if (page_sizes_[current_page_] > MAX_PAGE_SIZE) {
+        if (!linear_addressing_ && page_sizes_[current_page_] > MAX_PAGE_SIZE) {
             error("Page " + std::to_string(current_page_) + 
                   " exceeds maximum size of 64KB (" + 
                   std::to_string(page_sizes_[current_page_]) + " bytes)",
@@ -118,9 +118,9 @@ namespace assembler {
             page_sizes_[current_page_] += size;
             current_page_address_ += size;
             
-            // Validate page size doesn't exceed 64KB
+            // Validate page size doesn't exceed 64KB (linear data may run past it)
             constexpr uint32_t MAX_PAGE_SIZE = 65536;
-            if (page_sizes_[current_page_] > MAX_PAGE_SIZE) {
+            if (!linear_addressing_ && page_sizes_[current_page_] > MAX_PAGE_SIZE) {
                 error("Page " + std::to_string(current_page_) + 
                       " exceeds maximum size of 64KB", 
                       node.line(), node.column());
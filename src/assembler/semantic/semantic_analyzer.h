@@ -67,6 +67,12 @@ namespace assembler {
             return (it != page_names_.end()) ? it->second : 0;
         }
         
+        /**
+         * Linear data addressing lifts the 64KB limit on a page's data, since
+         * LDX/STX reach any byte of the data context without paging
+         */
+        void set_linear_addressing(bool enabled) { linear_addressing_ = enabled; }
+        
         // Visitor methods
         void visit(ProgramNode& node) override;
         void visit(DataSectionNode& node) override;
@@ -92,6 +98,7 @@ namespace assembler {
         std::unordered_map<uint16_t, uint32_t> page_sizes_;  // Bytes used per page
         std::unordered_map<std::string, uint16_t> page_names_; // Page name -> number mapping
         uint32_t current_page_address_;   // Current address within page (0-65535)
+        bool linear_addressing_ = false;
         
         // Helper methods
         void error(const std::string& message, size_t line, size_t column);
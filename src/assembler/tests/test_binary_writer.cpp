@@ -239,3 +239,123 @@ TEST(BinaryWriterTest, MachineNameAndVersion) {
     EXPECT_EQ(binary[offset + 2], 0);  // revision high
     EXPECT_EQ(binary[offset + 3], 0);  // revision low
 }
+
+// Large enough that both fix-up and encoding split into several chunks
+static std::string large_program(int blocks) {
+    std::string source = "DATA\n";
+    for (int i = 0; i < blocks; ++i) {
+        source += "    val" + std::to_string(i) + ": DW [" + std::to_string(i * 7) + "]\n";
+    }
+    for (int i = 0; i + 2 < blocks; i += 3) {
+        source += "    table" + std::to_string(i) + ": DA [val" + std::to_string(i) + ", val" +
+                  std::to_string(i + 1) + ", val" + std::to_string(i + 2) + "]\n";
+    }
+    source += "CODE\n";
+    for (int i = 0; i < blocks; ++i) {
+        std::string n = std::to_string(i);
+        source += "step" + n + ":\n";
+        source += "    LDA AX, val" + n + "\n";
+        source += "    LDA BX, (val" + n + " + 1)\n";
+        source += "    ADD AX, BX\n";
+        source += "    JMP step" + std::to_string((i * 31) % blocks) + "\n";
+    }
+    source += "    HALT\n";
+    return source;
+}
+
+static std::vector<uint8_t> assemble_with_threads(const std::string& source, unsigned threads) {
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto ast = parser.parse();
+    
+    SymbolTable table;
+    SemanticAnalyzer analyzer(table);
+    EXPECT_TRUE(analyzer.analyze(*ast));
+    
+    CodeGraphBuilder builder(table);
+    auto graph = builder.build(*ast);
+    
+    AddressResolver resolver(table, *graph);
+    resolver.set_thread_count(threads);
+    EXPECT_TRUE(resolver.resolve());
+    
+    BinaryWriter writer;
+    writer.set_thread_count(threads);
+    return writer.generate_binary(*graph, "Parallel");
+}
+
+TEST(BinaryWriterTest, ParallelOutputMatchesSerial) {
+    std::string source = large_program(3000);
+    
+    auto serial = assemble_with_threads(source, 1);
+    ASSERT_GT(serial.size(), 3000u * 10);
+    
+    for (unsigned threads : {2u, 3u, 8u}) {
+        auto parallel = assemble_with_threads(source, threads);
+        EXPECT_EQ(parallel, serial) << "threads=" << threads;
+    }
+}
+
+TEST(BinaryWriterTest, ParallelMatchesNodeEncoding) {
+    std::string source = large_program(2048);
+    
+    Lexer lexer(source);
+    Parser parser(lexer);
+    auto ast = parser.parse();
+    SymbolTable table;
+    SemanticAnalyzer analyzer(table);
+    analyzer.analyze(*ast);
+    CodeGraphBuilder builder(table);
+    auto graph = builder.build(*ast);
+    AddressResolver resolver(table, *graph);
+    resolver.set_thread_count(4);
+    ASSERT_TRUE(resolver.resolve());
+    
+    // Reference code segment built one node at a time
+    std::vector<uint8_t> expected;
+    for (const auto& node : graph->code_nodes()) {
+        if (auto* instr = dynamic_cast<CodeInstructionNode*>(node.get())) {
+            auto bytes = instr->encode();
+            expected.insert(expected.end(), bytes.begin(), bytes.end());
+        }
+    }
+    
+    BinaryWriter writer;
+    writer.set_thread_count(4);
+    auto binary = writer.generate_binary(*graph, "Parallel");
+    
+    ASSERT_GE(binary.size(), expected.size());
+    std::vector<uint8_t> code(binary.end() - expected.size(), binary.end());
+    EXPECT_EQ(code, expected);
+}
+
+TEST(BinaryWriterTest, ParallelErrorsKeepSourceOrder) {
+    auto make_graph = [] {
+        auto graph = std::make_unique<CodeGraph>();
+        for (int i = 0; i < 4000; ++i) {
+            auto instr = std::make_unique<CodeInstructionNode>("JMP", 0x01);
+            InstructionOperand operand;
+            operand.type = InstructionOperand::Type::ADDRESS;
+            operand.symbol_name = (i % 97 == 0) ? "missing" + std::to_string(i) : "start";
+            instr->add_operand(operand);
+            graph->add_code_node(std::move(instr));
+        }
+        return graph;
+    };
+    
+    auto resolve_errors = [&](unsigned threads) {
+        SymbolTable table;
+        table.define("start", SymbolType::LABEL, 1, 1);
+        auto graph = make_graph();
+        graph->code_nodes().insert(graph->code_nodes().begin(), std::make_unique<CodeLabelNode>("start"));
+        AddressResolver resolver(table, *graph);
+        resolver.set_thread_count(threads);
+        EXPECT_FALSE(resolver.resolve());
+        return resolver.errors();
+    };
+    
+    auto serial = resolve_errors(1);
+    ASSERT_EQ(serial.size(), 42u);
+    EXPECT_EQ(serial.front(), "Undefined symbol 'missing0'");
+    EXPECT_EQ(resolve_errors(6), serial);
+}
@@ -60,6 +60,18 @@ TEST(LexerTest, Registers) {
     EXPECT_EQ(tokens[6].type, TokenType::REGISTER);
 }
 
+TEST(LexerTest, VirtualRegisters) {
+    Lexer lexer("%v0 %V12 %x");
+    auto tokens = lexer.tokenize();
+    
+    ASSERT_GE(tokens.size(), 3);
+    EXPECT_EQ(tokens[0].type, TokenType::REGISTER);
+    EXPECT_EQ(tokens[0].lexeme, "%v0");
+    EXPECT_EQ(tokens[1].type, TokenType::REGISTER);
+    EXPECT_EQ(tokens[1].lexeme, "%V12");
+    EXPECT_EQ(tokens[2].type, TokenType::UNKNOWN);
+}
+
 TEST(LexerTest, DecimalNumbers) {
     Lexer lexer("0 42 255 1000");
     auto tokens = lexer.tokenize();
@@ -228,3 +240,35 @@ TEST(LexerTest, MemoryAccess) {
     EXPECT_EQ(tokens[8].type, TokenType::NUMBER);
     EXPECT_EQ(tokens[9].type, TokenType::RIGHT_PAREN);
 }
+
+TEST(LexerTest, LongRunsAcrossScanChunks) {
+    std::string padding(37, ' ');
+    std::string name = "a_very_long_label_name_0123456789_XYZ";
+    std::string source = padding + "\t\r" + name + "  ; " + std::string(50, '#') + "\nHLT";
+    Lexer lexer(source);
+    auto tokens = lexer.tokenize();
+
+    ASSERT_EQ(tokens.size(), 4u);
+    EXPECT_EQ(tokens[0].type, TokenType::IDENTIFIER);
+    EXPECT_EQ(tokens[0].lexeme, name);
+    EXPECT_EQ(tokens[1].type, TokenType::END_OF_LINE);
+    EXPECT_EQ(tokens[2].lexeme, "HLT");
+    EXPECT_EQ(tokens[3].type, TokenType::END_OF_FILE);
+}
+
+TEST(LexerTest, TokenPositions) {
+    Lexer lexer("  LD AX, -5 ; note\n" + std::string(20, ' ') + "label_with_a_long_name: 0x10");
+    auto tokens = lexer.tokenize();
+
+    ASSERT_GE(tokens.size(), 8u);
+    EXPECT_EQ(tokens[0].line, 1u);
+    EXPECT_EQ(tokens[0].column, 3u);    // LD
+    EXPECT_EQ(tokens[1].column, 6u);    // AX
+    EXPECT_EQ(tokens[3].lexeme, "-5");
+    EXPECT_EQ(tokens[3].column, 10u);
+    EXPECT_EQ(tokens[4].type, TokenType::END_OF_LINE);
+    EXPECT_EQ(tokens[5].line, 2u);
+    EXPECT_EQ(tokens[5].column, 21u);   // label_with_a_long_name
+    EXPECT_EQ(tokens[7].line, 2u);
+    EXPECT_EQ(tokens[7].column, 45u);   // 0x10
+}
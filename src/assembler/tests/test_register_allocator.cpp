@@ -0,0 +1,267 @@
+#include <gtest/gtest.h>
+#include "../semantic/register_allocator.h"
+#include "../semantic/semantic_analyzer.h"
+#include "../ir/code_graph_builder.h"
+#include "../lexer/lexer.h"
+#include "../parser/parser.h"
+
+using namespace lvm::assembler;
+
+namespace {
+    std::string render_expression(const ExpressionNode* expr) {
+        switch (expr->type()) {
+            case ExpressionNode::Type::IDENTIFIER: return expr->identifier();
+            case ExpressionNode::Type::NUMBER: return std::to_string(expr->number());
+            case ExpressionNode::Type::REGISTER: return expr->register_name();
+            case ExpressionNode::Type::BINARY_OP:
+                return render_expression(expr->left()) + expr->op() + render_expression(expr->right());
+        }
+        return "";
+    }
+
+    // Flattens the code sections to "MNEMONIC op, op" lines
+    std::vector<std::string> render(const ProgramNode& program) {
+        std::vector<std::string> lines;
+        for (const auto& section : program.sections()) {
+            auto* code = dynamic_cast<CodeSectionNode*>(section.get());
+            if (!code) {
+                continue;
+            }
+            for (const auto& stmt : code->statements()) {
+                auto* instr = dynamic_cast<InstructionNode*>(stmt.get());
+                if (!instr) {
+                    continue;
+                }
+                std::string line = instr->mnemonic();
+                for (size_t i = 0; i < instr->operands().size(); ++i) {
+                    const auto& operand = instr->operands()[i];
+                    line += (i == 0 ? " " : ", ");
+                    std::string text = operand->expression() ? render_expression(operand->expression()) : "";
+                    line += operand->type() == OperandNode::Type::ADDRESS_EXPR ? "(" + text + ")" : text;
+                }
+                lines.push_back(line);
+            }
+        }
+        return lines;
+    }
+
+    std::unique_ptr<ProgramNode> parse(const std::string& source) {
+        Lexer lexer(source);
+        Parser parser(lexer);
+        auto ast = parser.parse();
+        EXPECT_FALSE(parser.has_errors());
+        return ast;
+    }
+
+    size_t count(const std::vector<std::string>& lines, const std::string& prefix) {
+        size_t n = 0;
+        for (const auto& line : lines) {
+            if (line.rfind(prefix, 0) == 0) {
+                ++n;
+            }
+        }
+        return n;
+    }
+}
+
+TEST(RegisterAllocatorTest, RecognisesVirtualRegisterNames) {
+    EXPECT_TRUE(RegisterAllocator::is_virtual_register("%v0"));
+    EXPECT_TRUE(RegisterAllocator::is_virtual_register("%V17"));
+    EXPECT_FALSE(RegisterAllocator::is_virtual_register("%v"));
+    EXPECT_FALSE(RegisterAllocator::is_virtual_register("AX"));
+    EXPECT_FALSE(RegisterAllocator::is_virtual_register("%vx"));
+}
+
+TEST(RegisterAllocatorTest, PhysicalProgramUnchanged) {
+    auto ast = parse("CODE\nLD AX, 1\nLD BX, 2\nADD AX, BX\nHALT\n");
+    auto before = render(*ast);
+
+    RegisterAllocator allocator;
+    EXPECT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(render(*ast), before);
+    EXPECT_EQ(allocator.spilled_count(), 0u);
+}
+
+TEST(RegisterAllocatorTest, DisjointLifetimesShareRegister) {
+    auto ast = parse("CODE\nLD %v0, 1\nPUSH %v0\nLD %v1, 2\nPUSH %v1\nHALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.assigned_register("%v0"), "BX");
+    EXPECT_EQ(allocator.assigned_register("%v1"), "BX");
+
+    std::vector<std::string> expected = { "LD BX, 1", "PUSH BX", "LD BX, 2", "PUSH BX", "HALT" };
+    EXPECT_EQ(render(*ast), expected);
+}
+
+TEST(RegisterAllocatorTest, AccumulatorLandsInAX) {
+    auto ast = parse("CODE\nLD %v0, 5\nLD %v1, 7\nADD %v0, %v1\nPUSH %v0\nHALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.assigned_register("%v0"), "AX");
+    EXPECT_EQ(allocator.assigned_register("%v1"), "BX");
+
+    auto lines = render(*ast);
+    EXPECT_EQ(count(lines, "SWP"), 0u);
+    EXPECT_EQ(lines[2], "ADD AX, BX");
+}
+
+TEST(RegisterAllocatorTest, SecondAccumulatorIsWrittenInPlace) {
+    auto ast = parse(
+        "CODE\n"
+        "LD %v0, 1\n"
+        "LD %v1, 2\n"
+        "ADD %v0, 3\n"
+        "ADD %v1, %v0\n"
+        "PUSH %v0\n"
+        "PUSH %v1\n"
+        "HALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.assigned_register("%v0"), "AX");
+    EXPECT_EQ(allocator.assigned_register("%v1"), "BX");
+
+    // Word ALU operations can target BX directly
+    std::vector<std::string> expected = {
+        "LD AX, 1", "LD BX, 2", "ADD AX, 3", "ADD BX, AX",
+        "PUSH AX", "PUSH BX", "HALT"
+    };
+    EXPECT_EQ(render(*ast), expected);
+}
+
+TEST(RegisterAllocatorTest, SecondByteAccumulatorIsSwappedThroughAX) {
+    auto ast = parse(
+        "CODE\n"
+        "LD %v0, 1\n"
+        "LD %v1, 2\n"
+        "ADB %v0, 3\n"
+        "ADB %v1, 4\n"
+        "PUSH %v0\n"
+        "PUSH %v1\n"
+        "HALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.assigned_register("%v0"), "AX");
+    EXPECT_EQ(allocator.assigned_register("%v1"), "BX");
+
+    // Byte forms only write AX: v1 is swapped in and back out
+    std::vector<std::string> expected = {
+        "LD AX, 1", "LD BX, 2", "ADB AX, 3",
+        "SWP AX, BX", "ADB AX, 4", "SWP AX, BX",
+        "PUSH AX", "PUSH BX", "HALT"
+    };
+    EXPECT_EQ(render(*ast), expected);
+}
+
+TEST(RegisterAllocatorTest, LoopKeepsValuesLiveAcrossBackEdge) {
+    auto ast = parse(
+        "CODE\n"
+        "LD %v0, 10\n"
+        "LD %v1, 0\n"
+        "LOOP:\n"
+        "INC %v1\n"
+        "DEC %v0\n"
+        "JNZ LOOP\n"
+        "PUSH %v1\n"
+        "HALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_NE(allocator.assigned_register("%v0"), "");
+    EXPECT_NE(allocator.assigned_register("%v1"), "");
+    EXPECT_NE(allocator.assigned_register("%v0"), allocator.assigned_register("%v1"));
+}
+
+TEST(RegisterAllocatorTest, AvoidsPhysicalRegistersInUse) {
+    auto ast = parse("CODE\nLD BX, 1\nLD %v0, 2\nPUSH %v0\nPUSH BX\nHALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.assigned_register("%v0"), "CX");
+}
+
+TEST(RegisterAllocatorTest, CompareOperandsStayOutOfAX) {
+    auto ast = parse("CODE\nLD %v0, 1\nLD %v1, 2\nCMP %v0, %v1\nPUSH %v1\nHALT\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_NE(allocator.assigned_register("%v0"), "AX");
+    EXPECT_NE(allocator.assigned_register("%v1"), "AX");
+}
+
+TEST(RegisterAllocatorTest, ValuesLiveAcrossCallAreSpilled) {
+    auto ast = parse("CODE\nLD %v0, 1\nCALL SUB\nPUSH %v0\nHALT\nSUB:\nRET\n");
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.spilled_count(), 1u);
+
+    auto lines = render(*ast);
+    EXPECT_EQ(lines[1], "STA (__vreg_spill+0), BX");
+    EXPECT_EQ(lines[3], "LDA BX, (__vreg_spill+0)");
+}
+
+TEST(RegisterAllocatorTest, SpillsAcrossRecursiveCallAreRejected) {
+    // FACT keeps %v0 across a CALL back into itself; the inner activation
+    // would overwrite the outer one's spill slot
+    auto ast = parse("CODE\nCALL FACT\nHALT\n"
+                     "FACT:\nLD %v0, AX\nDEC AX\nJPZ DONE\nCALL FACT\nMUL %v0\nDONE:\nRET\n");
+
+    RegisterAllocator allocator;
+    EXPECT_FALSE(allocator.allocate(*ast));
+    ASSERT_EQ(allocator.errors().size(), 1u);
+    EXPECT_NE(allocator.errors()[0].message.find("can re-enter 'FACT'"), std::string::npos);
+    EXPECT_EQ(allocator.errors()[0].line, 8u);
+}
+
+TEST(RegisterAllocatorTest, SpillsAcrossMutualRecursionAreRejected) {
+    auto ast = parse("CODE\nCALL EVEN\nHALT\n"
+                     "EVEN:\nLD %v0, 1\nCALL ODD\nPUSH %v0\nRET\n"
+                     "ODD:\nCALL EVEN\nRET\n");
+
+    RegisterAllocator allocator;
+    EXPECT_FALSE(allocator.allocate(*ast));
+    ASSERT_EQ(allocator.errors().size(), 1u);
+    EXPECT_NE(allocator.errors()[0].message.find("'ODD', which can re-enter 'EVEN'"), std::string::npos);
+
+    // The same spill in a subroutine that nothing calls back into is fine
+    auto leaf = parse("CODE\nCALL OUTER\nHALT\n"
+                      "OUTER:\nLD %v0, 1\nCALL INNER\nPUSH %v0\nRET\n"
+                      "INNER:\nRET\n");
+    RegisterAllocator leaf_allocator;
+    EXPECT_TRUE(leaf_allocator.allocate(*leaf));
+    EXPECT_EQ(leaf_allocator.spilled_count(), 1u);
+}
+
+TEST(RegisterAllocatorTest, PressureSpillsAndStillAssembles) {
+    std::string source = "CODE\n";
+    for (int i = 0; i < 7; ++i) {
+        source += "LD %v" + std::to_string(i) + ", " + std::to_string(i) + "\n";
+    }
+    for (int i = 0; i < 7; ++i) {
+        source += "PUSH %v" + std::to_string(i) + "\n";
+    }
+    source += "HALT\n";
+    auto ast = parse(source);
+
+    RegisterAllocator allocator;
+    ASSERT_TRUE(allocator.allocate(*ast));
+    EXPECT_EQ(allocator.spilled_count(), 2u);
+
+    auto lines = render(*ast);
+    EXPECT_EQ(count(lines, "STA"), 2u);
+    EXPECT_EQ(count(lines, "LDA"), 2u);
+
+    // The spill area is an ordinary data definition
+    SymbolTable table;
+    SemanticAnalyzer analyzer(table);
+    ASSERT_TRUE(analyzer.analyze(*ast));
+    ASSERT_TRUE(table.exists(RegisterAllocator::SPILL_AREA_LABEL));
+
+    CodeGraphBuilder builder(table, &analyzer);
+    auto graph = builder.build(*ast);
+    ASSERT_NE(graph, nullptr);
+}
@@ -418,3 +418,23 @@ TEST(SemanticAnalyzerTest, PageDirectiveSizeValidation) {
     EXPECT_NE(errors[0].message.find("exceeds maximum size"), std::string::npos);
 }
 
+
+TEST(SemanticAnalyzerTest, LinearAddressingLiftsPageLimit) {
+    // Two 40000-byte strings overflow one page but fit a linear data context
+    std::string text(40000, 'a');
+    std::string code = "DATA\nfirst: DB \"" + text + "\"\nsecond: DB \"" + text + "\"\nCODE\n    HALT\n";
+    
+    Lexer lexer(code);
+    Parser parser(lexer);
+    auto ast = parser.parse();
+    ASSERT_NE(ast, nullptr);
+    
+    SymbolTable paged_table;
+    SemanticAnalyzer paged(paged_table);
+    EXPECT_FALSE(paged.analyze(*ast));
+    
+    SymbolTable linear_table;
+    SemanticAnalyzer linear(linear_table);
+    linear.set_linear_addressing(true);
+    EXPECT_TRUE(linear.analyze(*ast));
+}
@@ -0,0 +1,119 @@
+#include "async_output.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+
+using namespace lvm;
+
+namespace {
+    size_t round_up_to_power_of_two(size_t value) {
+        size_t result = 1;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+}
+
+AsyncOutput::AsyncOutput(int fd, size_t capacity, FullPolicy policy)
+    : buffer_(round_up_to_power_of_two(std::max<size_t>(capacity, 1))),
+      mask_(buffer_.size() - 1),
+      fd_(fd),
+      policy_(policy) {
+    writer_ = std::thread(&AsyncOutput::run_writer, this);
+}
+
+AsyncOutput::~AsyncOutput() {
+    head_.fetch_or(CLOSED, std::memory_order_release);
+    head_.notify_one();
+    if (writer_.joinable()) {
+        writer_.join();
+    }
+}
+
+void AsyncOutput::write(const char* data, size_t length) {
+    uint64_t head = head_.load(std::memory_order_relaxed);
+    while (length > 0) {
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        size_t free_space = buffer_.size() - static_cast<size_t>(head - tail);
+        if (free_space == 0) {
+            if (policy_ == FullPolicy::BLOCK) {
+                tail_.wait(tail, std::memory_order_acquire);
+            } else {
+                std::this_thread::yield();
+            }
+            continue;
+        }
+
+        // Copy up to the end of the buffer, then wrap
+        size_t count = std::min(length, free_space);
+        size_t offset = static_cast<size_t>(head & mask_);
+        size_t first = std::min(count, buffer_.size() - offset);
+        std::memcpy(buffer_.data() + offset, data, first);
+        std::memcpy(buffer_.data(), data + first, count - first);
+
+        head += count;
+        data += count;
+        length -= count;
+        head_.store(head, std::memory_order_release);
+        head_.notify_one();
+    }
+}
+
+void AsyncOutput::flush() {
+    uint64_t head = head_.load(std::memory_order_relaxed) & ~CLOSED;
+    uint64_t tail = tail_.load(std::memory_order_acquire);
+    while (tail != head) {
+        tail_.wait(tail, std::memory_order_acquire);
+        tail = tail_.load(std::memory_order_acquire);
+    }
+}
+
+std::string AsyncOutput::error() const {
+    int error = error_.load(std::memory_order_relaxed);
+    return error == 0 ? std::string() : std::strerror(error);
+}
+
+void AsyncOutput::run_writer() {
+    uint64_t tail = 0;
+    for (;;) {
+        uint64_t head = head_.load(std::memory_order_acquire);
+        bool closed = (head & CLOSED) != 0;
+        head &= ~CLOSED;
+
+        if (head == tail) {
+            if (closed) {
+                return;
+            }
+            head_.wait(tail, std::memory_order_acquire);
+            continue;
+        }
+
+        // Drain everything available: one write, or two if it wraps
+        size_t offset = static_cast<size_t>(tail & mask_);
+        size_t available = static_cast<size_t>(head - tail);
+        size_t first = std::min(available, buffer_.size() - offset);
+        write_all(buffer_.data() + offset, first);
+        write_all(buffer_.data(), available - first);
+
+        tail = head;
+        tail_.store(tail, std::memory_order_release);
+        tail_.notify_one();
+    }
+}
+
+void AsyncOutput::write_all(const char* data, size_t length) {
+    while (length > 0 && error_.load(std::memory_order_relaxed) == 0) {
+        ssize_t written = ::write(fd_, data, length);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            error_.store(errno, std::memory_order_relaxed);
+            return;
+        }
+        data += written;
+        length -= static_cast<size_t>(written);
+    }
+}
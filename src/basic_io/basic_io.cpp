@@ -2,16 +2,33 @@
 #include <iostream>
 #include "basic_io_accessor.h"
 #include "stack.h"
+#include "line_tokenizer.h"
+#include "paged_memory_accessor.h"
+#include <vector>
+#include <poll.h>
+#include <unistd.h>
 using namespace lvm;
 
 BasicIO::BasicIO(std::shared_ptr<IVMemUnit> memUnit, std::shared_ptr<IStack> stack)   
-    : memUnit(std::move(memUnit)), stack(std::move(stack))
+    : memUnit(std::move(memUnit)), stack(std::move(stack)), input_(&std::cin)
 {
     // TODO: Initialize I/O subsystem
 }
 
 BasicIO::~BasicIO() = default;
 
+bool BasicIO::input_ready() const {
+    if (input_->rdbuf()->in_avail() > 0 || !input_->good()) {
+        return true;
+    }
+    if (input_ == &std::cin) {
+        // Hang-up and errors count as ready: the read will not wait either
+        pollfd fd{STDIN_FILENO, POLLIN, 0};
+        return poll(&fd, 1, 0) != 0;
+    }
+    return input_->rdbuf()->in_avail() < 0;
+}
+
 // TODO: Implement methods
 
 void BasicIO::write_string_from_stack() {
@@ -23,7 +40,7 @@ void BasicIO::write_string_from_stack() {
         output += static_cast<char>(ch);
     }
     // Output the string
-    std::cout << output;
+    emit(output, false);
 }
 
 void BasicIO::write_line_from_stack() {
@@ -36,15 +53,17 @@ void BasicIO::write_line_from_stack() {
             
     }
     // Output the string with newline
-    std::cout << output << std::endl;
+    emit(output, true);
 }
 
 
 void BasicIO::read_line_onto_stack() {
     auto accessor = stack->get_accessor(MemAccessMode::READ_WRITE);
     auto maxLength = accessor->pop_word();
+    // Prompts written before the read must be visible first
+    flush_output();
     std::string input;
-    std::getline(std::cin, input);
+    std::getline(*input_, input);
     uint16_t count = static_cast<uint16_t>(input.length());
     if (count > maxLength) {
         count = maxLength; // Truncate if input exceeds max length
@@ -56,10 +75,86 @@ void BasicIO::read_line_onto_stack() {
     accessor->push_word(count);
 }
 
+void BasicIO::read_line_tokenized() {
+    auto accessor = stack->get_accessor(MemAccessMode::READ_WRITE);
+    addr_t buffer_address = accessor->pop_word();
+    word_t buffer_capacity = accessor->pop_word();
+    addr_t table_address = accessor->pop_word();
+    word_t max_tokens = accessor->pop_word();
+    addr_t delimiter_address = accessor->pop_word();
+    word_t delimiter_count = accessor->pop_word();
+    word_t options = accessor->pop_word();
+    
+    auto data_accessor = memUnit->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    std::string delimiters;
+    for (word_t i = 0; i < delimiter_count; ++i) {
+        delimiters += static_cast<char>(data_accessor->read_byte(static_cast<addr_t>(delimiter_address + i)));
+    }
+    
+    LineTokenizer::CaseFold fold = LineTokenizer::CaseFold::NONE;
+    if (options & TOKENIZE_FOLD_LOWER) {
+        fold = LineTokenizer::CaseFold::LOWER;
+    } else if (options & TOKENIZE_FOLD_UPPER) {
+        fold = LineTokenizer::CaseFold::UPPER;
+    }
+    LineTokenizer tokenizer(delimiter_count > 0 ? std::string_view(delimiters)
+                                                : LineTokenizer::DEFAULT_DELIMITERS, fold);
+    
+    // Prompts written before the read must be visible first
+    flush_output();
+    std::string line;
+    std::getline(*input_, line);
+    if (line.size() > buffer_capacity) {
+        line.resize(buffer_capacity);
+    }
+    
+    std::vector<LineToken> tokens(max_tokens);
+    size_t token_count = tokenizer.tokenize(line, tokens.data(), tokens.size());
+    
+    for (size_t i = 0; i < line.size(); ++i) {
+        data_accessor->write_byte(static_cast<addr_t>(buffer_address + i), static_cast<byte_t>(line[i]));
+    }
+    for (size_t i = 0; i < token_count; ++i) {
+        addr_t entry = static_cast<addr_t>(table_address + i * 4);
+        data_accessor->write_word(entry, tokens[i].offset);
+        data_accessor->write_word(static_cast<addr_t>(entry + 2), tokens[i].length);
+    }
+    
+    accessor->push_word(static_cast<word_t>(line.size()));
+    accessor->push_word(static_cast<word_t>(token_count));
+}
+
 void BasicIO::debug_print_word() {
     auto accessor = stack->get_accessor(MemAccessMode::READ_WRITE);
     word_t value = accessor->pop_word();
-    std::cout << value << std::endl;
+    emit(std::to_string(value), true);
+}
+
+void BasicIO::emit(const std::string& text, bool end_line) {
+    if (async_output_) {
+        async_output_->write(text);
+        if (end_line) {
+            async_output_->write("\n", 1);
+        }
+    } else if (end_line) {
+        std::cout << text << std::endl;
+    } else {
+        std::cout << text;
+    }
+}
+
+void BasicIO::enable_async_output(int fd, size_t capacity, AsyncOutput::FullPolicy policy) {
+    // Anything already buffered by std::cout goes out before the ring takes over
+    flush_output();
+    async_output_ = std::make_unique<AsyncOutput>(fd, capacity, policy);
+}
+
+void BasicIO::flush_output() {
+    if (async_output_) {
+        async_output_->flush();
+    } else {
+        std::cout.flush();
+    }
 }
 
 std::unique_ptr<BasicIOAccessor> BasicIO::get_accessor() {
@@ -85,6 +180,10 @@ void BasicIOAccessor::read_line_onto_stack() {
     basic_io_ref.read_line_onto_stack();
 }
 
+void BasicIOAccessor::read_line_tokenized() {
+    basic_io_ref.read_line_tokenized();
+}
+
 void BasicIOAccessor::debug_print_word() {
     basic_io_ref.debug_print_word();
 }   
\ No newline at end of file
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lvm {
+
+    /**
+     * AsyncOutput - Guest output drained to a file descriptor by a writer thread
+     * 
+     * The guest thread (single producer) copies bytes into a lock-free ring;
+     * a dedicated writer thread (single consumer) drains it with as few, as
+     * large write() calls as the ring layout allows. A slow terminal or pipe
+     * then only stalls the guest once the ring is full, and what happens then
+     * is chosen by FullPolicy.
+     * 
+     * write() and flush() must only be called from one thread at a time.
+     */
+    class AsyncOutput {
+    public:
+        enum class FullPolicy {
+            BLOCK,   // Sleep until the writer frees space
+            YIELD    // Yield the guest thread and retry
+        };
+
+        static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+
+        // Capacity is rounded up to a power of two
+        explicit AsyncOutput(int fd, size_t capacity = DEFAULT_CAPACITY,
+                             FullPolicy policy = FullPolicy::BLOCK);
+        // Drains everything written so far, then stops the writer thread
+        ~AsyncOutput();
+
+        AsyncOutput(const AsyncOutput&) = delete;
+        AsyncOutput& operator=(const AsyncOutput&) = delete;
+
+        void write(const char* data, size_t length);
+        void write(const std::string& text) { write(text.data(), text.size()); }
+
+        /**
+         * Wait until every byte written so far has been handed to the fd
+         */
+        void flush();
+
+        size_t capacity() const { return buffer_.size(); }
+
+        // First write() error reported by the writer thread (empty if none);
+        // output after an error is discarded so the guest never deadlocks
+        std::string error() const;
+
+    private:
+        // Set in head_ once the producer is done, so the writer wakes and exits
+        static constexpr uint64_t CLOSED = uint64_t{1} << 63;
+
+        std::vector<char> buffer_;
+        size_t mask_;
+        int fd_;
+        FullPolicy policy_;
+
+        // Positions grow without wrapping; index into buffer_ with & mask_
+        alignas(64) std::atomic<uint64_t> head_{0};   // Written by the producer
+        alignas(64) std::atomic<uint64_t> tail_{0};   // Written by the writer thread
+        std::atomic<int> error_{0};
+
+        std::thread writer_;
+
+        void run_writer();
+        void write_all(const char* data, size_t length);
+    };
+
+} // namespace lvm
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "ibasic_io.h"
+#include "async_output.h"
+#include <iosfwd>
 #include <memory>
+#include <string>
 #include "ivmemunit.h"
 #include "stack.h"
 
@@ -28,16 +31,58 @@ namespace lvm {
         
         // TODO: Add implementation methods
         std::unique_ptr<BasicIOAccessor> get_accessor() override;
+        
+        /**
+         * Route guest output through a ring drained by a writer thread
+         * 
+         * Print syscalls no longer wait on the output fd; input reads flush
+         * pending output first so prompts still appear before the read.
+         */
+        void enable_async_output(int fd, size_t capacity = AsyncOutput::DEFAULT_CAPACITY,
+                                 AsyncOutput::FullPolicy policy = AsyncOutput::FullPolicy::BLOCK);
+        
+        /**
+         * Wait until all guest output has reached its destination
+         */
+        void flush_output();
+        
+        /**
+         * Data context that READ_LINE_TOKENIZED writes the line and token table into
+         */
+        void set_data_context(context_id_t data_context_id) { data_context_id_ = data_context_id; }
+        
+        /**
+         * Read guest input from stream instead of std::cin
+         */
+        void set_input(std::istream& input) { input_ = &input; }
+        
+        /**
+         * True if an input read would return without waiting
+         * 
+         * Standard input is polled; other streams are ready while they have
+         * buffered characters or have reached end of file.
+         */
+        bool input_ready() const;
+        
+        // Bits of the READ_LINE_TOKENIZED options word
+        static constexpr word_t TOKENIZE_FOLD_LOWER = 0x0001;
+        static constexpr word_t TOKENIZE_FOLD_UPPER = 0x0002;
     private:
         friend class BasicIOAccessor;
         
         // TODO: Add private members
         std::shared_ptr<IVMemUnit> memUnit;
         std::shared_ptr<IStack> stack;
+        std::unique_ptr<AsyncOutput> async_output_;   // Null when writing synchronously
+        std::istream* input_;
+        context_id_t data_context_id_ = 0;
+        
+        void emit(const std::string& text, bool end_line);
 
         void write_string_from_stack();
         void write_line_from_stack();
         void read_line_onto_stack();
+        void read_line_tokenized();
         void debug_print_word();
         
     };
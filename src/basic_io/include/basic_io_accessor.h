@@ -10,6 +10,7 @@ namespace lvm {
         void write_string_from_stack();
         void write_line_from_stack();
         void read_line_onto_stack();
+        void read_line_tokenized();
         void debug_print_word();
 
     private:
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace lvm {
+
+    /**
+     * Token position within a tokenized line
+     */
+    struct LineToken {
+        uint16_t offset;
+        uint16_t length;
+    };
+
+    /**
+     * LineTokenizer - Splits a line into tokens and folds case in one pass
+     * 
+     * Backs the READ_LINE_TOKENIZED syscall so guests get a ready-made token
+     * table instead of scanning the line character by character. Runs of
+     * delimiters separate tokens; leading and trailing delimiters produce no
+     * empty tokens.
+     */
+    class LineTokenizer {
+    public:
+        enum class CaseFold { NONE, LOWER, UPPER };
+
+        static constexpr std::string_view DEFAULT_DELIMITERS = " \t";
+
+        explicit LineTokenizer(std::string_view delimiters = DEFAULT_DELIMITERS,
+                               CaseFold fold = CaseFold::NONE);
+
+        /**
+         * Fold line in place and record up to max_tokens tokens
+         * 
+         * @return Number of tokens written to tokens (never more than max_tokens)
+         */
+        size_t tokenize(std::string& line, LineToken* tokens, size_t max_tokens) const;
+
+    private:
+        std::array<bool, 256> is_delimiter_{};
+        CaseFold fold_;
+    };
+
+} // namespace lvm
@@ -0,0 +1,35 @@
+#include "line_tokenizer.h"
+
+using namespace lvm;
+
+LineTokenizer::LineTokenizer(std::string_view delimiters, CaseFold fold)
+    : fold_(fold)
+{
+    for (char c : delimiters) {
+        is_delimiter_[static_cast<unsigned char>(c)] = true;
+    }
+}
+
+size_t LineTokenizer::tokenize(std::string& line, LineToken* tokens, size_t max_tokens) const {
+    size_t count = 0;
+    bool in_token = false;
+    for (size_t i = 0; i < line.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(line[i]);
+        if (fold_ == CaseFold::LOWER && c >= 'A' && c <= 'Z') {
+            line[i] = static_cast<char>(c + ('a' - 'A'));
+        } else if (fold_ == CaseFold::UPPER && c >= 'a' && c <= 'z') {
+            line[i] = static_cast<char>(c - ('a' - 'A'));
+        }
+
+        if (is_delimiter_[c]) {
+            in_token = false;
+        } else if (in_token) {
+            ++tokens[count - 1].length;
+        } else if (count < max_tokens) {
+            tokens[count++] = LineToken{static_cast<uint16_t>(i), 1};
+            in_token = true;
+        }
+        // Tokens past max_tokens are dropped; folding still covers the whole line
+    }
+    return count;
+}
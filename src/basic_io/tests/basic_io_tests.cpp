@@ -1,7 +1,14 @@
 #include <gtest/gtest.h>
 #include "basic_io.h"
+#include "basic_io_accessor.h"
+#include "async_output.h"
+#include "line_tokenizer.h"
+#include "paged_memory_accessor.h"
 #include "vmemunit.h"
 #include "stack.h"
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 
 using namespace lvm;
 
@@ -25,4 +32,211 @@ TEST_F(BasicIOTest, Creation) {
     SUCCEED();
 }
 
-// TODO: Add more tests
+namespace {
+    // Pipe whose read end is drained on a background thread
+    class PipeCapture {
+    public:
+        PipeCapture() {
+            if (pipe(fds_) != 0) {
+                throw std::runtime_error("pipe failed");
+            }
+            reader_ = std::thread([this] {
+                char chunk[4096];
+                ssize_t n;
+                while ((n = read(fds_[0], chunk, sizeof(chunk))) > 0) {
+                    captured_.append(chunk, static_cast<size_t>(n));
+                }
+            });
+        }
+        ~PipeCapture() {
+            close_write();
+            if (reader_.joinable()) {
+                reader_.join();
+            }
+            close(fds_[0]);
+        }
+        int write_fd() const { return fds_[1]; }
+        // Closes the write end and waits for everything to be read
+        std::string finish() {
+            close_write();
+            reader_.join();
+            return captured_;
+        }
+    private:
+        int fds_[2];
+        bool write_closed_ = false;
+        std::thread reader_;
+        std::string captured_;
+        void close_write() {
+            if (!write_closed_) {
+                close(fds_[1]);
+                write_closed_ = true;
+            }
+        }
+    };
+
+    std::string pattern(size_t length) {
+        std::string text;
+        for (size_t i = 0; i < length; ++i) {
+            text += static_cast<char>('a' + i % 26);
+        }
+        return text;
+    }
+}
+
+TEST(AsyncOutputTest, PreservesOrderAcrossWraparound) {
+    PipeCapture pipe;
+    std::string expected;
+    {
+        // Small ring so writes wrap and fill it repeatedly
+        AsyncOutput output(pipe.write_fd(), 16);
+        EXPECT_EQ(output.capacity(), 16u);
+        for (size_t i = 1; i <= 200; ++i) {
+            std::string piece = pattern(i % 37);
+            output.write(piece);
+            expected += piece;
+        }
+    }
+    EXPECT_EQ(pipe.finish(), expected);
+}
+
+TEST(AsyncOutputTest, YieldPolicyDeliversEverything) {
+    PipeCapture pipe;
+    std::string expected = pattern(10000);
+    {
+        AsyncOutput output(pipe.write_fd(), 64, AsyncOutput::FullPolicy::YIELD);
+        output.write(expected);
+    }
+    EXPECT_EQ(pipe.finish(), expected);
+}
+
+TEST(AsyncOutputTest, FlushWaitsForWriter) {
+    int fds[2];
+    ASSERT_EQ(pipe(fds), 0);
+    AsyncOutput output(fds[1], 1024);
+    output.write("prompt> ");
+    output.flush();
+
+    // Nothing else is writing, so the bytes must already be in the pipe
+    char buffer[16] = {};
+    ASSERT_EQ(read(fds[0], buffer, sizeof(buffer)), 8);
+    EXPECT_STREQ(buffer, "prompt> ");
+    close(fds[0]);
+    close(fds[1]);
+}
+
+TEST_F(BasicIOTest, AsyncPrintSyscalls) {
+    PipeCapture pipe;
+    {
+        BasicIO io(vmem_unit, stack);
+        io.enable_async_output(pipe.write_fd());
+        vmem_unit->set_mode(IVMemUnit::Mode::PROTECTED);
+
+        // Strings are popped first character first, after the length word
+        auto accessor = stack->get_accessor(MemAccessMode::READ_WRITE);
+        accessor->push_byte('i');
+        accessor->push_byte('h');
+        accessor->push_word(2);
+        io.get_accessor()->write_line_from_stack();
+        accessor->push_word(42);
+        io.get_accessor()->debug_print_word();
+        io.flush_output();
+    }
+    EXPECT_EQ(pipe.finish(), "hi\n42\n");
+}
+
+namespace {
+    std::vector<std::string> token_strings(const std::string& line, const LineToken* tokens, size_t count) {
+        std::vector<std::string> words;
+        for (size_t i = 0; i < count; ++i) {
+            words.push_back(line.substr(tokens[i].offset, tokens[i].length));
+        }
+        return words;
+    }
+}
+
+TEST(LineTokenizerTest, SplitsOnRunsOfDelimiters) {
+    LineTokenizer tokenizer;
+    std::string line = "  take   the\tlamp ";
+    LineToken tokens[8];
+    size_t count = tokenizer.tokenize(line, tokens, 8);
+    EXPECT_EQ(token_strings(line, tokens, count), (std::vector<std::string>{"take", "the", "lamp"}));
+    EXPECT_EQ(tokens[0].offset, 2);
+    EXPECT_EQ(line, "  take   the\tlamp ");
+}
+
+TEST(LineTokenizerTest, FoldsCaseAndHonoursCustomDelimiters) {
+    LineTokenizer lower(",;", LineTokenizer::CaseFold::LOWER);
+    std::string line = "Get Lamp,DROP;;Key";
+    LineToken tokens[8];
+    size_t count = lower.tokenize(line, tokens, 8);
+    EXPECT_EQ(line, "get lamp,drop;;key");
+    EXPECT_EQ(token_strings(line, tokens, count), (std::vector<std::string>{"get lamp", "drop", "key"}));
+
+    LineTokenizer upper(LineTokenizer::DEFAULT_DELIMITERS, LineTokenizer::CaseFold::UPPER);
+    line = "go North";
+    count = upper.tokenize(line, tokens, 8);
+    EXPECT_EQ(token_strings(line, tokens, count), (std::vector<std::string>{"GO", "NORTH"}));
+}
+
+TEST(LineTokenizerTest, StopsAtMaxTokens) {
+    LineTokenizer tokenizer(LineTokenizer::DEFAULT_DELIMITERS, LineTokenizer::CaseFold::LOWER);
+    std::string line = "a b c D";
+    LineToken tokens[2];
+    size_t count = tokenizer.tokenize(line, tokens, 2);
+    EXPECT_EQ(token_strings(line, tokens, count), (std::vector<std::string>{"a", "b"}));
+    EXPECT_EQ(line, "a b c d");   // folding still covers the whole line
+    EXPECT_EQ(tokenizer.tokenize(line, tokens, 0), 0u);
+}
+
+TEST_F(BasicIOTest, ReadLineTokenizedSyscall) {
+    context_id_t data_context = vmem_unit->create_context(65536);
+    std::istringstream input("Open the  DOOR\nnext line\n");
+    BasicIO io(vmem_unit, stack);
+    io.set_data_context(data_context);
+    io.set_input(input);
+    vmem_unit->set_mode(IVMemUnit::Mode::PROTECTED);
+
+    auto data = vmem_unit->get_context(data_context)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    data->write_byte(0x300, ' ');
+
+    // Arguments are popped in order: buffer, capacity, table, max tokens,
+    // delimiters, delimiter count, options
+    auto accessor = stack->get_accessor(MemAccessMode::READ_WRITE);
+    accessor->push_word(BasicIO::TOKENIZE_FOLD_LOWER);
+    accessor->push_word(1);
+    accessor->push_word(0x300);
+    accessor->push_word(4);
+    accessor->push_word(0x200);
+    accessor->push_word(64);
+    accessor->push_word(0x100);
+    io.get_accessor()->read_line_tokenized();
+
+    EXPECT_EQ(accessor->pop_word(), 3);    // token count
+    EXPECT_EQ(accessor->pop_word(), 14);   // line length
+
+    std::string line;
+    for (addr_t i = 0; i < 14; ++i) {
+        line += static_cast<char>(data->read_byte(0x100 + i));
+    }
+    EXPECT_EQ(line, "open the  door");
+    std::vector<std::pair<word_t, word_t>> table;
+    for (addr_t i = 0; i < 3; ++i) {
+        table.push_back({data->read_word(0x200 + i * 4), data->read_word(0x202 + i * 4)});
+    }
+    EXPECT_EQ(table, (std::vector<std::pair<word_t, word_t>>{{0, 4}, {5, 3}, {10, 4}}));
+
+    // Input longer than the buffer is truncated before tokenizing
+    accessor->push_word(0);
+    accessor->push_word(0);
+    accessor->push_word(0);
+    accessor->push_word(4);
+    accessor->push_word(0x200);
+    accessor->push_word(6);
+    accessor->push_word(0x100);
+    io.get_accessor()->read_line_tokenized();
+    EXPECT_EQ(accessor->pop_word(), 2);
+    EXPECT_EQ(accessor->pop_word(), 6);
+    EXPECT_EQ(data->read_word(0x204), 5);  // second token starts at offset 5
+    EXPECT_EQ(data->read_word(0x206), 1);  // and is cut to "l"
+}
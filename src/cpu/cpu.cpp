@@ -6,6 +6,9 @@
 #include "vmemunit.h"
 #include "alu.h"
 #include "context.h"
+#include "trace.h"
+#include "probes.h"
+#include <algorithm>
 
 namespace lvm {
 
@@ -19,27 +22,29 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
     // Calculated from ops.txt: BYTE=1, WORD=2, sum all arg sizes
 
 
-    Cpu::Cpu(std::shared_ptr<IVMemUnit> vmem_unit, addr32_t stack_capacity, addr32_t code_capacity)
+    Cpu::Cpu(std::shared_ptr<IVMemUnit> vmem_unit, addr32_t data_capacity)
         :   vmem_unit_(std::move(vmem_unit)),
-            flags(std::make_shared<Flags>()),
-            AX(std::make_shared<Register>(flags)),
-            BX(std::make_shared<Register>(flags)),
-            CX(std::make_shared<Register>(flags)),
-            DX(std::make_shared<Register>(flags)),
-            EX(std::make_shared<Register>(flags)),
-            alu_(std::make_unique<Alu>(AX))
+            flags(borrow_shared(flags_state_)),
+            ax_(flags), bx_(flags), cx_(flags), dx_(flags), ex_(flags),
+            AX(borrow_shared(ax_)),
+            BX(borrow_shared(bx_)),
+            CX(borrow_shared(cx_)),
+            DX(borrow_shared(dx_)),
+            EX(borrow_shared(ex_)),
+            operand_(flags),
+            alu_file_{Alu(borrow_shared(operand_)), Alu(AX), Alu(BX), Alu(CX), Alu(DX), Alu(EX)}
         {
             // Note: Stack and InstructionUnit are now created externally
             // and passed in via set_stack() and set_instruction_unit()
             // This is because they need to be created in the proper modes
             // and CPU should depend on interfaces, not concrete types
-            // ALU is created internally as it needs the AX register
-            
-            // Create code context
-            code_context_id_ = vmem_unit_->create_context(code_capacity);
+            // ALUs are created internally as they need the registers
+            // Code lives in the instruction unit's context; the CPU only owns data
             
             // Create data context (for general purpose memory)
-            data_context_id_ = vmem_unit_->create_context(65536); // 64KB data space
+            data_context_id_ = vmem_unit_->create_context(std::max(data_capacity, MIN_DATA_CAPACITY));
+
+            register_file_ = {nullptr, &ax_, &bx_, &cx_, &dx_, &ex_};
         }
 
         Cpu::~Cpu() {}
@@ -71,7 +76,15 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
         }
     }
 
-    void Cpu::load_program(const std::vector<byte_t>& program) {
+    void Cpu::fork_from(const Cpu& parent) {
+        flags_state_ = parent.flags_state_;
+        for (byte_t code = REG_AX; code <= REG_EX; ++code) {
+            register_file_[code]->set_value(parent.register_file_[code]->get_value());
+        }
+        halted = false;
+    }
+
+    void Cpu::load_program(std::span<const byte_t> program) {
         vmem_unit_->set_mode(IVMemUnit::Mode::PROTECTED);
         auto accessor = instruction_unit_->get_accessor(MemAccessMode::READ_WRITE);
         accessor->Load_Program(program);
@@ -82,17 +95,59 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
         vmem_unit_->set_mode(IVMemUnit::Mode::PROTECTED);
         while (!halted) {
             // a timer will be here to control processor frame rate
-            step();
+            checked_step();
         }
         vmem_unit_->set_mode(IVMemUnit::Mode::UNPROTECTED);
     }
 
+    Cpu::SliceResult Cpu::run_slice(uint64_t budget, uint64_t& executed) {
+        executed = 0;
+        vmem_unit_->set_mode(IVMemUnit::Mode::PROTECTED);
+        park_on_input_ = true;
+        blocked_ = false;
+        try {
+            while (!halted && executed < budget) {
+                checked_step();
+                if (blocked_) {
+                    break;
+                }
+                ++executed;
+            }
+        } catch (...) {
+            park_on_input_ = false;
+            vmem_unit_->set_mode(IVMemUnit::Mode::UNPROTECTED);
+            throw;
+        }
+        park_on_input_ = false;
+        vmem_unit_->set_mode(IVMemUnit::Mode::UNPROTECTED);
+        if (halted) {
+            return SliceResult::HALTED;
+        }
+        return blocked_ ? SliceResult::BLOCKED : SliceResult::PREEMPTED;
+    }
+
+    void Cpu::checked_step() {
+        try {
+            step();
+        } catch (const std::exception& e) {
+            LVM_PROBE2(fault, instruction_unit_->get_accessor(MemAccessMode::READ_ONLY)->get_IR(), e.what());
+            throw;
+        }
+        // Periodically hand zero and idle blocks back to the memory unit
+        if (++steps_since_reclaim_ == RECLAIM_INTERVAL) {
+            get_concrete_vmemunit(vmem_unit_).reclaim(VMemUnit::DEFAULT_COLD_SWEEPS, RECLAIM_BLOCK_BUDGET);
+            steps_since_reclaim_ = 0;
+        }
+    }
+
     void Cpu::step() {
         // for now just halt immediately
         auto accessor = instruction_unit_->get_accessor(MemAccessMode::READ_WRITE);
         byte_t opcode = static_cast<byte_t>(accessor->readByte_At_IR());
         accessor->advance_IR(1);
         if (opcode == OPCODE_HALT) { // HALT instruction
+            trace::instant("halt", "vm");
+            LVM_PROBE1(halt, 0);
             halted = true;
             return;
         }
@@ -133,6 +188,16 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
             execute_inc_dec_operation(opcode, params);
             return;
         }
+
+        if(opcode >= OPCODE_PUSHM_MASK && opcode <= OPCODE_POPA) {
+            execute_register_mask_operation(opcode, params);
+            return;
+        }
+
+        if(opcode >= OPCODE_LDX_REG_ADDR32_W && opcode <= OPCODE_STXL_PAIR_REG_B) {
+            execute_linear_operation(opcode, params);
+            return;
+        }
         
         // System call
         if(opcode == OPCODE_SYS_FUNC) {
@@ -150,56 +215,12 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
             return;
         }
 
-        if((opcode >= OPCODE_ADD_REG_W && opcode <= OPCODE_ADL_REG_B)) {
-            execute_add_operation(opcode, params);
+        // ALU and compare instructions dispatch through a flat handler table
+        if (OpHandler handler = alu_dispatch_table()[opcode]) {
+            (this->*handler)(params);
             return;
         }
 
-        if((opcode >= OPCODE_SUB_REG_W && opcode <= OPCODE_SBL_REG_B)) {
-            execute_sub_operation(opcode, params);
-            return;
-        }
-
-        if((opcode >= OPCODE_MUL_REG_W && opcode <= OPCODE_MLL_REG_B)) {
-            execute_mul_operation(opcode, params);
-            return;
-        }
-
-        if((opcode >= OPCODE_DIV_REG_W && opcode <= OPCODE_DVL_REG_B)) {
-            execute_div_operation(opcode, params);
-            return;
-        }
-
-        if((opcode >= OPCODE_REM_REG_W && opcode <= OPCODE_RML_REG_B)) {
-            execute_rem_operation(opcode, params);
-            return;
-        }
-
-        if((opcode >= OPCODE_AND_REG_W && opcode <= OPCODE_ANL_REG_B)) {
-            execute_and_operation(opcode, params);
-            return;
-        }
-
-        if((opcode >= OPCODE_OR_REG_W && opcode <= OPCODE_ORL_REG_B)) {
-            execute_or_operation(opcode, params);
-            return;
-        }
-        if((opcode >= OPCODE_XOR_REG_W && opcode <= OPCODE_XOL_REG_B)) {
-            execute_xor_operation(opcode, params);
-            return;
-        }
-        if((opcode >= OPCODE_SHL_REG_W && opcode <= OPCODE_SHRL_REG_B)) {
-            execute_shift_operation(opcode, params);
-            return;
-        }
-        if((opcode >= OPCODE_ROL_REG_W && opcode <= OPCODE_RORL_REG_B)) {
-            execute_rotate_operation(opcode, params);
-            return;
-        }
-        if((opcode >= OPCODE_CMP_REG_REG && opcode <= OPCODE_CPL_REG_IMM_B)) {
-            execute_cmp_operation(opcode, params);
-            return;
-        }
         // Advance instruction pointer by param count
         // now parse and execute the instructions based on opcode and params
         throw runtime_error("Unknown opcode encountered");
@@ -240,6 +261,7 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
                 throw runtime_error("Invalid jump opcode");
         
         }
+        LVM_PROBE1(block_entry, accessor->get_IR());
     }
 
     void Cpu::execute_subroutine_operation(byte_t opcode, const std::vector<byte_t>& params) {
@@ -250,11 +272,15 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
                 addr_t address = combine_bytes_to_address(params[1], params[0]);
                 // CALL instruction has 3 bytes: 2 for address, 1 for return value flag
                 bool return_value = (params.size() > 2) ? (params[2] != 0) : false;
+                LVM_PROBE2(call, accessor->get_IR(), address);
                 accessor->call_subroutine(address, return_value);
+                LVM_PROBE1(block_entry, accessor->get_IR());
                 break;
             }
             case OPCODE_RET: {
                 accessor->return_from_subroutine();
+                LVM_PROBE1(ret, accessor->get_IR());
+                LVM_PROBE1(block_entry, accessor->get_IR());
                 break;
             }
             default:
@@ -526,6 +552,8 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
                 // params[0-1]: page number (16-bit little-endian)
                 // params[2-3]: context id (16-bit little-endian) - currently ignored
                 page_t page = combine_bytes_to_word(params[1], params[0]);
+                trace::instant("page_switch", "vm", "page", page);
+                LVM_PROBE1(page_switch, page);
                 
                 auto data_ctx = vmem_unit_->get_context(data_context_id_);
                 auto data_accessor = data_ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
@@ -538,6 +566,8 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
                 // params[1-2]: context id (16-bit little-endian) - currently ignored
                 auto reg = get_register_by_code(params[0]);
                 page_t page = reg->get_value();
+                trace::instant("page_switch", "vm", "page", page);
+                LVM_PROBE1(page_switch, page);
                 
                 auto data_ctx = vmem_unit_->get_context(data_context_id_);
                 auto data_accessor = data_ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
@@ -568,6 +598,80 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
         }
     }
 
+    void Cpu::execute_register_mask_operation(byte_t opcode, const std::vector<byte_t>& params) {
+        // Bit n of the mask selects register code n+1; the words are laid out
+        // exactly as PUSH AX, PUSH BX, ... would leave them
+        constexpr byte_t ALL_REGISTERS = (1u << REG_EX) - 1;
+        bool push = opcode == OPCODE_PUSHM_MASK || opcode == OPCODE_PUSHA;
+        byte_t mask = (opcode == OPCODE_PUSHA || opcode == OPCODE_POPA) ? ALL_REGISTERS : params[0];
+        if (mask & ~ALL_REGISTERS) {
+            throw runtime_error("Invalid register mask");
+        }
+
+        std::array<Register*, REG_EX> registers;
+        std::array<word_t, REG_EX> values;
+        addr32_t count = 0;
+        for (byte_t code = REG_AX; code <= REG_EX; ++code) {
+            if (mask & (1u << (code - REG_AX))) {
+                registers[count++] = register_file_[code];
+            }
+        }
+
+        auto stack_access = stack_->get_accessor(MemAccessMode::READ_WRITE);
+        if (push) {
+            for (addr32_t i = 0; i < count; ++i) {
+                values[i] = registers[i]->get_value();
+            }
+            stack_access->push_words(values.data(), count);
+        } else {
+            stack_access->pop_words(values.data(), count);
+            for (addr32_t i = 0; i < count; ++i) {
+                registers[i]->set_value(values[i]);
+            }
+        }
+    }
+
+    void Cpu::execute_linear_operation(byte_t opcode, const std::vector<byte_t>& params) {
+        // Wide forms: register, then a little-endian 32-bit address (stores
+        // put the address first). Pair forms: the address is hi:lo from two
+        // registers, again before the data register for stores.
+        bool pair = opcode >= OPCODE_LDX_REG_PAIR_W;
+        bool store = opcode == OPCODE_STX_ADDR32_REG_W || opcode == OPCODE_STXL_ADDR32_REG_B ||
+                     opcode == OPCODE_STX_PAIR_REG_W || opcode == OPCODE_STXL_PAIR_REG_B;
+        bool word = opcode == OPCODE_LDX_REG_ADDR32_W || opcode == OPCODE_STX_ADDR32_REG_W ||
+                    opcode == OPCODE_LDX_REG_PAIR_W || opcode == OPCODE_STX_PAIR_REG_W;
+
+        size_t address_at = store ? 0 : 1;
+        addr32_t address;
+        if (pair) {
+            address = (static_cast<addr32_t>(register_by_code(params[address_at]).get_value()) << 16) |
+                      register_by_code(params[address_at + 1]).get_value();
+        } else {
+            address = static_cast<addr32_t>(params[address_at]) |
+                      (static_cast<addr32_t>(params[address_at + 1]) << 8) |
+                      (static_cast<addr32_t>(params[address_at + 2]) << 16) |
+                      (static_cast<addr32_t>(params[address_at + 3]) << 24);
+        }
+        Register& reg = register_by_code(params[store ? (pair ? 2 : 4) : 0]);
+
+        auto data_accessor = vmem_unit_->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_WRITE);
+        byte_t bytes[2];
+        uint32_t size = word ? 2 : 1;
+        if (store) {
+            word_t value = reg.get_value();
+            bytes[0] = static_cast<byte_t>(value & 0xFF);
+            bytes[1] = static_cast<byte_t>(value >> 8);
+            data_accessor->write_linear(address, bytes, size);
+        } else {
+            data_accessor->read_linear(address, bytes, size);
+            if (word) {
+                reg.set_value(combine_bytes_to_word(bytes[1], bytes[0]));
+            } else {
+                reg.set_low_byte(bytes[0]);
+            }
+        }
+    }
+
     void Cpu::execute_system_operation(byte_t opcode, const std::vector<byte_t>& params) {
         auto accessor = instruction_unit_->get_accessor(MemAccessMode::READ_WRITE);
         switch(opcode) {
@@ -575,6 +679,13 @@ inline VMemUnit& get_concrete_vmemunit(std::shared_ptr<IVMemUnit>& interface) {
                 {
                     // params are in little-endian order: low byte first, high byte second
                     word_t syscall_number = combine_bytes_to_word(params[1], params[0]);
+                    if (park_on_input_ && accessor->syscall_would_block(syscall_number)) {
+                        // Rewind onto the SYS so the scheduler can run the
+                        // program again once input arrives
+                        accessor->set_IR(static_cast<word_t>(accessor->get_IR() - 1 - params.size()));
+                        blocked_ = true;
+                        break;
+                    }
                     accessor->system_call(syscall_number);  
                     break;
                 }
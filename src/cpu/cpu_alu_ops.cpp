@@ -3,481 +3,287 @@
 #include "helpers.h"
 using namespace lvm;
 
-void Cpu::execute_add_operation(byte_t opcode, const std::vector<byte_t>& params) {
-        switch(opcode) {
-            case OPCODE_ADD_REG_W:
-                {
-                    auto reg = get_register_by_code(params[0]);
-                    alu_->add(reg->get_value());
-                }
-                break;
-            case OPCODE_ADD_IMM_W:
-                {
-                    word_t value = combine_bytes_to_word(params[0], params[1]);
-                    alu_->add(value);
-                }
-                break;
-            case OPCODE_ADB_IMM_B:
-                {
-                    alu_->add_byte(params[0]);
-                }
-                break;
-            case OPCODE_ADH_REG_B:
-                {
-                    auto reg = get_register_by_code(params[0]);
-                    alu_->add_byte(reg->get_high_byte());
-                }
-                break;
-            case OPCODE_ADL_REG_B:
-                {
-                    auto reg = get_register_by_code(params[0]);
-                    alu_->add_byte(reg->get_low_byte());
-                }
-                break;
-            default:
-                throw lvm::runtime_error("Invalid add opcode");
-        }
-    }
+// ALU and compare instructions are generated from templates parameterised on
+// operand form (immediate word/byte, register word/high/low). Every opcode maps
+// to its own fully specialised handler, so nothing branches on the form at
+// runtime; the opcode -> handler mapping is built once from opcodes.h.
 
-void Cpu::execute_sub_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_SUB_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->sub(value);
-            }
-            break;
-        case OPCODE_SUB_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->sub(reg->get_value());
-            }
-            break;
-        case OPCODE_SBB_IMM_B:
-            {
-                alu_->sub_byte(params[0]);
-            }
-            break;
-        case OPCODE_SBH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->sub_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_SBL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->sub_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid sub opcode");
+Register& Cpu::register_by_code(byte_t code) {
+    if (code >= register_file_.size() || register_file_[code] == nullptr) {
+        throw std::runtime_error("Invalid register code: " + std::to_string(code));
     }
+    return *register_file_[code];
 }
 
-void Cpu::execute_mul_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_MUL_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->mul(value);
-            }
-            break;
-        case OPCODE_MUL_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->mul(reg->get_value());
-            }
-            break;
-        case OPCODE_MLB_IMM_B:
-            {
-                alu_->mul_byte(params[0]);
-            }
-            break;
-        case OPCODE_MLH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->mul_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_MLL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->mul_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid mul opcode");
+Alu& Cpu::alu_by_code(byte_t code) {
+    if (code == 0 || code >= alu_file_.size()) {
+        throw std::runtime_error("Invalid register code: " + std::to_string(code));
     }
+    return alu_file_[code];
 }
 
-void Cpu::execute_div_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_DIV_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->div(value);
-            }
-            break;
-        case OPCODE_DIV_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->div(reg->get_value());
-            }
-            break;
-        case OPCODE_DVB_IMM_B:
-            {
-                alu_->div_byte(params[0]);
-            }
-            break;
-        case OPCODE_DVH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->div_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_DVL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->div_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid div opcode");
+template <Cpu::OperandForm Form, size_t Index>
+auto Cpu::read_operand(const std::vector<byte_t>& params) {
+    if constexpr (Form == OperandForm::IMM_W) {
+        return combine_bytes_to_word(params[Index], params[Index + 1]);
+    } else if constexpr (Form == OperandForm::IMM_B) {
+        return params[Index];
+    } else if constexpr (Form == OperandForm::REG_W) {
+        return register_by_code(params[Index]).get_value();
+    } else if constexpr (Form == OperandForm::REG_H) {
+        return register_by_code(params[Index]).get_high_byte();
+    } else if constexpr (Form == OperandForm::REG_L) {
+        return register_by_code(params[Index]).get_low_byte();
+    } else {
+        return read_data_word(combine_bytes_to_address(params[Index], params[Index + 1]));
     }
 }
 
-void Cpu::execute_rem_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_REM_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->rem(value);
-            }
-            break;
-        case OPCODE_REM_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rem(reg->get_value());
-            }
-            break;
-        case OPCODE_RMB_IMM_B:
-            {
-                alu_->rem_byte(params[0]);
-            }
-            break;
-        case OPCODE_RMH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rem_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_RML_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rem_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid rem opcode");
-    }
+// Memory operands use the same address decoding and page selection as
+// LDA/STA, so ADD [x], 5 leaves memory and flags exactly as LDA + ADD + STA
+// would, minus the AX round trip
+word_t Cpu::read_data_word(addr32_t address) {
+    auto data_accessor = vmem_unit_->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    data_accessor->set_page(address >> 16);
+    byte_t bytes[2];
+    data_accessor->read_span(address & 0xFFFF, bytes, 2);
+    return combine_bytes_to_word(bytes[1], bytes[0]);
 }
 
-void Cpu::execute_and_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_AND_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->bit_and(value);
-            }
-            break;
-        case OPCODE_AND_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_and(reg->get_value());
-            }
-            break;
-        case OPCODE_ANB_IMM_B:
-            {
-                alu_->bit_and_byte(params[0]);
-            }
-            break;
-        case OPCODE_ANH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_and_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_ANL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_and_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid and opcode");
+template <typename Op>
+void Cpu::update_data_word(addr32_t address, Op op) {
+    auto data_accessor = vmem_unit_->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    data_accessor->set_page(address >> 16);
+    addr_t offset = address & 0xFFFF;
+    if (byte_t* bytes = data_accessor->write_span(offset, 2)) {
+        word_t value = op(combine_bytes_to_word(bytes[1], bytes[0]));
+        bytes[0] = static_cast<byte_t>(value & 0xFF);
+        bytes[1] = static_cast<byte_t>(value >> 8);
+    } else {
+        // Word straddles two blocks
+        data_accessor->write_word(offset, op(data_accessor->read_word(offset)));
     }
 }
 
-void Cpu::execute_or_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_OR_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->bit_or(value);
-            }
-            break;
-        case OPCODE_OR_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_or(reg->get_value());
-            }
-            break;
-        case OPCODE_ORB_IMM_B:
-            {
-                alu_->bit_or_byte(params[0]);
-            }
-            break;
-        case OPCODE_ORH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_or_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_ORL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_or_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid or opcode");
-    }
+template <auto AluOp, Cpu::OperandForm Form>
+void Cpu::execute_alu(const std::vector<byte_t>& params) {
+    (alu_file_[REG_AX].*AluOp)(read_operand<Form, 0>(params));
 }
 
-void Cpu::execute_xor_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_XOR_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->bit_xor(value);
-            }
-            break;
-        case OPCODE_XOR_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_xor(reg->get_value());
-            }
-            break;
-        case OPCODE_XOB_IMM_B:
-            {
-                alu_->bit_xor_byte(params[0]);
-            }
-            break;
-        case OPCODE_XOH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_xor_byte(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_XOL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->bit_xor_byte(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid xor opcode");
-    }
+// The source is read before the destination is written, so ADD BX, BX doubles
+// BX just as ADD AX, AX doubles AX
+template <auto AluOp, Cpu::OperandForm Form>
+void Cpu::execute_alu_to_register(const std::vector<byte_t>& params) {
+    auto value = read_operand<Form, 1>(params);
+    (alu_by_code(params[0]).*AluOp)(value);
 }
 
-void Cpu::execute_shift_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_SHL_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->shl(value);
-            }
-            break;
-        case OPCODE_SHL_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shl(reg->get_value());
-            }
-            break;
-        case OPCODE_SLB_IMM_B:
-            {
-                alu_->shl(params[0]);
-            }
-            break;
-        case OPCODE_SLH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shl(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_SLL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shl(reg->get_low_byte());
-            }
-            break;
-        case OPCODE_SHR_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->shr(value);
-            }
-            break;
-        case OPCODE_SHR_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shr(reg->get_value());
-            }
-            break;
-        case OPCODE_SHRB_IMM_B:
-            {
-                alu_->shr(params[0]);
-            }
-            break;
-        case OPCODE_SHRH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shr(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_SHRL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->shr(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid shift opcode");
-    }
+template <auto CmpOp, Cpu::OperandForm Lhs, Cpu::OperandForm Rhs>
+void Cpu::execute_cmp(const std::vector<byte_t>& params) {
+    // Left operand is copied into AX first; the right operand is read
+    // afterwards so comparing against AX sees the copied value
+    AX->set_value(read_operand<Lhs, 0>(params));
+    (alu_file_[REG_AX].*CmpOp)(read_operand<Rhs, 1>(params));
 }
 
-void Cpu::execute_rotate_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_ROL_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->rol(value);
-            }
-            break;
-        case OPCODE_ROL_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rol(reg->get_value());
-            }
-            break;
-        case OPCODE_ROLB_IMM_B:
-            {
-                alu_->rol(params[0]);
-            }
-            break;
-        case OPCODE_ROLH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rol(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_ROLL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->rol(reg->get_low_byte());
-            }
-            break;
-        case OPCODE_ROR_IMM_W:
-            {
-                word_t value = combine_bytes_to_word(params[0], params[1]);
-                alu_->ror(value);
-            }
-            break;
-        case OPCODE_ROR_REG_W:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->ror(reg->get_value());
-            }
-            break;
-        case OPCODE_RORB_IMM_B:
-            {
-                alu_->ror(params[0]);
-            }
-            break;
-        case OPCODE_RORH_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->ror(reg->get_high_byte());
-            }
-            break;
-        case OPCODE_RORL_REG_B:
-            {
-                auto reg = get_register_by_code(params[0]);
-                alu_->ror(reg->get_low_byte());
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid rotate opcode");
-    }
+template <auto AluOp>
+void Cpu::execute_alu_to_memory(const std::vector<byte_t>& params) {
+    word_t value = read_operand<OperandForm::IMM_W, 2>(params);
+    update_data_word(combine_bytes_to_address(params[0], params[1]), [&](word_t old) {
+        operand_.set_value(old);
+        (alu_file_[0].*AluOp)(value);
+        return operand_.get_value();
+    });
+}
+
+template <auto StepOp>
+void Cpu::execute_step_memory(const std::vector<byte_t>& params) {
+    update_data_word(combine_bytes_to_address(params[0], params[1]), [&](word_t old) {
+        operand_.set_value(old);
+        (operand_.*StepOp)();
+        return operand_.get_value();
+    });
+}
+
+void Cpu::execute_store_immediate(const std::vector<byte_t>& params) {
+    word_t value = read_operand<OperandForm::IMM_W, 2>(params);
+    update_data_word(combine_bytes_to_address(params[0], params[1]), [value](word_t) { return value; });
 }
 
-// comparisons
-
-void Cpu::execute_cmp_operation(byte_t opcode, const std::vector<byte_t>& params) {
-    switch(opcode) {
-        case OPCODE_CMP_REG_REG:
-            {
-                // Compare two registers (full word)
-                auto reg1 = get_register_by_code(params[0]);
-                auto reg2 = get_register_by_code(params[1]);
-                AX->set_value(reg1->get_value());
-                alu_->cmp(reg2->get_value());
-            }
-            break;
-        case OPCODE_CMP_REG_IMM_W:
-            {
-                // Compare register with immediate word
-                auto reg = get_register_by_code(params[0]);
-                AX->set_value(reg->get_value());
-                alu_->cmp(combine_bytes_to_word(params[1], params[2]));
-            }
-            break;
-        case OPCODE_CPH_REG_REG:
-            {
-                // Compare high bytes of two registers
-                auto reg1 = get_register_by_code(params[0]);
-                auto reg2 = get_register_by_code(params[1]);
-                AX->set_value(reg1->get_high_byte());
-                alu_->cmp_byte(reg2->get_high_byte());
-            }
-            break;
-        case OPCODE_CPH_REG_IMM_B:
-            {
-                // Compare high byte of register with immediate byte
-                auto reg = get_register_by_code(params[0]);
-                AX->set_value(reg->get_high_byte());
-                alu_->cmp_byte(params[1]);
-            }
-            break;
-        case OPCODE_CPL_REG_REG:
-            {
-                // Compare low bytes of two registers
-                auto reg1 = get_register_by_code(params[0]);
-                auto reg2 = get_register_by_code(params[1]);
-                AX->set_value(reg1->get_low_byte());
-                alu_->cmp_byte(reg2->get_low_byte());
-            }
-            break;
-        case OPCODE_CPL_REG_IMM_B:
-            {
-                // Compare low byte of register with immediate byte
-                auto reg = get_register_by_code(params[0]);
-                AX->set_value(reg->get_low_byte());
-                alu_->cmp_byte(params[1]);
-            }
-            break;
-        default:
-            throw lvm::runtime_error("Invalid cmp opcode");
+namespace {
+    // Operand layouts must agree with opcodes.h, which stays the single source
+    // of truth for encodings; a mismatch fails the table build at compile time
+    constexpr void check_operand_layout(byte_t opcode, int bytes) {
+        if (get_additional_bytes(opcode) != bytes) {
+            throw "ALU handler operand layout disagrees with opcodes.h";
+        }
     }
 }
 
+constexpr int Cpu::operand_bytes(OperandForm form) {
+    return form == OperandForm::IMM_W || form == OperandForm::MEM_W ? 2 : 1;
+}
+
+template <auto AluOp, Cpu::OperandForm Form>
+constexpr void Cpu::bind_alu(std::array<OpHandler, 256>& table, byte_t opcode) {
+    check_operand_layout(opcode, operand_bytes(Form));
+    table[opcode] = &Cpu::execute_alu<AluOp, Form>;
+}
+
+template <auto CmpOp, Cpu::OperandForm Lhs, Cpu::OperandForm Rhs>
+constexpr void Cpu::bind_cmp(std::array<OpHandler, 256>& table, byte_t opcode) {
+    check_operand_layout(opcode, operand_bytes(Lhs) + operand_bytes(Rhs));
+    table[opcode] = &Cpu::execute_cmp<CmpOp, Lhs, Rhs>;
+}
+
+template <auto AluOp>
+constexpr void Cpu::bind_alu_to_register(std::array<OpHandler, 256>& table, byte_t opcode) {
+    // Register form at the even opcode, immediate form right after it
+    check_operand_layout(opcode, 1 + operand_bytes(OperandForm::REG_W));
+    check_operand_layout(opcode + 1, 1 + operand_bytes(OperandForm::IMM_W));
+    table[opcode] = &Cpu::execute_alu_to_register<AluOp, OperandForm::REG_W>;
+    table[opcode + 1] = &Cpu::execute_alu_to_register<AluOp, OperandForm::IMM_W>;
+}
+
+template <auto AluOp>
+constexpr void Cpu::bind_alu_to_memory(std::array<OpHandler, 256>& table, byte_t opcode) {
+    check_operand_layout(opcode, operand_bytes(OperandForm::MEM_W) + operand_bytes(OperandForm::IMM_W));
+    table[opcode] = &Cpu::execute_alu_to_memory<AluOp>;
+}
+
+constexpr void Cpu::bind(std::array<OpHandler, 256>& table, byte_t opcode, int bytes, OpHandler handler) {
+    check_operand_layout(opcode, bytes);
+    table[opcode] = handler;
+}
+
+const std::array<Cpu::OpHandler, 256>& Cpu::alu_dispatch_table() {
+    using F = OperandForm;
+    static constexpr std::array<OpHandler, 256> table = [] {
+        std::array<OpHandler, 256> t{};
+
+        // Addition
+        bind_alu<&Alu::add, F::IMM_W>(t, OPCODE_ADD_IMM_W);
+        bind_alu<&Alu::add, F::REG_W>(t, OPCODE_ADD_REG_W);
+        bind_alu<&Alu::add_byte, F::IMM_B>(t, OPCODE_ADB_IMM_B);
+        bind_alu<&Alu::add_byte, F::REG_H>(t, OPCODE_ADH_REG_B);
+        bind_alu<&Alu::add_byte, F::REG_L>(t, OPCODE_ADL_REG_B);
+
+        // Subtraction
+        bind_alu<&Alu::sub, F::IMM_W>(t, OPCODE_SUB_IMM_W);
+        bind_alu<&Alu::sub, F::REG_W>(t, OPCODE_SUB_REG_W);
+        bind_alu<&Alu::sub_byte, F::IMM_B>(t, OPCODE_SBB_IMM_B);
+        bind_alu<&Alu::sub_byte, F::REG_H>(t, OPCODE_SBH_REG_B);
+        bind_alu<&Alu::sub_byte, F::REG_L>(t, OPCODE_SBL_REG_B);
+
+        // Multiplication
+        bind_alu<&Alu::mul, F::IMM_W>(t, OPCODE_MUL_IMM_W);
+        bind_alu<&Alu::mul, F::REG_W>(t, OPCODE_MUL_REG_W);
+        bind_alu<&Alu::mul_byte, F::IMM_B>(t, OPCODE_MLB_IMM_B);
+        bind_alu<&Alu::mul_byte, F::REG_H>(t, OPCODE_MLH_REG_B);
+        bind_alu<&Alu::mul_byte, F::REG_L>(t, OPCODE_MLL_REG_B);
+
+        // Division
+        bind_alu<&Alu::div, F::IMM_W>(t, OPCODE_DIV_IMM_W);
+        bind_alu<&Alu::div, F::REG_W>(t, OPCODE_DIV_REG_W);
+        bind_alu<&Alu::div_byte, F::IMM_B>(t, OPCODE_DVB_IMM_B);
+        bind_alu<&Alu::div_byte, F::REG_H>(t, OPCODE_DVH_REG_B);
+        bind_alu<&Alu::div_byte, F::REG_L>(t, OPCODE_DVL_REG_B);
+
+        // Remainder
+        bind_alu<&Alu::rem, F::IMM_W>(t, OPCODE_REM_IMM_W);
+        bind_alu<&Alu::rem, F::REG_W>(t, OPCODE_REM_REG_W);
+        bind_alu<&Alu::rem_byte, F::IMM_B>(t, OPCODE_RMB_IMM_B);
+        bind_alu<&Alu::rem_byte, F::REG_H>(t, OPCODE_RMH_REG_B);
+        bind_alu<&Alu::rem_byte, F::REG_L>(t, OPCODE_RML_REG_B);
+
+        // Bitwise AND
+        bind_alu<&Alu::bit_and, F::IMM_W>(t, OPCODE_AND_IMM_W);
+        bind_alu<&Alu::bit_and, F::REG_W>(t, OPCODE_AND_REG_W);
+        bind_alu<&Alu::bit_and_byte, F::IMM_B>(t, OPCODE_ANB_IMM_B);
+        bind_alu<&Alu::bit_and_byte, F::REG_H>(t, OPCODE_ANH_REG_B);
+        bind_alu<&Alu::bit_and_byte, F::REG_L>(t, OPCODE_ANL_REG_B);
+
+        // Bitwise OR
+        bind_alu<&Alu::bit_or, F::IMM_W>(t, OPCODE_OR_IMM_W);
+        bind_alu<&Alu::bit_or, F::REG_W>(t, OPCODE_OR_REG_W);
+        bind_alu<&Alu::bit_or_byte, F::IMM_B>(t, OPCODE_ORB_IMM_B);
+        bind_alu<&Alu::bit_or_byte, F::REG_H>(t, OPCODE_ORH_REG_B);
+        bind_alu<&Alu::bit_or_byte, F::REG_L>(t, OPCODE_ORL_REG_B);
+
+        // Bitwise XOR
+        bind_alu<&Alu::bit_xor, F::IMM_W>(t, OPCODE_XOR_IMM_W);
+        bind_alu<&Alu::bit_xor, F::REG_W>(t, OPCODE_XOR_REG_W);
+        bind_alu<&Alu::bit_xor_byte, F::IMM_B>(t, OPCODE_XOB_IMM_B);
+        bind_alu<&Alu::bit_xor_byte, F::REG_H>(t, OPCODE_XOH_REG_B);
+        bind_alu<&Alu::bit_xor_byte, F::REG_L>(t, OPCODE_XOL_REG_B);
+
+        // Shifts (byte forms widen the count, the shift itself is 16-bit)
+        bind_alu<&Alu::shl, F::IMM_W>(t, OPCODE_SHL_IMM_W);
+        bind_alu<&Alu::shl, F::REG_W>(t, OPCODE_SHL_REG_W);
+        bind_alu<&Alu::shl, F::IMM_B>(t, OPCODE_SLB_IMM_B);
+        bind_alu<&Alu::shl, F::REG_H>(t, OPCODE_SLH_REG_B);
+        bind_alu<&Alu::shl, F::REG_L>(t, OPCODE_SLL_REG_B);
+        bind_alu<&Alu::shr, F::IMM_W>(t, OPCODE_SHR_IMM_W);
+        bind_alu<&Alu::shr, F::REG_W>(t, OPCODE_SHR_REG_W);
+        bind_alu<&Alu::shr, F::IMM_B>(t, OPCODE_SHRB_IMM_B);
+        bind_alu<&Alu::shr, F::REG_H>(t, OPCODE_SHRH_REG_B);
+        bind_alu<&Alu::shr, F::REG_L>(t, OPCODE_SHRL_REG_B);
+
+        // Rotates
+        bind_alu<&Alu::rol, F::IMM_W>(t, OPCODE_ROL_IMM_W);
+        bind_alu<&Alu::rol, F::REG_W>(t, OPCODE_ROL_REG_W);
+        bind_alu<&Alu::rol, F::IMM_B>(t, OPCODE_ROLB_IMM_B);
+        bind_alu<&Alu::rol, F::REG_H>(t, OPCODE_ROLH_REG_B);
+        bind_alu<&Alu::rol, F::REG_L>(t, OPCODE_ROLL_REG_B);
+        bind_alu<&Alu::ror, F::IMM_W>(t, OPCODE_ROR_IMM_W);
+        bind_alu<&Alu::ror, F::REG_W>(t, OPCODE_ROR_REG_W);
+        bind_alu<&Alu::ror, F::IMM_B>(t, OPCODE_RORB_IMM_B);
+        bind_alu<&Alu::ror, F::REG_H>(t, OPCODE_RORH_REG_B);
+        bind_alu<&Alu::ror, F::REG_L>(t, OPCODE_RORL_REG_B);
+
+        // Comparisons (left operand is a register, right a register or immediate)
+        bind_cmp<&Alu::cmp, F::REG_W, F::REG_W>(t, OPCODE_CMP_REG_REG);
+        bind_cmp<&Alu::cmp, F::REG_W, F::IMM_W>(t, OPCODE_CMP_REG_IMM_W);
+        bind_cmp<&Alu::cmp_byte, F::REG_H, F::REG_H>(t, OPCODE_CPH_REG_REG);
+        bind_cmp<&Alu::cmp_byte, F::REG_H, F::IMM_B>(t, OPCODE_CPH_REG_IMM_B);
+        bind_cmp<&Alu::cmp_byte, F::REG_L, F::REG_L>(t, OPCODE_CPL_REG_REG);
+        bind_cmp<&Alu::cmp_byte, F::REG_L, F::IMM_B>(t, OPCODE_CPL_REG_IMM_B);
+
+        // Extended: AX op [addr]
+        bind_alu<&Alu::add, F::MEM_W>(t, OPCODE_ADD_MEM_W);
+        bind_alu<&Alu::sub, F::MEM_W>(t, OPCODE_SUB_MEM_W);
+        bind_alu<&Alu::mul, F::MEM_W>(t, OPCODE_MUL_MEM_W);
+        bind_alu<&Alu::div, F::MEM_W>(t, OPCODE_DIV_MEM_W);
+        bind_alu<&Alu::rem, F::MEM_W>(t, OPCODE_REM_MEM_W);
+        bind_alu<&Alu::bit_and, F::MEM_W>(t, OPCODE_AND_MEM_W);
+        bind_alu<&Alu::bit_or, F::MEM_W>(t, OPCODE_OR_MEM_W);
+        bind_alu<&Alu::bit_xor, F::MEM_W>(t, OPCODE_XOR_MEM_W);
+
+        // Extended: [addr] op immediate, INC/DEC [addr], STA [addr], immediate
+        bind_alu_to_memory<&Alu::add>(t, OPCODE_ADD_ADDR_IMM_W);
+        bind_alu_to_memory<&Alu::sub>(t, OPCODE_SUB_ADDR_IMM_W);
+        bind_alu_to_memory<&Alu::bit_and>(t, OPCODE_AND_ADDR_IMM_W);
+        bind_alu_to_memory<&Alu::bit_or>(t, OPCODE_OR_ADDR_IMM_W);
+        bind_alu_to_memory<&Alu::bit_xor>(t, OPCODE_XOR_ADDR_IMM_W);
+        bind(t, OPCODE_INC_ADDR, 2, &Cpu::execute_step_memory<&Register::inc>);
+        bind(t, OPCODE_DEC_ADDR, 2, &Cpu::execute_step_memory<&Register::dec>);
+        bind(t, OPCODE_STA_ADDR_IMM_W, 4, &Cpu::execute_store_immediate);
+
+        // Extended: any register op register/immediate
+        bind_alu_to_register<&Alu::add>(t, OPCODE_ADD_REG_REG_W);
+        bind_alu_to_register<&Alu::sub>(t, OPCODE_SUB_REG_REG_W);
+        bind_alu_to_register<&Alu::mul>(t, OPCODE_MUL_REG_REG_W);
+        bind_alu_to_register<&Alu::div>(t, OPCODE_DIV_REG_REG_W);
+        bind_alu_to_register<&Alu::rem>(t, OPCODE_REM_REG_REG_W);
+        bind_alu_to_register<&Alu::bit_and>(t, OPCODE_AND_REG_REG_W);
+        bind_alu_to_register<&Alu::bit_or>(t, OPCODE_OR_REG_REG_W);
+        bind_alu_to_register<&Alu::bit_xor>(t, OPCODE_XOR_REG_REG_W);
+        bind_alu_to_register<&Alu::shl>(t, OPCODE_SHL_REG_REG_W);
+        bind_alu_to_register<&Alu::shr>(t, OPCODE_SHR_REG_REG_W);
+        bind_alu_to_register<&Alu::rol>(t, OPCODE_ROL_REG_REG_W);
+        bind_alu_to_register<&Alu::ror>(t, OPCODE_ROR_REG_REG_W);
+
+        return t;
+    }();
+    return table;
+}
@@ -10,6 +10,8 @@
 #include "alu.h"
 #include "vaddr.h"
 #include "basic_io.h"
+#include <array>
+#include <span>
 #include <memory>
 
 namespace lvm {
@@ -25,9 +27,16 @@ namespace lvm {
     };
     class Cpu{
     public:
-        Cpu(std::shared_ptr<IVMemUnit> vmem_unit, addr32_t stack_capacity, addr32_t code_capacity);
+        // The data context covers at least page 0 in full; a larger capacity
+        // extends it for linear addressing (LDX/STX). Stack and code contexts
+        // belong to the Stack and InstructionUnit passed in below.
+        explicit Cpu(std::shared_ptr<IVMemUnit> vmem_unit, addr32_t data_capacity = MIN_DATA_CAPACITY);
         ~Cpu();
         
+        // Registers hold pointers to flags_state_, so a Cpu stays where it was built
+        Cpu(const Cpu&) = delete;
+        Cpu& operator=(const Cpu&) = delete;
+        
         // Dependency injection for subsystems
         void set_stack(std::shared_ptr<IStack> stack);
         void set_instruction_unit(std::shared_ptr<IInstructionUnit> instruction_unit);
@@ -39,46 +48,117 @@ namespace lvm {
         context_id_t get_data_context_id() const { return data_context_id_; }
         
         void initialize();
-        void load_program(const std::vector<byte_t>& program);
+        void load_program(std::span<const byte_t> program);
         void run();
+
+        // Outcome of a bounded run: the program finished, the budget ran
+        // out, or the program reached an input system call with no input
+        // ready. A blocked program is left on the SYS instruction, so the
+        // next slice retries it.
+        enum class SliceResult { HALTED, PREEMPTED, BLOCKED };
+        // Execute at most budget instructions; executed receives the count
+        SliceResult run_slice(uint64_t budget, uint64_t& executed);
+        bool is_halted() const { return halted; }
+        // Stop after the current instruction (guest EXIT)
+        void halt() { halted = true; }
+        // Take over registers and flags of a forked parent
+        void fork_from(const Cpu& parent);
+
+        static constexpr addr32_t MIN_DATA_CAPACITY = 65536;
     private:
         std::shared_ptr<IVMemUnit> vmem_unit_;
         std::shared_ptr<IStack> stack_;
         std::shared_ptr<IInstructionUnit> instruction_unit_;
-        context_id_t code_context_id_;
         context_id_t data_context_id_;
         bool halted = false;
+
+        // Set while a slice runs; an input syscall that would wait sets
+        // blocked_ instead of executing
+        bool park_on_input_ = false;
+        bool blocked_ = false;
+
+        // Instructions executed between memory reclaim steps, and the blocks
+        // each step may visit
+        static constexpr uint32_t RECLAIM_INTERVAL = 65536;
+        static constexpr size_t RECLAIM_BLOCK_BUDGET = 64;
+        uint32_t steps_since_reclaim_ = 0;
+        void checked_step();
         
-        // Flags must be declared before registers since registers depend on it
+        // Flags must be declared before registers since registers depend on it.
+        // Flags, registers and ALU live inside the Cpu; the shared_ptrs below
+        // are non-owning views kept for the interfaces that take them
+        Flags flags_state_;
         std::shared_ptr<Flags> flags;
         
         void step();
-        // Additional CPU state (registers, flags, etc.) would go here
         // General purpose registers
+        Register ax_;
+        Register bx_;
+        Register cx_;
+        Register dx_;
+        Register ex_;
         std::shared_ptr<Register> AX;
         std::shared_ptr<Register> BX;
         std::shared_ptr<Register> CX;
         std::shared_ptr<Register> DX;
         std::shared_ptr<Register> EX;
 
-        std::unique_ptr<Alu> alu_;
+        // Scratch register for instructions that operate on a data word in
+        // place; shares the flags with the general registers
+        Register operand_;
+
+        // One ALU per register code, so any register can be a destination;
+        // slot 0 works on the scratch register
+        std::array<Alu, REG_EX + 1> alu_file_;
 
 
         std::shared_ptr<Register> get_register_by_code(byte_t code);
         void execute_jump(byte_t opcode, addr_t address);
-        void execute_add_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_sub_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_mul_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_div_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_rem_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_and_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_or_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_xor_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_shift_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_rotate_operation(byte_t opcode, const std::vector<byte_t>& params);
-        void execute_cmp_operation(byte_t opcode, const std::vector<byte_t>& params);
+
+        // ALU/compare handlers are stamped out from templates, one fully
+        // specialised function per opcode (see cpu_alu_ops.cpp)
+        enum class OperandForm { IMM_W, IMM_B, REG_W, REG_H, REG_L, MEM_W };
+        using OpHandler = void (Cpu::*)(const std::vector<byte_t>& params);
+
+        // Flat register file indexed by register code (index 0 unused)
+        std::array<Register*, REG_EX + 1> register_file_;
+        Register& register_by_code(byte_t code);
+        Alu& alu_by_code(byte_t code);
+
+        template <OperandForm Form, size_t Index>
+        auto read_operand(const std::vector<byte_t>& params);
+        template <auto AluOp, OperandForm Form>
+        void execute_alu(const std::vector<byte_t>& params);
+        template <auto CmpOp, OperandForm Lhs, OperandForm Rhs>
+        void execute_cmp(const std::vector<byte_t>& params);
+        template <auto AluOp, OperandForm Form>
+        void execute_alu_to_register(const std::vector<byte_t>& params);
+        template <auto AluOp>
+        void execute_alu_to_memory(const std::vector<byte_t>& params);
+        template <auto StepOp>
+        void execute_step_memory(const std::vector<byte_t>& params);
+        void execute_store_immediate(const std::vector<byte_t>& params);
+        static constexpr int operand_bytes(OperandForm form);
+        template <auto AluOp, OperandForm Form>
+        static constexpr void bind_alu(std::array<OpHandler, 256>& table, byte_t opcode);
+        template <auto CmpOp, OperandForm Lhs, OperandForm Rhs>
+        static constexpr void bind_cmp(std::array<OpHandler, 256>& table, byte_t opcode);
+        template <auto AluOp>
+        static constexpr void bind_alu_to_register(std::array<OpHandler, 256>& table, byte_t opcode);
+        template <auto AluOp>
+        static constexpr void bind_alu_to_memory(std::array<OpHandler, 256>& table, byte_t opcode);
+        static constexpr void bind(std::array<OpHandler, 256>& table, byte_t opcode, int bytes, OpHandler handler);
+        static const std::array<OpHandler, 256>& alu_dispatch_table();
+
+        // Data memory words for memory-operand instructions, translated once
+        word_t read_data_word(addr32_t address);
+        template <typename Op>
+        void update_data_word(addr32_t address, Op op);
+
         void execute_memory_operation(byte_t opcode, const std::vector<byte_t>& params);
         void execute_inc_dec_operation(byte_t opcode, const std::vector<byte_t>& params);
+        void execute_register_mask_operation(byte_t opcode, const std::vector<byte_t>& params);
+        void execute_linear_operation(byte_t opcode, const std::vector<byte_t>& params);
         void execute_subroutine_operation(byte_t opcode, const std::vector<byte_t>& params);
         void execute_system_operation(byte_t opcode, const std::vector<byte_t>& params);
     };  
@@ -1,8 +1,16 @@
 #pragma once
 
 #include "memsize.h"
+#include <memory>
 
 namespace lvm {
     addr_t combine_bytes_to_address(byte_t high, byte_t low); 
     word_t combine_bytes_to_word(byte_t high, byte_t low) ;
-}
\ No newline at end of file
+
+    // Non-owning shared_ptr to an object whose lifetime is managed by its
+    // enclosing instance; costs no allocation and no reference count
+    template <typename T>
+    std::shared_ptr<T> borrow_shared(T& object) {
+        return std::shared_ptr<T>(std::shared_ptr<T>(), &object);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+// Static USDT tracepoints for attaching bpftrace or perf to a running binary.
+//
+// With <sys/sdt.h> available each probe compiles to a single nop plus an ELF
+// note describing where its arguments live, so probes stay in release builds
+// and cost nothing until a tracer attaches. Arguments are still computed, so
+// pass integers or pointers that are already at hand. Without the header, or
+// with LVM_NO_PROBES defined, probes and their arguments compile out
+// entirely. All probes use the "lvm" provider, e.g.
+//
+//   bpftrace -e 'usdt:./lvm:lvm:syscall_entry { @[arg0] = count(); }'
+//
+// Probes and arguments:
+//   block_entry(ir)                  control transfer by jump, call or return
+//   call(from_ir, target)            CALL, IR of the next instruction
+//   ret(to_ir)                       RET, IR returned to
+//   syscall_entry(number)            InstructionUnit::system_call
+//   syscall_exit(number)
+//   page_switch(page)                PAGE on the data context
+//   block_alloc(context, block)      first physical block for an address
+//   halt(status)                     HLT (status 0) or guest EXIT
+//   fault(ir, message)               exception leaving the CPU loop
+//   span_begin(name, category)       every trace::Span, including the
+//   span_end(name, category)         assembler passes in asm
+
+#if !defined(LVM_NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define LVM_HAVE_PROBES 1
+#endif
+#endif
+
+#if defined(LVM_HAVE_PROBES)
+#define LVM_PROBE1(name, a) DTRACE_PROBE1(lvm, name, a)
+#define LVM_PROBE2(name, a, b) DTRACE_PROBE2(lvm, name, a, b)
+#else
+#define LVM_PROBE1(name, a) do { (void)sizeof(a); } while (0)
+#define LVM_PROBE2(name, a, b) do { (void)sizeof(a); (void)sizeof(b); } while (0)
+#endif
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "probes.h"
+
+// Timeline tracing in the Chrome/Perfetto trace-event JSON format.
+//
+// Events go into a per-thread buffer with no locking on the recording path;
+// nothing is formatted or written until stop(), which runs at exit once
+// start() has been called. While tracing is off every hook costs one relaxed
+// atomic load. Event names, categories and argument names are stored by
+// pointer and must be string literals.
+namespace lvm::trace {
+
+    namespace detail {
+        extern std::atomic<bool> enabled;
+    }
+
+    inline bool enabled() {
+        return detail::enabled.load(std::memory_order_relaxed);
+    }
+
+    // Begin collecting; events are written to path by stop() or at exit
+    void start(const std::string& path);
+
+    // Write collected events and turn tracing off. Threads that record
+    // events must be idle (or joined) by the time this runs.
+    void stop();
+
+    // Nanoseconds since start()
+    uint64_t now_ns();
+
+    // Record a span that began at start_ns and lasted duration_ns ("X" event)
+    void complete(const char* name, const char* category, uint64_t start_ns, uint64_t duration_ns,
+                  const char* arg_name = nullptr, int64_t arg = 0);
+
+    // Record a point in time on the calling thread ("i" event)
+    void instant(const char* name, const char* category,
+                 const char* arg_name = nullptr, int64_t arg = 0);
+
+    /**
+     * Span - Records a complete event covering its lifetime, or until end()
+     */
+    class Span {
+    public:
+        Span(const char* name, const char* category, const char* arg_name = nullptr, int64_t arg = 0)
+            : name_(name), category_(category), arg_name_(arg_name), arg_(arg),
+              active_(enabled()), start_ns_(active_ ? now_ns() : 0) {
+            LVM_PROBE2(span_begin, name_, category_);
+        }
+        ~Span() { end(); }
+
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+
+        void end() {
+            if (open_) {
+                LVM_PROBE2(span_end, name_, category_);
+                open_ = false;
+            }
+            if (active_) {
+                complete(name_, category_, start_ns_, now_ns() - start_ns_, arg_name_, arg_);
+                active_ = false;
+            }
+        }
+
+    private:
+        const char* name_;
+        const char* category_;
+        const char* arg_name_;
+        int64_t arg_;
+        bool active_;
+        bool open_ = true;          // span_end probe not yet fired
+        uint64_t start_ns_;
+    };
+}
@@ -0,0 +1,145 @@
+#include "trace.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <unistd.h>
+#include <vector>
+
+namespace lvm::trace {
+
+    namespace detail {
+        std::atomic<bool> enabled{false};
+    }
+
+    namespace {
+        struct Event {
+            const char* name;
+            const char* category;
+            const char* arg_name;
+            int64_t arg;
+            uint64_t ts_ns;
+            uint64_t duration_ns;
+            char phase;
+        };
+
+        // Owned by the registry so events outlive the thread that recorded them
+        struct ThreadBuffer {
+            uint32_t tid;
+            std::vector<Event> events;
+        };
+
+        constexpr size_t INITIAL_EVENTS_PER_THREAD = 4096;
+
+        std::mutex registry_mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::string output_path;
+        std::chrono::steady_clock::time_point epoch;
+        bool exit_hook_installed = false;
+
+        thread_local ThreadBuffer* local_buffer = nullptr;
+
+        ThreadBuffer& thread_buffer() {
+            if (!local_buffer) {
+                std::lock_guard<std::mutex> lock(registry_mutex);
+                auto buffer = std::make_unique<ThreadBuffer>();
+                buffer->tid = static_cast<uint32_t>(buffers.size() + 1);
+                buffer->events.reserve(INITIAL_EVENTS_PER_THREAD);
+                local_buffer = buffer.get();
+                buffers.push_back(std::move(buffer));
+            }
+            return *local_buffer;
+        }
+
+        void record(const Event& event) {
+            thread_buffer().events.push_back(event);
+        }
+
+        void write_string(std::FILE* out, const char* text) {
+            std::fputc('"', out);
+            for (const char* c = text; *c; ++c) {
+                if (*c == '"' || *c == '\\') std::fputc('\\', out);
+                std::fputc(*c, out);
+            }
+            std::fputc('"', out);
+        }
+
+        void exit_hook() {
+            stop();
+        }
+    }
+
+    void start(const std::string& path) {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        output_path = path;
+        epoch = std::chrono::steady_clock::now();
+        for (auto& buffer : buffers) {
+            buffer->events.clear();
+        }
+        if (!exit_hook_installed) {
+            std::atexit(exit_hook);
+            exit_hook_installed = true;
+        }
+        detail::enabled.store(true, std::memory_order_relaxed);
+    }
+
+    void stop() {
+        if (!detail::enabled.exchange(false, std::memory_order_relaxed)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::FILE* out = std::fopen(output_path.c_str(), "w");
+        if (!out) {
+            std::fprintf(stderr, "trace: cannot write %s\n", output_path.c_str());
+            return;
+        }
+
+        long pid = static_cast<long>(::getpid());
+        std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", out);
+        bool first = true;
+        for (auto& buffer : buffers) {
+            for (const Event& event : buffer->events) {
+                std::fputs(first ? "\n" : ",\n", out);
+                first = false;
+                std::fputs("{\"name\":", out);
+                write_string(out, event.name);
+                std::fputs(",\"cat\":", out);
+                write_string(out, event.category);
+                std::fprintf(out, ",\"ph\":\"%c\",\"pid\":%ld,\"tid\":%u,\"ts\":%.3f",
+                             event.phase, pid, buffer->tid, event.ts_ns / 1000.0);
+                if (event.phase == 'X') {
+                    std::fprintf(out, ",\"dur\":%.3f", event.duration_ns / 1000.0);
+                } else {
+                    std::fputs(",\"s\":\"t\"", out);
+                }
+                if (event.arg_name) {
+                    std::fputs(",\"args\":{", out);
+                    write_string(out, event.arg_name);
+                    std::fprintf(out, ":%lld}", static_cast<long long>(event.arg));
+                }
+                std::fputc('}', out);
+            }
+            buffer->events.clear();
+        }
+        std::fputs("\n]}\n", out);
+        std::fclose(out);
+    }
+
+    uint64_t now_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - epoch).count());
+    }
+
+    void complete(const char* name, const char* category, uint64_t start_ns, uint64_t duration_ns,
+                  const char* arg_name, int64_t arg) {
+        if (!enabled()) return;
+        record({name, category, arg_name, arg, start_ns, duration_ns, 'X'});
+    }
+
+    void instant(const char* name, const char* category, const char* arg_name, int64_t arg) {
+        if (!enabled()) return;
+        record({name, category, arg_name, arg, now_ns(), 0, 'i'});
+    }
+}
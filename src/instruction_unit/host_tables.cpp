@@ -0,0 +1,133 @@
+#include "host_tables.h"
+#include "errors.h"
+#include <string>
+
+using namespace lvm;
+
+HostTables::HostTables(const HostTables& other) : live_tables_(other.live_tables_) {
+    tables_.reserve(other.tables_.size());
+    for (const auto& table : other.tables_) {
+        tables_.push_back(table ? std::make_unique<Table>(*table) : nullptr);
+    }
+}
+
+HostTables& HostTables::operator=(const HostTables& other) {
+    if (this != &other) {
+        *this = HostTables(other);
+    }
+    return *this;
+}
+
+HostTables::handle_t HostTables::create() {
+    // Reuse the lowest free handle before growing
+    for (size_t i = 0; i < tables_.size(); ++i) {
+        if (!tables_[i]) {
+            tables_[i] = std::make_unique<Table>();
+            ++live_tables_;
+            return static_cast<handle_t>(i + 1);
+        }
+    }
+    if (tables_.size() >= MAX_TABLES) {
+        throw lvm::runtime_error("Too many host tables");
+    }
+    tables_.push_back(std::make_unique<Table>());
+    ++live_tables_;
+    return static_cast<handle_t>(tables_.size());
+}
+
+void HostTables::destroy(handle_t handle) {
+    get_table(handle);
+    tables_[handle - 1].reset();
+    --live_tables_;
+}
+
+bool HostTables::insert(handle_t handle, const std::string& key, word_t value) {
+    Table& table = get_table(handle);
+    auto it = table.index.find(key);
+    if (it != table.index.end()) {
+        table.slots[it->second]->value = value;
+        return false;
+    }
+
+    // Reclaim deleted slots once they outnumber live ones, or when the
+    // cursor space is exhausted
+    size_t dead = table.slots.size() - table.index.size();
+    if ((dead > table.index.size() && dead >= 64) || table.slots.size() >= MAX_ENTRIES) {
+        compact(table);
+    }
+    if (table.slots.size() >= MAX_ENTRIES) {
+        throw lvm::runtime_error("Host table " + std::to_string(handle) + " is full");
+    }
+
+    table.index.emplace(key, static_cast<uint32_t>(table.slots.size()));
+    table.slots.push_back(Entry{key, value});
+    return true;
+}
+
+std::optional<word_t> HostTables::lookup(handle_t handle, const std::string& key) const {
+    const Table& table = get_table(handle);
+    auto it = table.index.find(key);
+    if (it == table.index.end()) {
+        return std::nullopt;
+    }
+    return table.slots[it->second]->value;
+}
+
+bool HostTables::erase(handle_t handle, const std::string& key) {
+    Table& table = get_table(handle);
+    auto it = table.index.find(key);
+    if (it == table.index.end()) {
+        return false;
+    }
+    table.slots[it->second].reset();
+    table.index.erase(it);
+    return true;
+}
+
+const HostTables::Entry* HostTables::next(handle_t handle, word_t& cursor) const {
+    const Table& table = get_table(handle);
+    for (size_t slot = cursor; slot < table.slots.size(); ++slot) {
+        if (table.slots[slot]) {
+            cursor = static_cast<word_t>(slot + 1);
+            return &*table.slots[slot];
+        }
+    }
+    cursor = 0;
+    return nullptr;
+}
+
+size_t HostTables::size(handle_t handle) const {
+    return get_table(handle).index.size();
+}
+
+size_t HostTables::table_count() const {
+    return live_tables_;
+}
+
+void HostTables::clear() {
+    tables_.clear();
+    live_tables_ = 0;
+}
+
+HostTables::Table& HostTables::get_table(handle_t handle) {
+    return const_cast<Table&>(static_cast<const HostTables*>(this)->get_table(handle));
+}
+
+const HostTables::Table& HostTables::get_table(handle_t handle) const {
+    if (handle == 0 || handle > tables_.size() || !tables_[handle - 1]) {
+        throw lvm::runtime_error("Invalid host table handle: " + std::to_string(handle));
+    }
+    return *tables_[handle - 1];
+}
+
+void HostTables::compact(Table& table) {
+    std::vector<std::optional<Entry>> live;
+    live.reserve(table.index.size());
+    for (auto& slot : table.slots) {
+        if (slot) {
+            table.index[slot->key] = static_cast<uint32_t>(live.size());
+            live.push_back(std::move(slot));
+        }
+    }
+    table.slots = std::move(live);
+}
@@ -0,0 +1,74 @@
+#pragma once
+#include "memsize.h"
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lvm {
+
+    /**
+     * HostTables - Host-side associative tables backing the TABLE_* syscalls
+     *
+     * Guests address tables through word handles (0 is never a valid handle).
+     * Keys are arbitrary byte strings, values are words. Entries are kept in
+     * insertion order so a word cursor can walk a table; deleted entries leave
+     * a hole that is compacted away on a later insert, which also invalidates
+     * any iteration in progress. All tables belong to one VM instance and are
+     * dropped when it loads a new program or is destroyed.
+     */
+    class HostTables {
+    public:
+        using handle_t = word_t;
+
+        struct Entry {
+            std::string key;
+            word_t value;
+        };
+
+        // Upper bounds imposed by word-sized handles and cursors
+        static constexpr size_t MAX_TABLES = 0xFFFF;
+        static constexpr size_t MAX_ENTRIES = 0xFFFE;
+
+        HostTables() = default;
+        // Deep copy with the same handles (a forked guest gets its own tables)
+        HostTables(const HostTables& other);
+        HostTables& operator=(const HostTables& other);
+        HostTables(HostTables&&) = default;
+        HostTables& operator=(HostTables&&) = default;
+
+        handle_t create();
+        void destroy(handle_t handle);
+
+        // Insert or overwrite; returns true when the key was new
+        bool insert(handle_t handle, const std::string& key, word_t value);
+        std::optional<word_t> lookup(handle_t handle, const std::string& key) const;
+        // Returns true when the key was present
+        bool erase(handle_t handle, const std::string& key);
+
+        // Iteration: start with cursor 0; returns the next live entry and
+        // advances cursor past it, or null (cursor reset to 0) at the end
+        const Entry* next(handle_t handle, word_t& cursor) const;
+
+        size_t size(handle_t handle) const;
+        size_t table_count() const;
+
+        // Drop every table; handles issued before are no longer valid
+        void clear();
+
+    private:
+        struct Table {
+            std::unordered_map<std::string, uint32_t> index;   // key -> slot
+            std::vector<std::optional<Entry>> slots;           // insertion order, empty = deleted
+        };
+
+        std::vector<std::unique_ptr<Table>> tables_;   // handle - 1 -> table, null = free
+        size_t live_tables_ = 0;
+
+        Table& get_table(handle_t handle);
+        const Table& get_table(handle_t handle) const;
+        static void compact(Table& table);
+    };
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "memsize.h"
+#include <cstddef>
+
+namespace lvm {
+
+    /**
+     * ICodeSource - Pure virtual interface for code images that arrive over time
+     * 
+     * Lets the instruction unit start executing before the whole code segment
+     * has been read. Code is delivered as a growing prefix; the instruction
+     * unit maps it into the code context page by page as IR reaches it.
+     */
+    class ICodeSource {
+    public:
+        virtual ~ICodeSource() = default;
+
+        // Total size of the code segment in bytes
+        virtual size_t code_size() const = 0;
+
+        // Blocks until at least min(end, code_size()) bytes have arrived and
+        // returns the number of bytes available. Throws if the image is cut short.
+        virtual size_t wait_for(size_t end) = 0;
+
+        // Copies already available bytes [offset, offset + length) into out
+        virtual void copy_code(size_t offset, byte_t* out, size_t length) const = 0;
+    };
+
+} // namespace lvm
@@ -2,12 +2,16 @@
 #include "register.h"
 #include "accessMode.h"
 #include <memory>
+#include <span>
 #include "memsize.h"
 #include "paged_memory_accessor.h"
 #include "vmemunit.h"
 #include "istack.h"
 #include "basic_io.h"
 #include "iinstruction_unit.h"
+#include "icode_source.h"
+#include "host_tables.h"
+#include "iprocess_control.h"
 namespace lvm{
 
     class InstructionUnit; // Forward declaration
@@ -25,12 +29,14 @@ namespace lvm{
         void set_IR(word_t value);
         void Jump_To_Address(addr_t address);
         void Jump_To_Address_Conditional(addr_t address, Flag flag, bool condition);
-        void Load_Program(const std::vector<byte_t>& program);
+        void Load_Program(std::span<const byte_t> program);
 
         // subroutines
         void call_subroutine(addr_t address, bool with_return_value = false);
         void return_from_subroutine();
         void system_call(word_t syscall_number);
+        // True if the system call would wait for input that has not arrived yet
+        bool syscall_would_block(word_t syscall_number) const;
 
     private:
         friend class InstructionUnit;
@@ -47,11 +53,35 @@ namespace lvm{
         
         // IInstructionUnit interface implementation
         std::unique_ptr<InstructionUnit_Accessor> get_accessor(MemAccessMode mode) override;
+
+        // Streaming load: code is mapped from the source as execution reaches it
+        // rather than copied up front. A fetch beyond the mapped prefix blocks
+        // until the source delivers the page holding it.
+        void set_code_source(std::shared_ptr<ICodeSource> source);
+
+        // Granularity at which streamed code is mapped into the code context
+        static constexpr addr32_t CODE_MAP_PAGE_SIZE = 4096;
+
+        // Data context that TABLE_* syscalls read keys from and write keys to
+        void set_data_context(context_id_t data_context_id) { data_context_id_ = data_context_id; }
+
+        // Tables live as long as the loaded program; loading another drops them
+        const HostTables& host_tables() const { return host_tables_; }
+
+        // Target of the EXIT, FORK and WAIT syscalls; without one they raise
+        // a runtime error
+        void set_process_control(std::shared_ptr<IProcessControl> process_control) {
+            process_control_ = std::move(process_control);
+        }
+
+        // Take over IR, return stack, host tables and any code still
+        // streaming in from a forked parent
+        void fork_from(const InstructionUnit& parent);
     private:
     friend class InstructionUnit_Accessor;    
         std::shared_ptr<IVMemUnit> vmem_unit_;
         context_id_t code_context_id_;
-        std::unique_ptr<Register> ir_register;
+        Register ir_register;
         std::shared_ptr<Flags> flags;
         IStack& stack_;
 
@@ -61,14 +91,29 @@ namespace lvm{
         };
         std::vector<ReturnStackItem> return_stack;
         std::shared_ptr<BasicIO> basic_io_;
+
+        // Streaming state; code_source_ is dropped once the whole image is mapped
+        std::shared_ptr<ICodeSource> code_source_;
+        addr32_t mapped_code_end_ = 0;
+        void map_code_through(addr32_t address);
+
+        HostTables host_tables_;
+        context_id_t data_context_id_ = 0;
+        bool table_system_call(word_t syscall_number);
+        std::shared_ptr<IProcessControl> process_control_;
+        bool process_system_call(word_t syscall_number);
+        void dispatch_system_call(word_t syscall_number);
+        std::string read_table_key(addr_t address, word_t length);
+        void write_code(addr32_t address, const byte_t* bytes, size_t length);
         
         void set_IR(word_t value);
         void advance_IR(word_t offset);
         void jump_to_address(addr_t address);
         void jump_to_address_conditional(addr_t address, Flag flag, bool condition);
-        void load_program(const std::vector<byte_t>& program);
+        void load_program(std::span<const byte_t> program);
         void call_subroutine(addr_t address, bool with_return_value = false);
         void return_from_subroutine();
         void system_call(word_t syscall_number);
+        bool syscall_would_block(word_t syscall_number) const;
     };
 }
\ No newline at end of file
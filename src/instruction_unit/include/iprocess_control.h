@@ -0,0 +1,29 @@
+#pragma once
+#include "memsize.h"
+
+namespace lvm {
+
+    /**
+     * IProcessControl - Pure virtual interface behind the process syscalls
+     *
+     * Implemented by the VM instance that owns the instruction unit, since
+     * forking clones every component of the guest, not just the instruction
+     * unit. Calls arrive from the guest's own thread while it is executing.
+     */
+    class IProcessControl {
+    public:
+        virtual ~IProcessControl() = default;
+
+        // Clone the running guest; returns the child's handle (never 0).
+        // The child resumes after the same syscall and sees 0 instead.
+        virtual word_t fork() = 0;
+
+        // Block until the child has finished and return its exit status;
+        // the handle is released
+        virtual word_t wait(word_t child) = 0;
+
+        // Stop the guest after the current instruction with the given status
+        virtual void exit(word_t status) = 0;
+    };
+
+} // namespace lvm
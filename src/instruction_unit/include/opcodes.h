@@ -174,6 +174,67 @@
 // Extended instruction set marker
 #define OPCODE_EXTENDED         0x80  // All higher ops reserved for extended op sets
 
+// Extended: memory-operand ALU (one address translation per instruction)
+#define OPCODE_ADD_MEM_W        0x80  // ADD AX, [addr] - Add word at address to AX
+#define OPCODE_SUB_MEM_W        0x81  // SUB AX, [addr]
+#define OPCODE_MUL_MEM_W        0x82  // MUL AX, [addr]
+#define OPCODE_DIV_MEM_W        0x83  // DIV AX, [addr]
+#define OPCODE_REM_MEM_W        0x84  // REM AX, [addr]
+#define OPCODE_AND_MEM_W        0x85  // AND AX, [addr]
+#define OPCODE_OR_MEM_W         0x86  // OR AX, [addr]
+#define OPCODE_XOR_MEM_W        0x87  // XOR AX, [addr]
+#define OPCODE_ADD_ADDR_IMM_W   0x88  // ADD [addr], imm - Add immediate word to word at address
+#define OPCODE_SUB_ADDR_IMM_W   0x89  // SUB [addr], imm
+#define OPCODE_AND_ADDR_IMM_W   0x8A  // AND [addr], imm
+#define OPCODE_OR_ADDR_IMM_W    0x8B  // OR [addr], imm
+#define OPCODE_XOR_ADDR_IMM_W   0x8C  // XOR [addr], imm
+#define OPCODE_INC_ADDR         0x8D  // INC [addr] - Increment word at address
+#define OPCODE_DEC_ADDR         0x8E  // DEC [addr] - Decrement word at address
+#define OPCODE_STA_ADDR_IMM_W   0x8F  // STA [addr], imm - Store immediate word to address
+
+// Extended: ALU with any destination register (AX-EX); flags as for the AX forms
+#define OPCODE_ADD_REG_REG_W    0x90  // ADD reg, reg - Add register to any register
+#define OPCODE_ADD_REG_IMM_W    0x91  // ADD reg, imm - Add immediate word to any register
+#define OPCODE_SUB_REG_REG_W    0x92  // SUB reg, reg
+#define OPCODE_SUB_REG_IMM_W    0x93  // SUB reg, imm
+#define OPCODE_MUL_REG_REG_W    0x94  // MUL reg, reg
+#define OPCODE_MUL_REG_IMM_W    0x95  // MUL reg, imm
+#define OPCODE_DIV_REG_REG_W    0x96  // DIV reg, reg
+#define OPCODE_DIV_REG_IMM_W    0x97  // DIV reg, imm
+#define OPCODE_REM_REG_REG_W    0x98  // REM reg, reg
+#define OPCODE_REM_REG_IMM_W    0x99  // REM reg, imm
+#define OPCODE_AND_REG_REG_W    0x9A  // AND reg, reg
+#define OPCODE_AND_REG_IMM_W    0x9B  // AND reg, imm
+#define OPCODE_OR_REG_REG_W     0x9C  // OR reg, reg
+#define OPCODE_OR_REG_IMM_W     0x9D  // OR reg, imm
+#define OPCODE_XOR_REG_REG_W    0x9E  // XOR reg, reg
+#define OPCODE_XOR_REG_IMM_W    0x9F  // XOR reg, imm
+#define OPCODE_SHL_REG_REG_W    0xA0  // SHL reg, reg
+#define OPCODE_SHL_REG_IMM_W    0xA1  // SHL reg, imm
+#define OPCODE_SHR_REG_REG_W    0xA2  // SHR reg, reg
+#define OPCODE_SHR_REG_IMM_W    0xA3  // SHR reg, imm
+#define OPCODE_ROL_REG_REG_W    0xA4  // ROL reg, reg
+#define OPCODE_ROL_REG_IMM_W    0xA5  // ROL reg, imm
+#define OPCODE_ROR_REG_REG_W    0xA6  // ROR reg, reg
+#define OPCODE_ROR_REG_IMM_W    0xA7  // ROR reg, imm
+
+// Extended: register-mask push/pop (mask bit n = register code n+1, AX-EX)
+#define OPCODE_PUSHM_MASK       0xA8  // PUSHM mask - Push the masked registers, AX first
+#define OPCODE_POPM_MASK        0xA9  // POPM mask - Pop the masked registers, EX first
+#define OPCODE_PUSHA            0xAA  // PUSHA - Push AX-EX
+#define OPCODE_POPA             0xAB  // POPA - Pop EX-AX
+
+// Extended: linear data addressing. The 32-bit address (little-endian, like
+// CALL) indexes the whole data context; the current page is not used
+#define OPCODE_LDX_REG_ADDR32_W   0xAC  // LDX reg, addr32 - Load word from linear address
+#define OPCODE_LDXL_REG_ADDR32_B  0xAD  // LDXL reg, addr32 - Load byte to register low
+#define OPCODE_STX_ADDR32_REG_W   0xAE  // STX addr32, reg - Store word to linear address
+#define OPCODE_STXL_ADDR32_REG_B  0xAF  // STXL addr32, reg - Store low byte
+#define OPCODE_LDX_REG_PAIR_W     0xB0  // LDX reg, hi, lo - Load word from address hi:lo
+#define OPCODE_LDXL_REG_PAIR_B    0xB1  // LDXL reg, hi, lo
+#define OPCODE_STX_PAIR_REG_W     0xB2  // STX hi, lo, reg - Store word to address hi:lo
+#define OPCODE_STXL_PAIR_REG_B    0xB3  // STXL hi, lo, reg
+
 namespace lvm {
  constexpr int get_additional_bytes(byte_t opcode) {
      // System operations
@@ -317,6 +378,21 @@ namespace lvm {
      if (opcode == OPCODE_LDAL_REG_REGADDR_B) return 2;
      // System call
      if (opcode == OPCODE_SYS_FUNC) return 2;
+     // Extended: memory-operand ALU
+     if (opcode >= OPCODE_ADD_MEM_W && opcode <= OPCODE_XOR_MEM_W) return 2;
+     if (opcode >= OPCODE_ADD_ADDR_IMM_W && opcode <= OPCODE_XOR_ADDR_IMM_W) return 4;  // address + immediate
+     if (opcode == OPCODE_INC_ADDR) return 2;
+     if (opcode == OPCODE_DEC_ADDR) return 2;
+     if (opcode == OPCODE_STA_ADDR_IMM_W) return 4;
+     // Extended: ALU with any destination register (even opcodes take a
+     // source register, odd ones an immediate word)
+     if (opcode >= OPCODE_ADD_REG_REG_W && opcode <= OPCODE_ROR_REG_IMM_W) return (opcode & 1) ? 3 : 2;
+     // Extended: register-mask push/pop
+     if (opcode == OPCODE_PUSHM_MASK) return 1;
+     if (opcode == OPCODE_POPM_MASK) return 1;
+     // Extended: linear data addressing (register + 4 address bytes, or three registers)
+     if (opcode >= OPCODE_LDX_REG_ADDR32_W && opcode <= OPCODE_STXL_ADDR32_REG_B) return 5;
+     if (opcode >= OPCODE_LDX_REG_PAIR_W && opcode <= OPCODE_STXL_PAIR_REG_B) return 3;
      // All others
      return 0;
  }
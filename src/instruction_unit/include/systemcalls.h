@@ -2,7 +2,23 @@
 
 // System call table
 // reserved: 0x0000 - 0x000F for system exit modes
+#define SYSCALL_EXIT                         0x0000  // status -> (halts the guest)
 #define SYSCALL_PRINT_STRING_FROM_STACK      0x0010  // Print string from stack
 #define SYSCALL_PRINT_LINE_FROM_STACK        0x0011  // Print line from stack
 #define SYSCALL_READ_LINE_ONTO_STACK         0x0012  // Read line onto stack
+#define SYSCALL_READ_LINE_TOKENIZED          0x0013  // Read line into data buffer and build token table
+
+// Process control: the child of a FORK runs concurrently on a host thread
+#define SYSCALL_FORK                         0x0040  // -> child handle (parent) or 0 (child)
+#define SYSCALL_WAIT                         0x0041  // child handle -> exit status
+
+// Host associative tables: byte-string keys read from the current data page,
+// word values. Arguments are popped in the order listed (push them in reverse).
+#define SYSCALL_TABLE_CREATE                 0x0060  // -> handle
+#define SYSCALL_TABLE_DESTROY                0x0061  // handle ->
+#define SYSCALL_TABLE_INSERT                 0x0062  // handle, key addr, key length, value ->
+#define SYSCALL_TABLE_LOOKUP                 0x0063  // handle, key addr, key length -> value, found (top)
+#define SYSCALL_TABLE_DELETE                 0x0064  // handle, key addr, key length -> found
+#define SYSCALL_TABLE_NEXT                   0x0065  // handle, cursor, buffer addr, buffer capacity
+                                                     //   -> value, key length, next cursor (top; 0 = done)
 #define SYSCALL_DEBUG_PRINT_WORD             0x1500  // Debug: print word from stack as number
\ No newline at end of file
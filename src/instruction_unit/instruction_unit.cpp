@@ -6,12 +6,16 @@
 #include "systemcalls.h"
 #include "basic_io.h"
 #include "basic_io_accessor.h"
+#include "trace.h"
+#include "probes.h"
+#include <algorithm>
 #include <iostream>
 using namespace lvm;
 
 InstructionUnit::InstructionUnit(std::shared_ptr<IVMemUnit> vmem_unit, context_id_t code_context_id, IStack& stack, std::shared_ptr<Flags> flags_ptr, std::shared_ptr<BasicIO> basic_io)
     : vmem_unit_(std::move(vmem_unit)),
          code_context_id_(code_context_id),
+         ir_register(flags_ptr),
          stack_(stack),
          basic_io_(std::move(basic_io))
 {
@@ -20,7 +24,6 @@ InstructionUnit::InstructionUnit(std::shared_ptr<IVMemUnit> vmem_unit, context_i
         throw lvm::runtime_error("InstructionUnit must be created in unprotected mode");
     }
 
-    ir_register = std::make_unique<Register>(flags_ptr);
     flags = flags_ptr;
 }
 
@@ -31,44 +34,78 @@ std::unique_ptr<InstructionUnit_Accessor> InstructionUnit::get_accessor(MemAcces
 }
 
 void InstructionUnit::set_IR(word_t value) {
-    ir_register->set_value(value);
+    ir_register.set_value(value);
 }   
 void InstructionUnit::advance_IR(word_t offset) {
-    word_t current = ir_register->get_value();
-    ir_register->set_value(current + offset);
+    word_t current = ir_register.get_value();
+    ir_register.set_value(current + offset);
 }
 
 void InstructionUnit::jump_to_address(addr_t address) {
-    ir_register->set_value(address);
+    ir_register.set_value(address);
 }
 
 void InstructionUnit::jump_to_address_conditional(addr_t address, Flag flag, bool condition) {
     bool flag_set = flags->is_set(flag);
     if (flag_set == condition) {
-        ir_register->set_value(address);
+        ir_register.set_value(address);
     }
 }
 
-void InstructionUnit::load_program(const std::vector<byte_t>& program) {
+void InstructionUnit::load_program(std::span<const byte_t> program) {
+    host_tables_.clear();
+    code_source_.reset();
+    write_code(0, program.data(), program.size());
+    mapped_code_end_ = static_cast<addr32_t>(program.size());
+}
+
+void InstructionUnit::write_code(addr32_t address, const byte_t* bytes, size_t length) {
     auto code_ctx = vmem_unit_->get_context(code_context_id_);
     auto code_accessor = code_ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
     
-    // Write program to code space across pages (optimized)
-    const size_t PAGE_SIZE = 256; // Assuming 256 bytes per page
-    size_t program_size = program.size();
-    addr32_t addr = 0;
-    while (addr < program_size) {
-        page_t page = addr / PAGE_SIZE;
-        code_accessor->set_page(page);
-        // Write all bytes for this page in one go
-        addr_t offset = addr % PAGE_SIZE;
-        size_t bytes_left_in_page = PAGE_SIZE - offset;
-        size_t bytes_left_in_program = program_size - addr;
-        size_t chunk_size = std::min(bytes_left_in_page, bytes_left_in_program);
+    // Write across pages: page is the high 16 bits of the address, offset the low 16
+    size_t written = 0;
+    while (written < length) {
+        addr32_t addr = address + static_cast<addr32_t>(written);
+        code_accessor->set_page(static_cast<page_t>(addr >> 16));
+        addr_t offset = addr & 0xFFFF;
+        size_t chunk_size = std::min<size_t>(0x10000 - offset, length - written);
         for (size_t i = 0; i < chunk_size; ++i) {
-            code_accessor->write_byte(offset + i, program[addr + i]);
+            code_accessor->write_byte(static_cast<addr_t>(offset + i), bytes[written + i]);
         }
-        addr += chunk_size;
+        written += chunk_size;
+    }
+}
+
+void InstructionUnit::fork_from(const InstructionUnit& parent) {
+    ir_register.set_value(parent.ir_register.get_value());
+    return_stack = parent.return_stack;
+    host_tables_ = parent.host_tables_;
+    code_source_ = parent.code_source_;
+    mapped_code_end_ = parent.mapped_code_end_;
+}
+
+void InstructionUnit::set_code_source(std::shared_ptr<ICodeSource> source) {
+    host_tables_.clear();
+    code_source_ = std::move(source);
+    mapped_code_end_ = 0;
+}
+
+void InstructionUnit::map_code_through(addr32_t address) {
+    // Map whole pages so a straight-line run only waits once per page
+    size_t target = (static_cast<size_t>(address) / CODE_MAP_PAGE_SIZE + 1) * CODE_MAP_PAGE_SIZE;
+    size_t available = code_source_->wait_for(target);
+
+    if (available > mapped_code_end_) {
+        std::vector<byte_t> chunk(available - mapped_code_end_);
+        code_source_->copy_code(mapped_code_end_, chunk.data(), chunk.size());
+        write_code(mapped_code_end_, chunk.data(), chunk.size());
+        mapped_code_end_ = static_cast<addr32_t>(available);
+    }
+
+    // Fully mapped: later fetches no longer need to consult the source
+    if (mapped_code_end_ >= code_source_->code_size()) {
+        code_source_.reset();
     }
 }
 
@@ -76,12 +113,12 @@ void InstructionUnit::call_subroutine(addr_t address, bool with_return_value){
     auto stack_accessor = stack_.get_accessor(MemAccessMode::READ_WRITE);
 
     ReturnStackItem item;
-    item.return_address = ir_register->get_value();
+    item.return_address = ir_register.get_value();
     item.frame_pointer = stack_accessor->get_fp();
 
     return_stack.push_back(item);
 
-    ir_register->set_value(address);
+    ir_register.set_value(address);
 
     if (with_return_value) {
         stack_accessor->push_byte(1);
@@ -102,7 +139,7 @@ void InstructionUnit::return_from_subroutine() {
     ReturnStackItem item = return_stack.back();
     return_stack.pop_back();
 
-    ir_register->set_value(item.return_address);
+    ir_register.set_value(item.return_address);
     
     auto stack_accessor = stack_.get_accessor(MemAccessMode::READ_WRITE);
     byte_t has_return_value = stack_accessor->peek_byte_from_frame(0);
@@ -122,7 +159,42 @@ void InstructionUnit::return_from_subroutine() {
     }
 }
 
+static const char* syscall_trace_name(word_t syscall_number) {
+    switch (syscall_number) {
+        case SYSCALL_PRINT_STRING_FROM_STACK: return "syscall print_string";
+        case SYSCALL_PRINT_LINE_FROM_STACK:   return "syscall print_line";
+        case SYSCALL_READ_LINE_ONTO_STACK:    return "syscall read_line";
+        case SYSCALL_READ_LINE_TOKENIZED:     return "syscall read_line_tokenized";
+        case SYSCALL_DEBUG_PRINT_WORD:        return "syscall debug_print_word";
+        case SYSCALL_EXIT:                    return "syscall exit";
+        case SYSCALL_FORK:                    return "syscall fork";
+        case SYSCALL_WAIT:                    return "syscall wait";
+        case SYSCALL_TABLE_CREATE:            return "syscall table_create";
+        case SYSCALL_TABLE_DESTROY:           return "syscall table_destroy";
+        case SYSCALL_TABLE_INSERT:            return "syscall table_insert";
+        case SYSCALL_TABLE_LOOKUP:            return "syscall table_lookup";
+        case SYSCALL_TABLE_DELETE:            return "syscall table_delete";
+        case SYSCALL_TABLE_NEXT:              return "syscall table_next";
+        default:                              return "syscall";
+    }
+}
+
 void InstructionUnit::system_call(word_t syscall_number) {
+    trace::Span span(syscall_trace_name(syscall_number), "syscall", "number", syscall_number);
+    LVM_PROBE1(syscall_entry, syscall_number);
+    dispatch_system_call(syscall_number);
+    LVM_PROBE1(syscall_exit, syscall_number);
+}
+
+bool InstructionUnit::syscall_would_block(word_t syscall_number) const {
+    return (syscall_number == SYSCALL_READ_LINE_ONTO_STACK || syscall_number == SYSCALL_READ_LINE_TOKENIZED) &&
+           !basic_io_->input_ready();
+}
+
+void InstructionUnit::dispatch_system_call(word_t syscall_number) {
+    if (table_system_call(syscall_number) || process_system_call(syscall_number)) {
+        return;
+    }
     auto io_accessor = basic_io_->get_accessor();
     switch (syscall_number) {
         case SYSCALL_PRINT_STRING_FROM_STACK: {
@@ -137,6 +209,10 @@ void InstructionUnit::system_call(word_t syscall_number) {
             io_accessor->read_line_onto_stack();
             break;
         }
+        case SYSCALL_READ_LINE_TOKENIZED: {
+            io_accessor->read_line_tokenized();
+            break;
+        }
         case SYSCALL_DEBUG_PRINT_WORD: {
             io_accessor->debug_print_word();
             break;
@@ -144,4 +220,104 @@ void InstructionUnit::system_call(word_t syscall_number) {
         default:
             throw lvm::runtime_error("Invalid system call number: " + std::to_string(syscall_number));
     }
-}
\ No newline at end of file
+}
+
+bool InstructionUnit::process_system_call(word_t syscall_number) {
+    if (syscall_number != SYSCALL_EXIT && syscall_number != SYSCALL_FORK && syscall_number != SYSCALL_WAIT) {
+        return false;
+    }
+    if (!process_control_) {
+        throw lvm::runtime_error("Process control is not available for system call " + std::to_string(syscall_number));
+    }
+    switch (syscall_number) {
+        case SYSCALL_EXIT: {
+            word_t status = stack_.get_accessor(MemAccessMode::READ_WRITE)->pop_word();
+            process_control_->exit(status);
+            break;
+        }
+        case SYSCALL_FORK: {
+            // The child is cloned before the result is pushed, so it
+            // receives its own result (0) on its own stack
+            word_t child = process_control_->fork();
+            stack_.get_accessor(MemAccessMode::READ_WRITE)->push_word(child);
+            break;
+        }
+        case SYSCALL_WAIT: {
+            word_t child = stack_.get_accessor(MemAccessMode::READ_WRITE)->pop_word();
+            word_t status = process_control_->wait(child);
+            stack_.get_accessor(MemAccessMode::READ_WRITE)->push_word(status);
+            break;
+        }
+    }
+    return true;
+}
+
+std::string InstructionUnit::read_table_key(addr_t address, word_t length) {
+    auto data_accessor = vmem_unit_->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_ONLY);
+    std::string key(length, '\0');
+    for (word_t i = 0; i < length; ++i) {
+        key[i] = static_cast<char>(data_accessor->read_byte(static_cast<addr_t>(address + i)));
+    }
+    return key;
+}
+
+bool InstructionUnit::table_system_call(word_t syscall_number) {
+    if (syscall_number < SYSCALL_TABLE_CREATE || syscall_number > SYSCALL_TABLE_NEXT) {
+        return false;
+    }
+    auto stack_accessor = stack_.get_accessor(MemAccessMode::READ_WRITE);
+    if (syscall_number == SYSCALL_TABLE_CREATE) {
+        stack_accessor->push_word(host_tables_.create());
+        return true;
+    }
+
+    HostTables::handle_t handle = stack_accessor->pop_word();
+    switch (syscall_number) {
+        case SYSCALL_TABLE_DESTROY:
+            host_tables_.destroy(handle);
+            break;
+        case SYSCALL_TABLE_INSERT: {
+            addr_t key_address = stack_accessor->pop_word();
+            word_t key_length = stack_accessor->pop_word();
+            word_t value = stack_accessor->pop_word();
+            host_tables_.insert(handle, read_table_key(key_address, key_length), value);
+            break;
+        }
+        case SYSCALL_TABLE_LOOKUP: {
+            addr_t key_address = stack_accessor->pop_word();
+            word_t key_length = stack_accessor->pop_word();
+            auto value = host_tables_.lookup(handle, read_table_key(key_address, key_length));
+            stack_accessor->push_word(value.value_or(0));
+            stack_accessor->push_word(value ? 1 : 0);
+            break;
+        }
+        case SYSCALL_TABLE_DELETE: {
+            addr_t key_address = stack_accessor->pop_word();
+            word_t key_length = stack_accessor->pop_word();
+            bool found = host_tables_.erase(handle, read_table_key(key_address, key_length));
+            stack_accessor->push_word(found ? 1 : 0);
+            break;
+        }
+        case SYSCALL_TABLE_NEXT: {
+            word_t cursor = stack_accessor->pop_word();
+            addr_t buffer_address = stack_accessor->pop_word();
+            word_t buffer_capacity = stack_accessor->pop_word();
+            const HostTables::Entry* entry = host_tables_.next(handle, cursor);
+            word_t key_length = 0;
+            if (entry) {
+                // Keys longer than the buffer are truncated; the full length is still returned
+                auto data_accessor = vmem_unit_->get_context(data_context_id_)->create_paged_accessor(MemAccessMode::READ_WRITE);
+                size_t copy_length = std::min<size_t>(entry->key.size(), buffer_capacity);
+                for (size_t i = 0; i < copy_length; ++i) {
+                    data_accessor->write_byte(static_cast<addr_t>(buffer_address + i), static_cast<byte_t>(entry->key[i]));
+                }
+                key_length = static_cast<word_t>(entry->key.size());
+            }
+            stack_accessor->push_word(entry ? entry->value : 0);
+            stack_accessor->push_word(key_length);
+            stack_accessor->push_word(cursor);
+            break;
+        }
+    }
+    return true;
+}
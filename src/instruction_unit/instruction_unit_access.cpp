@@ -13,11 +13,14 @@ InstructionUnit_Accessor::~InstructionUnit_Accessor() {}
 // Read Access Methods
 
 word_t InstructionUnit_Accessor::get_IR() const {
-    return instruction_unit_ref->ir_register->get_value();
+    return instruction_unit_ref->ir_register.get_value();
 }
 
 word_t InstructionUnit_Accessor::readByte_At_IR() const {
-    addr32_t ir_value = instruction_unit_ref->ir_register->get_value();
+    addr32_t ir_value = instruction_unit_ref->ir_register.get_value();
+    if (instruction_unit_ref->code_source_ && ir_value >= instruction_unit_ref->mapped_code_end_) {
+        instruction_unit_ref->map_code_through(ir_value);
+    }
     auto code_ctx = instruction_unit_ref->vmem_unit_->get_context(instruction_unit_ref->code_context_id_);
     auto code_accessor = code_ctx->create_paged_accessor(MemAccessMode::READ_ONLY);
     
@@ -29,7 +32,10 @@ word_t InstructionUnit_Accessor::readByte_At_IR() const {
 }
 
 word_t InstructionUnit_Accessor::readWWord_At_IR() const {
-    addr32_t ir_value = instruction_unit_ref->ir_register->get_value();
+    addr32_t ir_value = instruction_unit_ref->ir_register.get_value();
+    if (instruction_unit_ref->code_source_ && ir_value + 1 >= instruction_unit_ref->mapped_code_end_) {
+        instruction_unit_ref->map_code_through(ir_value + 1);
+    }
     auto code_ctx = instruction_unit_ref->vmem_unit_->get_context(instruction_unit_ref->code_context_id_);
     auto code_accessor = code_ctx->create_paged_accessor(MemAccessMode::READ_ONLY);
     
@@ -70,7 +76,7 @@ void InstructionUnit_Accessor::Jump_To_Address_Conditional(addr_t address, Flag
     instruction_unit_ref->jump_to_address_conditional(address, flag, condition);
 }
 
-void InstructionUnit_Accessor::Load_Program(const std::vector<byte_t>& program) {
+void InstructionUnit_Accessor::Load_Program(std::span<const byte_t> program) {
     if (mode != MemAccessMode::READ_WRITE) {
         throw lvm::runtime_error("Attempt to load program in READ_ONLY mode");
     }
@@ -100,3 +106,7 @@ void InstructionUnit_Accessor::system_call(word_t syscall_number) {
     instruction_unit_ref->system_call(syscall_number);
 }
 
+bool InstructionUnit_Accessor::syscall_would_block(word_t syscall_number) const {
+    return instruction_unit_ref->syscall_would_block(syscall_number);
+}
+
@@ -0,0 +1,228 @@
+#include <gtest/gtest.h>
+#include "host_tables.h"
+#include "instruction_unit.h"
+#include "systemcalls.h"
+#include "vmemunit.h"
+#include "stack.h"
+#include "flags.h"
+#include "basic_io.h"
+#include "errors.h"
+#include <set>
+
+using namespace lvm;
+
+TEST(HostTablesTest, InsertLookupErase) {
+    HostTables tables;
+    auto handle = tables.create();
+    EXPECT_NE(handle, 0);
+
+    EXPECT_TRUE(tables.insert(handle, "north", 1));
+    EXPECT_TRUE(tables.insert(handle, "south", 2));
+    EXPECT_FALSE(tables.insert(handle, "north", 7));   // overwrite
+
+    EXPECT_EQ(tables.lookup(handle, "north"), std::optional<word_t>(7));
+    EXPECT_EQ(tables.lookup(handle, "south"), std::optional<word_t>(2));
+    EXPECT_EQ(tables.lookup(handle, "east"), std::nullopt);
+    EXPECT_EQ(tables.size(handle), 2u);
+
+    EXPECT_TRUE(tables.erase(handle, "north"));
+    EXPECT_FALSE(tables.erase(handle, "north"));
+    EXPECT_EQ(tables.lookup(handle, "north"), std::nullopt);
+    EXPECT_EQ(tables.size(handle), 1u);
+}
+
+TEST(HostTablesTest, KeysAreByteStrings) {
+    HostTables tables;
+    auto handle = tables.create();
+    tables.insert(handle, std::string("a\0b", 3), 1);
+    tables.insert(handle, std::string("a\0c", 3), 2);
+    EXPECT_EQ(tables.lookup(handle, std::string("a\0b", 3)), std::optional<word_t>(1));
+    EXPECT_EQ(tables.lookup(handle, std::string("a\0c", 3)), std::optional<word_t>(2));
+    EXPECT_EQ(tables.lookup(handle, "a"), std::nullopt);
+}
+
+TEST(HostTablesTest, IterationVisitsLiveEntriesInInsertionOrder) {
+    HostTables tables;
+    auto handle = tables.create();
+    tables.insert(handle, "lamp", 1);
+    tables.insert(handle, "key", 2);
+    tables.insert(handle, "sword", 3);
+    tables.erase(handle, "key");
+
+    word_t cursor = 0;
+    std::vector<std::string> keys;
+    while (const auto* entry = tables.next(handle, cursor)) {
+        keys.push_back(entry->key);
+        EXPECT_NE(cursor, 0);
+    }
+    EXPECT_EQ(keys, (std::vector<std::string>{"lamp", "sword"}));
+    EXPECT_EQ(cursor, 0);
+}
+
+TEST(HostTablesTest, DeletedSlotsAreCompacted) {
+    HostTables tables;
+    auto handle = tables.create();
+    for (int round = 0; round < 2000; ++round) {
+        tables.insert(handle, "k" + std::to_string(round), static_cast<word_t>(round));
+        if (round > 0) {
+            tables.erase(handle, "k" + std::to_string(round - 1));
+        }
+    }
+    EXPECT_EQ(tables.size(handle), 1u);
+
+    // Cursor space stays small because dead slots were reclaimed
+    word_t cursor = 0;
+    const auto* entry = tables.next(handle, cursor);
+    ASSERT_NE(entry, nullptr);
+    EXPECT_EQ(entry->key, "k1999");
+    EXPECT_LT(cursor, 200);
+}
+
+TEST(HostTablesTest, HandlesAreValidatedAndReused) {
+    HostTables tables;
+    auto first = tables.create();
+    auto second = tables.create();
+    EXPECT_NE(first, second);
+    EXPECT_EQ(tables.table_count(), 2u);
+
+    tables.destroy(first);
+    EXPECT_THROW(tables.lookup(first, "x"), lvm::runtime_error);
+    EXPECT_THROW(tables.destroy(first), lvm::runtime_error);
+    EXPECT_THROW(tables.insert(0, "x", 1), lvm::runtime_error);
+    EXPECT_EQ(tables.create(), first);
+
+    tables.clear();
+    EXPECT_EQ(tables.table_count(), 0u);
+    EXPECT_THROW(tables.size(second), lvm::runtime_error);
+}
+
+TEST(HostTablesTest, CopiesAreIndependent) {
+    HostTables tables;
+    auto handle = tables.create();
+    tables.insert(handle, "north", 1);
+
+    HostTables copy = tables;
+    copy.insert(handle, "south", 2);
+    copy.insert(handle, "north", 3);
+    EXPECT_EQ(tables.lookup(handle, "north"), 1);
+    EXPECT_FALSE(tables.lookup(handle, "south"));
+    EXPECT_EQ(copy.lookup(handle, "north"), 3);
+    EXPECT_EQ(copy.table_count(), 1u);
+}
+
+// Syscalls read keys from the data context and pass everything else on the stack
+class HostTableSyscallTest : public ::testing::Test {
+protected:
+    std::shared_ptr<VMemUnit> vmem_unit;
+    std::shared_ptr<Stack> stack;
+    std::shared_ptr<BasicIO> basic_io;
+    std::unique_ptr<InstructionUnit> iu;
+    context_id_t data_context_id;
+
+    void SetUp() override {
+        vmem_unit = std::make_shared<VMemUnit>();
+        stack = std::make_shared<Stack>(vmem_unit, 1024);
+        basic_io = std::make_shared<BasicIO>(vmem_unit, stack);
+        context_id_t code_context_id = vmem_unit->create_context(65536);
+        data_context_id = vmem_unit->create_context(65536);
+        iu = std::make_unique<InstructionUnit>(vmem_unit, code_context_id, *stack,
+                                               std::make_shared<Flags>(), basic_io);
+        iu->set_data_context(data_context_id);
+        vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    }
+
+    void put_data(addr_t address, const std::string& bytes) {
+        auto data = vmem_unit->get_context(data_context_id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+        for (size_t i = 0; i < bytes.size(); ++i) {
+            data->write_byte(static_cast<addr_t>(address + i), static_cast<byte_t>(bytes[i]));
+        }
+    }
+
+    std::string get_data(addr_t address, size_t length) {
+        auto data = vmem_unit->get_context(data_context_id)->create_paged_accessor(MemAccessMode::READ_ONLY);
+        std::string bytes;
+        for (size_t i = 0; i < length; ++i) {
+            bytes += static_cast<char>(data->read_byte(static_cast<addr_t>(address + i)));
+        }
+        return bytes;
+    }
+
+    // Push arguments so the first one listed is popped first
+    void call(word_t syscall_number, std::initializer_list<word_t> args) {
+        auto s = stack->get_accessor(MemAccessMode::READ_WRITE);
+        std::vector<word_t> ordered(args);
+        for (auto it = ordered.rbegin(); it != ordered.rend(); ++it) {
+            s->push_word(*it);
+        }
+        iu->get_accessor(MemAccessMode::READ_WRITE)->system_call(syscall_number);
+    }
+
+    word_t pop() {
+        return stack->get_accessor(MemAccessMode::READ_WRITE)->pop_word();
+    }
+};
+
+TEST_F(HostTableSyscallTest, CreateInsertLookupDelete) {
+    put_data(0x100, "take");
+    put_data(0x110, "drop");
+
+    call(SYSCALL_TABLE_CREATE, {});
+    word_t handle = pop();
+    EXPECT_NE(handle, 0);
+
+    call(SYSCALL_TABLE_INSERT, {handle, 0x100, 4, 11});
+    call(SYSCALL_TABLE_INSERT, {handle, 0x110, 4, 22});
+
+    call(SYSCALL_TABLE_LOOKUP, {handle, 0x110, 4});
+    EXPECT_EQ(pop(), 1);    // found
+    EXPECT_EQ(pop(), 22);   // value
+
+    // Prefix of a key is a different key
+    call(SYSCALL_TABLE_LOOKUP, {handle, 0x100, 3});
+    EXPECT_EQ(pop(), 0);
+    EXPECT_EQ(pop(), 0);
+
+    call(SYSCALL_TABLE_DELETE, {handle, 0x100, 4});
+    EXPECT_EQ(pop(), 1);
+    call(SYSCALL_TABLE_DELETE, {handle, 0x100, 4});
+    EXPECT_EQ(pop(), 0);
+
+    call(SYSCALL_TABLE_DESTROY, {handle});
+    EXPECT_EQ(iu->host_tables().table_count(), 0u);
+    EXPECT_THROW(call(SYSCALL_TABLE_LOOKUP, {handle, 0x100, 4}), lvm::runtime_error);
+}
+
+TEST_F(HostTableSyscallTest, NextCopiesKeysIntoGuestBuffer) {
+    put_data(0x100, "lantern");
+    put_data(0x110, "rope");
+
+    call(SYSCALL_TABLE_CREATE, {});
+    word_t handle = pop();
+    call(SYSCALL_TABLE_INSERT, {handle, 0x100, 7, 5});
+    call(SYSCALL_TABLE_INSERT, {handle, 0x110, 4, 9});
+
+    std::set<std::pair<std::string, word_t>> seen;
+    word_t cursor = 0;
+    do {
+        call(SYSCALL_TABLE_NEXT, {handle, cursor, 0x200, 4});
+        cursor = pop();
+        word_t key_length = pop();
+        word_t value = pop();
+        if (cursor != 0) {
+            // Buffer holds at most 4 bytes; the full length is reported
+            seen.insert({get_data(0x200, std::min<word_t>(key_length, 4)) + "/" + std::to_string(key_length), value});
+        }
+    } while (cursor != 0);
+
+    EXPECT_EQ(seen, (std::set<std::pair<std::string, word_t>>{{"lant/7", 5}, {"rope/4", 9}}));
+}
+
+TEST_F(HostTableSyscallTest, LoadingAProgramDropsTables) {
+    call(SYSCALL_TABLE_CREATE, {});
+    pop();
+    EXPECT_EQ(iu->host_tables().table_count(), 1u);
+
+    std::vector<byte_t> program = {0x01};
+    iu->get_accessor(MemAccessMode::READ_WRITE)->Load_Program(program);
+    EXPECT_EQ(iu->host_tables().table_count(), 0u);
+}
@@ -1,15 +1,83 @@
 #include <iostream>
+#include <memory>
+#include <string>
 #include "lvm.h"
+#include "trace.h"
 
 int main(int argc, char** argv) {
     if(argc < 3){
-        std::cerr << "Usage: " << argv[0] << " <program file>" << " <load address>" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <program file>" << " <load address>"
+                  << " [--stream] [--archive <archive file>] [--swap <swap file> <max resident blocks>]"
+                  << " [--async-output <block|yield>] [--stack-size <bytes>] [--stack-release]"
+                  << " [--data-size <bytes>] [--trace <trace.json>]" << std::endl;
+        std::cerr << "  Program file '-' reads the image from standard input (implies --stream)" << std::endl;
+        std::cerr << "  With --archive, the program is the name of an archive member" << std::endl;
+        std::cerr << "  --stack-size reserves a larger stack; memory is committed only as it is used" << std::endl;
+        std::cerr << "  --stack-release hands stack memory back when the stack shrinks" << std::endl;
+        std::cerr << "  --data-size grows the data context past 64KB for linear addressing (LDX/STX)" << std::endl;
         return 1;
     }
     try {
-        lvm::vm virtual_machine(1024, 65536, 32768); // 1KB stack, 64KB code space, 32KB data space
-        virtual_machine.load_program(argv[1], argv[2] ? static_cast<lvm::addr_t>(std::stoi(argv[2])) : 0x0000);
+        // Tracing starts before the VM exists so context creation is captured,
+        // and the stack and data sizes are needed to build it
+        lvm::addr32_t stack_size = 1024;
+        lvm::addr32_t data_size = 65536;
+        for (int i = 3; i + 1 < argc; ++i) {
+            if (std::string(argv[i]) == "--trace") {
+                lvm::trace::start(argv[i + 1]);
+            } else if (std::string(argv[i]) == "--stack-size") {
+                stack_size = static_cast<lvm::addr32_t>(std::stoul(argv[i + 1]));
+            } else if (std::string(argv[i]) == "--data-size") {
+                data_size = static_cast<lvm::addr32_t>(std::stoul(argv[i + 1]));
+            }
+        }
+        lvm::vm virtual_machine(stack_size, 65536, data_size); // 64KB code space; 1KB stack and 64KB data unless sized above
+        bool streaming = std::string(argv[1]) == "-";
+        std::string archive_file;
+        for (int i = 3; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--stream") {
+                streaming = true;
+            } else if (arg == "--archive" && i + 1 < argc) {
+                archive_file = argv[++i];
+            } else if (arg == "--swap" && i + 2 < argc) {
+                virtual_machine.enable_swap(argv[i + 1], std::stoul(argv[i + 2]));
+                i += 2;
+            } else if (arg == "--async-output" && i + 1 < argc) {
+                std::string policy = argv[++i];
+                if (policy != "block" && policy != "yield") {
+                    std::cerr << "Unknown --async-output policy: " << policy << std::endl;
+                    return 1;
+                }
+                virtual_machine.enable_async_output(policy == "block" ? lvm::AsyncOutput::FullPolicy::BLOCK
+                                                                      : lvm::AsyncOutput::FullPolicy::YIELD);
+            } else if (arg == "--stack-release") {
+                virtual_machine.enable_stack_release();
+            } else if ((arg == "--trace" || arg == "--stack-size" || arg == "--data-size") && i + 1 < argc) {
+                ++i;    // already handled above
+            } else {
+                std::cerr << "Unknown option: " << arg << std::endl;
+                return 1;
+            }
+        }
+        lvm::addr_t load_address = argv[2] ? static_cast<lvm::addr_t>(std::stoi(argv[2])) : 0x0000;
+        std::unique_ptr<lvm::ProgramArchive> archive;
+        if (!archive_file.empty()) {
+            archive = std::make_unique<lvm::ProgramArchive>(archive_file);
+            auto member = archive->find(argv[1]);
+            if (!member) {
+                std::cerr << "No member '" << argv[1] << "' in archive " << archive_file << std::endl;
+                return 1;
+            }
+            virtual_machine.load_program(*member, load_address);
+        } else if (streaming) {
+            virtual_machine.load_program_streaming(argv[1], load_address);
+        } else {
+            virtual_machine.load_program(argv[1], load_address);
+        }
         virtual_machine.run();
+        // Guest EXIT status becomes the process status (low 8 bits on POSIX)
+        return virtual_machine.exit_status();
     } catch (const lvm::runtime_error& e) {
         std::cerr << "Runtime error: " << e.what() << std::endl;
         return 1;
@@ -0,0 +1,114 @@
+#include "block_codec.h"
+#include "errors.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdint>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace lvm;
+
+bool block_codec::block_is_zero(const byte_t* data, size_t size) {
+    size_t i = 0;
+#if defined(__SSE2__)
+    // OR 64 bytes per iteration together and test the accumulator once
+    __m128i acc = _mm_setzero_si128();
+    for (; i + 64 <= size; i += 64) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16));
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48));
+        acc = _mm_or_si128(acc, _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)));
+        // Bail out early every 1 KB so dirty blocks are rejected quickly
+        if ((i & 0x3FF) == 0x3C0 &&
+            _mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF) {
+            return false;
+        }
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, _mm_setzero_si128())) != 0xFFFF) {
+        return false;
+    }
+#endif
+    uint64_t acc64 = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        acc64 |= word;
+    }
+    for (; i < size; ++i) {
+        acc64 |= data[i];
+    }
+    return acc64 == 0;
+}
+
+bool block_codec::compress_block(const byte_t* data, size_t size, std::vector<byte_t>& out, size_t limit) {
+    std::vector<byte_t> encoded;
+    encoded.reserve(limit);
+
+    size_t literal_start = 0;
+    size_t i = 0;
+    auto flush_literals = [&](size_t end) {
+        while (literal_start < end) {
+            size_t count = std::min(end - literal_start, MAX_LITERAL_RUN);
+            encoded.push_back(static_cast<byte_t>(count - 1));
+            encoded.insert(encoded.end(), data + literal_start, data + literal_start + count);
+            literal_start += count;
+        }
+    };
+
+    while (i < size) {
+        size_t run = 1;
+        while (i + run < size && run < MAX_FILL_RUN && data[i + run] == data[i]) {
+            ++run;
+        }
+        if (run >= MIN_FILL_RUN) {
+            flush_literals(i);
+            encoded.push_back(static_cast<byte_t>(0x80 + (run - MIN_FILL_RUN)));
+            encoded.push_back(data[i]);
+            i += run;
+            literal_start = i;
+        } else {
+            i += run;
+        }
+        if (encoded.size() >= limit) {
+            return false;
+        }
+    }
+    flush_literals(size);
+    if (encoded.size() >= limit) {
+        return false;
+    }
+
+    encoded.shrink_to_fit();
+    out = std::move(encoded);
+    return true;
+}
+
+void block_codec::decompress_block(const std::vector<byte_t>& encoded, byte_t* out, size_t size) {
+    size_t pos = 0;
+    size_t written = 0;
+    while (pos < encoded.size()) {
+        byte_t token = encoded[pos++];
+        if (token & 0x80) {
+            size_t count = static_cast<size_t>(token - 0x80) + MIN_FILL_RUN;
+            if (pos >= encoded.size() || written + count > size) {
+                throw lvm::runtime_error("Corrupt compressed memory block");
+            }
+            std::memset(out + written, encoded[pos++], count);
+            written += count;
+        } else {
+            size_t count = static_cast<size_t>(token) + 1;
+            if (pos + count > encoded.size() || written + count > size) {
+                throw lvm::runtime_error("Corrupt compressed memory block");
+            }
+            std::memcpy(out + written, encoded.data() + pos, count);
+            pos += count;
+            written += count;
+        }
+    }
+    if (written != size) {
+        throw lvm::runtime_error("Corrupt compressed memory block");
+    }
+}
@@ -0,0 +1,163 @@
+#include "block_pool.h"
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <sys/mman.h>
+
+using namespace lvm;
+
+namespace {
+    struct SharedPool {
+        std::mutex mutex;
+        std::vector<byte_t*> fresh;
+        std::vector<byte_t*> dirty;
+        size_t slabs = 0;
+
+        // Caller holds mutex
+        void map_slab() {
+            void* slab = mmap(nullptr, BlockPool::SLAB_BLOCKS * BlockPool::BLOCK_SIZE,
+                              PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (slab == MAP_FAILED) {
+                throw std::bad_alloc();
+            }
+            ++slabs;
+            byte_t* base = static_cast<byte_t*>(slab);
+            // Reverse so blocks are handed out in address order
+            for (size_t i = BlockPool::SLAB_BLOCKS; i-- > 0;) {
+                fresh.push_back(base + i * BlockPool::BLOCK_SIZE);
+            }
+        }
+
+        // Caller holds mutex
+        void trim() {
+            while (dirty.size() > BlockPool::DIRTY_LIMIT) {
+                byte_t* block = dirty.back();
+                dirty.pop_back();
+                // Drops the page; the next touch maps a zero-filled one
+                madvise(block, BlockPool::BLOCK_SIZE, MADV_DONTNEED);
+                fresh.push_back(block);
+            }
+        }
+    };
+
+    // Never destroyed: thread caches may flush into it during exit
+    SharedPool& shared_pool() {
+        static SharedPool* pool = new SharedPool();
+        return *pool;
+    }
+
+    struct ThreadCache {
+        std::vector<byte_t*> fresh;
+        std::vector<byte_t*> dirty;
+
+        ThreadCache() {
+            fresh.reserve(2 * BlockPool::CACHE_BATCH);
+            dirty.reserve(2 * BlockPool::CACHE_BATCH + 1);
+        }
+        ~ThreadCache();
+
+        void refill() {
+            SharedPool& pool = shared_pool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            size_t wanted = BlockPool::CACHE_BATCH;
+            while (wanted > 0 && !pool.dirty.empty()) {
+                dirty.push_back(pool.dirty.back());
+                pool.dirty.pop_back();
+                --wanted;
+            }
+            while (wanted > 0) {
+                if (pool.fresh.empty()) {
+                    pool.map_slab();
+                }
+                fresh.push_back(pool.fresh.back());
+                pool.fresh.pop_back();
+                --wanted;
+            }
+        }
+
+        void spill() {
+            SharedPool& pool = shared_pool();
+            std::lock_guard<std::mutex> lock(pool.mutex);
+            pool.dirty.insert(pool.dirty.end(), dirty.end() - BlockPool::CACHE_BATCH, dirty.end());
+            dirty.resize(dirty.size() - BlockPool::CACHE_BATCH);
+            pool.trim();
+        }
+    };
+
+    thread_local ThreadCache cache;
+    // Stays readable after cache is destroyed at thread exit
+    thread_local bool cache_destroyed = false;
+
+    ThreadCache::~ThreadCache() {
+        cache_destroyed = true;
+        SharedPool& pool = shared_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        pool.fresh.insert(pool.fresh.end(), fresh.begin(), fresh.end());
+        pool.dirty.insert(pool.dirty.end(), dirty.begin(), dirty.end());
+        pool.trim();
+    }
+}
+
+byte_t* BlockPool::allocate(bool zeroed) {
+    if (cache_destroyed) {
+        // Thread is exiting: go straight to the shared pool
+        SharedPool& pool = shared_pool();
+        std::lock_guard<std::mutex> lock(pool.mutex);
+        if (pool.fresh.empty()) {
+            pool.map_slab();
+        }
+        byte_t* block = pool.fresh.back();
+        pool.fresh.pop_back();
+        return block;
+    }
+
+    if (cache.fresh.empty() && cache.dirty.empty()) {
+        cache.refill();
+    }
+    // Zeroed requests prefer fresh blocks; others use up dirty ones first
+    bool use_fresh = zeroed ? !cache.fresh.empty() : cache.dirty.empty();
+    std::vector<byte_t*>& source = use_fresh ? cache.fresh : cache.dirty;
+    byte_t* block = source.back();
+    source.pop_back();
+    if (zeroed && !use_fresh) {
+        std::memset(block, 0, BLOCK_SIZE);
+    }
+    return block;
+}
+
+void BlockPool::release(byte_t* block) {
+    if (cache_destroyed) {
+        release_batch({block});
+        return;
+    }
+    cache.dirty.push_back(block);
+    if (cache.dirty.size() > 2 * CACHE_BATCH) {
+        cache.spill();
+    }
+}
+
+void BlockPool::release_batch(const std::vector<byte_t*>& blocks) {
+    if (blocks.empty()) {
+        return;
+    }
+    SharedPool& pool = shared_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    pool.dirty.insert(pool.dirty.end(), blocks.begin(), blocks.end());
+    pool.trim();
+}
+
+BlockPool::Stats BlockPool::stats() {
+    SharedPool& pool = shared_pool();
+    std::lock_guard<std::mutex> lock(pool.mutex);
+    Stats stats;
+    stats.slabs = pool.slabs;
+    stats.fresh_blocks = pool.fresh.size();
+    stats.dirty_blocks = pool.dirty.size();
+    return stats;
+}
+
+BlockBuffer BlockBuffer::clone() const {
+    BlockBuffer copy = allocate(false);
+    std::memcpy(copy.data(), data_, BlockPool::BLOCK_SIZE);
+    return copy;
+}
@@ -0,0 +1,34 @@
+#ifndef BLOCK_CODEC_H
+#define BLOCK_CODEC_H
+
+#include "memsize.h"
+#include <cstddef>
+#include <vector>
+
+namespace lvm {
+
+// Block codec: helpers used by VMemUnit to shrink resident memory
+// - block_is_zero scans a block for any non-zero byte (SSE2 when available)
+// - compress_block/decompress_block implement a byte-oriented run-length
+//   codec tuned for guest memory (long zero/fill runs mixed with literals)
+//
+// Encoded stream is a sequence of tokens:
+//   0x00-0x7F  literal run, (token + 1) raw bytes follow
+//   0x80-0xFF  fill run, (token - 0x80 + MIN_FILL_RUN) copies of the next byte
+namespace block_codec {
+    static constexpr size_t MIN_FILL_RUN = 3;
+    static constexpr size_t MAX_FILL_RUN = 0x7F + MIN_FILL_RUN;
+    static constexpr size_t MAX_LITERAL_RUN = 0x80;
+
+    bool block_is_zero(const byte_t* data, size_t size);
+
+    // Returns false (leaving out untouched) if encoding would not fit in limit
+    bool compress_block(const byte_t* data, size_t size, std::vector<byte_t>& out, size_t limit);
+
+    // Throws lvm::runtime_error if the stream does not decode to exactly size bytes
+    void decompress_block(const std::vector<byte_t>& encoded, byte_t* out, size_t size);
+}
+
+}  // namespace lvm
+
+#endif // BLOCK_CODEC_H
@@ -0,0 +1,87 @@
+#ifndef BLOCK_POOL_H
+#define BLOCK_POOL_H
+
+#include "memsize.h"
+#include <cstddef>
+#include <vector>
+
+namespace lvm {
+
+    // BlockPool: process-wide allocator for fixed-size physical memory blocks
+    // - Blocks are carved from 256 KB anonymous mappings (slabs), so a block
+    //   that has never been handed out is already zero and needs no memset
+    // - Each thread keeps a small cache of free blocks and trades whole
+    //   batches with the shared pool, so the pool lock is taken once per
+    //   CACHE_BATCH allocations rather than once per block
+    // - Freed blocks are dirty; they are zeroed on reuse only when the caller
+    //   asks for a zeroed block. When the shared pool holds more dirty blocks
+    //   than it needs, the surplus is given back to the OS page by page and
+    //   returns as zero-filled pages on next use
+    // Slabs themselves are never unmapped.
+    class BlockPool {
+    public:
+        static constexpr size_t BLOCK_SIZE = 4096;
+        static constexpr size_t SLAB_BLOCKS = 64;
+        static constexpr size_t CACHE_BATCH = 32;
+        static constexpr size_t DIRTY_LIMIT = 1024;   // dirty blocks kept mapped in the shared pool
+
+        // Zeroed = false hands out a block with unspecified contents for
+        // callers that overwrite it entirely
+        static byte_t* allocate(bool zeroed);
+        static void release(byte_t* block);
+        // Return many blocks under a single lock (used when a unit is torn down)
+        static void release_batch(const std::vector<byte_t*>& blocks);
+
+        struct Stats {
+            size_t slabs = 0;
+            size_t fresh_blocks = 0;   // free in the shared pool and known to be zero
+            size_t dirty_blocks = 0;   // free in the shared pool, contents unspecified
+        };
+        static Stats stats();
+    };
+
+    // BlockBuffer: owning handle to one BlockPool block (empty when null)
+    class BlockBuffer {
+    public:
+        BlockBuffer() = default;
+        ~BlockBuffer() { reset(); }
+
+        static BlockBuffer allocate(bool zeroed = true) { return BlockBuffer(BlockPool::allocate(zeroed)); }
+        BlockBuffer clone() const;
+
+        BlockBuffer(const BlockBuffer&) = delete;
+        BlockBuffer& operator=(const BlockBuffer&) = delete;
+        BlockBuffer(BlockBuffer&& other) noexcept : data_(other.data_) { other.data_ = nullptr; }
+        BlockBuffer& operator=(BlockBuffer&& other) noexcept {
+            if (this != &other) {
+                reset();
+                data_ = other.data_;
+                other.data_ = nullptr;
+            }
+            return *this;
+        }
+
+        bool empty() const { return data_ == nullptr; }
+        byte_t* data() { return data_; }
+        const byte_t* data() const { return data_; }
+
+        void reset() {
+            if (data_) {
+                BlockPool::release(data_);
+                data_ = nullptr;
+            }
+        }
+        // Give up ownership without releasing (caller returns it to the pool)
+        byte_t* release() {
+            byte_t* block = data_;
+            data_ = nullptr;
+            return block;
+        }
+
+    private:
+        explicit BlockBuffer(byte_t* data) : data_(data) {}
+        byte_t* data_ = nullptr;
+    };
+}
+
+#endif // BLOCK_POOL_H
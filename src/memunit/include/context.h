@@ -37,7 +37,7 @@ public:
     
     // Create a Stack accessor for this context
     // - Only allowed in PROTECTED mode
-    // - Pre-allocates all physical memory for the stack
+    // - Memory is committed lazily (see StackMemoryAccessor::commit)
     // - Accessor should be used immediately and discarded, not stored
     std::unique_ptr<StackMemoryAccessor> create_stack_accessor() const;
 
@@ -32,6 +32,18 @@ namespace lvm {
         word_t read_word(addr_t offset) const;
         void write_word(addr_t offset, word_t value);
 
+        // Memory-operand instructions: the run is translated once
+        // - read_span copies size bytes starting at offset
+        // - write_span returns the bytes in place for a read-modify-write, or
+        //   nullptr if they straddle a block boundary (use byte access then)
+        void read_span(addr_t offset, byte_t* out, uint32_t size) const;
+        byte_t* write_span(addr_t offset, uint32_t size);
+
+        // Linear access: address indexes the whole context and the current
+        // page is neither used nor changed
+        void read_linear(uint32_t address, byte_t* out, uint32_t size) const;
+        void write_linear(uint32_t address, const byte_t* data, uint32_t size);
+
         // Bulk operations
         void bulk_read(addr_t offset, std::vector<byte_t>& buffer, memsize_t size) const;
         void bulk_write(addr_t offset, const std::vector<byte_t>& data);
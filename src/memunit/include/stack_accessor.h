@@ -14,7 +14,8 @@ namespace lvm {
 
     // StackMemoryAccessor: Provides direct 32-bit addressing for stack memory
     // - Uses simple 32-bit addressing (no page translation)
-    // - Pre-allocates all physical memory upfront
+    // - Commits physical memory lazily: the context only reserves capacity,
+    //   and blocks are allocated as the stack grows into them
     // - Provides byte and word read/write operations
     // - Designed for stack operations with predictable memory usage
     class StackMemoryAccessor {
@@ -29,6 +30,19 @@ namespace lvm {
         word_t read_word(addr32_t address) const;
         void write_word(addr32_t address, word_t value);
 
+        // Contiguous ranges (one bounds check and one lookup per range)
+        // - read_span copies size bytes starting at address
+        // - write_span returns the bytes in place, or nullptr if the range
+        //   crosses a block boundary (fall back to write_byte/write_word)
+        void read_span(addr32_t address, byte_t* out, uint32_t size) const;
+        byte_t* write_span(addr32_t address, uint32_t size);
+
+        // Backing memory
+        // - commit allocates the blocks covering [from, to) ahead of writes
+        // - release drops the blocks from the one holding address upward
+        void commit(addr32_t from, addr32_t to);
+        void release(addr32_t address);
+
         // Get context information
         context_id_t get_context_id() const { return context_id_; }
         addr32_t get_size() const { return size_; }
@@ -6,7 +6,13 @@
 #include "accessMode.h"
 #include "memsize.h"
 #include "ivmemunit.h"
+#include "block_pool.h"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
 #include <memory>
+#include <mutex>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -24,7 +30,7 @@ namespace lvm {
 class VMemUnit : public IVMemUnit {
 public:
     VMemUnit();
-    ~VMemUnit() = default;
+    ~VMemUnit();
     
     // Delete copy operations
     VMemUnit(const VMemUnit&) = delete;
@@ -50,12 +56,75 @@ public:
     // These are public so Context can create accessors in PROTECTED mode
     byte_t read_byte(context_id_t context_id, uint32_t address) const;
     void write_byte(context_id_t context_id, addr32_t address, byte_t value);
+
+    // Short runs of bytes with a single address translation (memory-operand
+    // instructions). The run must lie within the context.
+    // - read_range copies size bytes; unallocated memory reads as zero
+    // - write_range returns the bytes in place for a read-modify-write, or
+    //   nullptr if the run crosses a block boundary
+    void read_range(context_id_t context_id, uint32_t address, byte_t* out, uint32_t size) const;
+    byte_t* write_range(context_id_t context_id, uint32_t address, uint32_t size);
     
-    // Physical memory management - public for StackMemoryAccessor pre-allocation
+    // Physical memory management - public for StackMemoryAccessor commits
     void ensure_physical_memory(context_id_t context_id, addr32_t address);
+    // Drops every block of the context from the one holding address upward,
+    // whatever its state; the memory reads as zero again afterwards
+    void release_physical_memory(context_id_t context_id, addr32_t address);
     
     // Block size for memory allocation
-    static constexpr size_t BLOCK_SIZE = 4096;
+    static constexpr size_t BLOCK_SIZE = BlockPool::BLOCK_SIZE;
+
+    // Resident memory reclamation
+    // Each call advances a cursor over the blocks by at most max_blocks, so
+    // its cost does not grow with the guest's memory; a sweep ends when the
+    // cursor wraps. Blocks untouched for cold_after_sweeps consecutive sweeps
+    // are then reclaimed:
+    // - All-zero blocks are released back to the lazy-zero state
+    // - Others are compressed in place and decompressed on next access
+    struct ReclaimStats {
+        size_t zero_blocks_released = 0;
+        size_t blocks_compressed = 0;
+    };
+    struct MemoryStats {
+        size_t resident_blocks = 0;
+        size_t compressed_blocks = 0;
+        size_t swapped_blocks = 0;
+        size_t shared_blocks = 0;    // copy-on-write blocks shared with other units
+        size_t resident_bytes = 0;   // private blocks plus compressed images
+    };
+    static constexpr uint32_t DEFAULT_COLD_SWEEPS = 4;
+    ReclaimStats reclaim(uint32_t cold_after_sweeps = DEFAULT_COLD_SWEEPS, size_t max_blocks = SIZE_MAX);
+    MemoryStats memory_stats() const;
+
+    // Backing store (optional)
+    // Once enabled, whenever more than max_resident_blocks blocks are resident
+    // (private or shared) the least recently used ones (clock approximation)
+    // are written to a swap file and faulted back in on next access. The file
+    // is removed once neither this unit nor any fork of it refers to it.
+    void enable_swap(const std::string& path, size_t max_resident_blocks);
+    bool is_swap_enabled() const { return swap_ != nullptr; }
+
+    // Content-based deduplication across units
+    // Hashes every resident block of the given units and replaces identical
+    // blocks with one copy-on-write shared block; all-zero blocks are released
+    // outright. A write to a shared block gives the writer a private copy again.
+    // The units must not be executing while the merge pass runs.
+    struct DedupStats {
+        size_t blocks_scanned = 0;
+        size_t blocks_merged = 0;
+        size_t bytes_saved = 0;
+    };
+    static DedupStats merge_duplicate_blocks(const std::vector<VMemUnit*>& units);
+
+    // Copy-on-write fork
+    // Replaces this unit's contexts and memory with the parent's. Resident
+    // blocks become shared images referenced by both units, and swap slots
+    // and compressed images are shared by reference too, so the cost is one
+    // pointer per block whatever its state; the first write on either side
+    // takes a private copy. The child inherits the parent's swap file and
+    // resident budget. The parent must not be executing during the call;
+    // afterwards both units may run on different threads.
+    void fork_from(VMemUnit& parent);
 
 private:
     friend class lvm::PagedMemoryAccessor;
@@ -64,11 +133,94 @@ private:
     IVMemUnit::Mode mode_;
     context_id_t next_context_id_;
     vaddr_t next_free_address_;  // Next available address in virtual space
-    std::unordered_map<context_id_t, std::shared_ptr<Context>> contexts_;
+    // Context table indexed by id (ids are never reused); destroyed contexts
+    // leave an empty slot. Sized up front for a typical guest so the whole
+    // table is one allocation
+    static constexpr size_t INITIAL_CONTEXT_SLOTS = 4;
+    std::vector<std::shared_ptr<Context>> contexts_;
+    Context* find_context(context_id_t id) const;
+    // Context and its reference count in one allocation (Context's
+    // constructor is private, so make_shared cannot reach it directly)
+    struct ContextStorage;
     
+    // Swap file, shared by a unit and its forks; slots are handed out and
+    // read back under the mutex since those units may run on other threads
+    struct SwapFile {
+        std::mutex mutex;
+        std::fstream file;
+        std::string path;
+        std::vector<uint32_t> free_slots;
+        uint32_t next_slot = 0;
+        ~SwapFile();
+    };
+    // One slot holding a swapped block, freed when the last block referring
+    // to it (in this unit or a fork) is faulted in or released
+    struct SwapSlot {
+        std::shared_ptr<SwapFile> file;
+        uint32_t index;
+        SwapSlot(std::shared_ptr<SwapFile> file, uint32_t index) : file(std::move(file)), index(index) {}
+        ~SwapSlot();
+    };
+
     // Physical memory management
-    // Physical memory blocks: context_id -> (block_index -> data)
-    std::unordered_map<context_id_t, std::unordered_map<uint32_t, std::vector<byte_t>>> physical_memory_;
+    // A block is in exactly one state:
+    // - resident: data holds a private BlockPool block
+    // - shared: shared holds an image used by several blocks, never written
+    //   while more than one block refers to it
+    // - compressed: packed holds the encoded image
+    // - swapped: swapped names its slot in a swap file
+    // Resident and shared blocks count against the swap budget; shared
+    // images, compressed images and swap slots may be referenced from
+    // several units after a fork or a merge pass.
+    struct PhysicalBlock {
+        BlockBuffer data;
+        std::shared_ptr<BlockBuffer> shared;
+        std::shared_ptr<const std::vector<byte_t>> packed;
+        std::shared_ptr<SwapSlot> swapped;
+        uint32_t last_sweep = 0;   // reclaim sweep in which the block was last touched
+        uint32_t reclaim_slot = 0; // position in reclaim_ring_
+        bool referenced = false;   // clock bit, set on access
+        bool in_clock = false;     // has an entry in clock_ring_
+
+        bool resident() const { return !data.empty() || shared != nullptr; }
+        const byte_t* contents() const { return shared ? shared->data() : data.data(); }
+    };
+    // Physical memory blocks: context_id -> (block_index -> block)
+    // Mutable so reads can transparently decompress cold blocks
+    mutable std::unordered_map<context_id_t, std::unordered_map<uint32_t, PhysicalBlock>> physical_memory_;
+    uint32_t sweep_ = 0;
+
+    // Returns contents of a block for reading, decompressing or faulting it
+    // back in from swap if needed
+    const byte_t* touch_block(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) const;
+    // As touch_block, but also gives the block a private copy if it is shared
+    byte_t* touch_block_for_write(context_id_t context_id, uint32_t block_index, PhysicalBlock& block);
+
+    // Swap state: clock ring over resident blocks
+    struct BlockKey {
+        context_id_t context_id;
+        uint32_t block_index;
+    };
+    static constexpr uint32_t NO_BLOCK = UINT32_MAX;
+    std::shared_ptr<SwapFile> swap_;
+    size_t max_resident_blocks_ = 0;
+    mutable size_t resident_blocks_ = 0;
+    mutable std::vector<BlockKey> clock_ring_;
+    mutable size_t clock_hand_ = 0;
+
+    // Reclaim cursor: every block has exactly one entry in reclaim_ring_;
+    // entries before reclaim_hand_ were visited in the current sweep
+    std::vector<BlockKey> reclaim_ring_;
+    size_t reclaim_hand_ = 0;
+
+    PhysicalBlock* find_block(context_id_t context_id, uint32_t block_index) const;
+    void link_reclaim(context_id_t context_id, uint32_t block_index, PhysicalBlock& block);
+    void unlink_reclaim(const PhysicalBlock& block);
+    void mark_resident(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) const;
+    void evict_blocks(context_id_t keep_context, uint32_t keep_block) const;
+    void swap_out(PhysicalBlock& block) const;
+    void swap_in(PhysicalBlock& block) const;
+    void compact_clock_ring() const;
     
     // Allocate a region of virtual address space
     vaddr_t allocate_virtual_space(uint32_t size);
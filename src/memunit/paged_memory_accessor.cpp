@@ -2,6 +2,7 @@
 #include "vmemunit.h"
 #include "errors.h"
 #include "helpers.h"
+#include <algorithm>
 #include <stdexcept>
 
 using namespace lvm;
@@ -85,6 +86,59 @@ void PagedMemoryAccessor::write_word(addr_t offset, word_t value) {
     write_byte(offset + 1, high);
 }
 
+void PagedMemoryAccessor::read_span(addr_t offset, byte_t* out, uint32_t size) const {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot read from PagedMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    uint32_t address = page_offset_to_address(context_.get_current_page(), offset);
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    vmem.read_range(context_id_, address, out, size);
+}
+
+byte_t* PagedMemoryAccessor::write_span(addr_t offset, uint32_t size) {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot write to PagedMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    if (mode_ != MemAccessMode::READ_WRITE) {
+        throw lvm::runtime_error("Attempt to write to READ_ONLY memory");
+    }
+    
+    uint32_t address = page_offset_to_address(context_.get_current_page(), offset);
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    return vmem.write_range(context_id_, address, size);
+}
+
+void PagedMemoryAccessor::read_linear(uint32_t address, byte_t* out, uint32_t size) const {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot read from PagedMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    vmem.read_range(context_id_, address, out, size);
+}
+
+void PagedMemoryAccessor::write_linear(uint32_t address, const byte_t* data, uint32_t size) {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot write to PagedMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    if (mode_ != MemAccessMode::READ_WRITE) {
+        throw lvm::runtime_error("Attempt to write to READ_ONLY memory");
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    if (byte_t* bytes = vmem.write_range(context_id_, address, size)) {
+        std::copy(data, data + size, bytes);
+        return;
+    }
+    // Straddles a block boundary
+    for (uint32_t i = 0; i < size; ++i) {
+        vmem.write_byte(context_id_, address + i, data[i]);
+    }
+}
+
 void PagedMemoryAccessor::bulk_read(addr_t offset, std::vector<byte_t>& buffer, memsize_t size) const {
     if (!context_.vmem_unit_.is_protected()) {
         throw lvm::runtime_error("Cannot read from PagedMemoryAccessor while VMemUnit is in unprotected mode");
@@ -10,17 +10,8 @@ StackMemoryAccessor::StackMemoryAccessor(const Context& context)
     : context_(context),
       context_id_(context.get_id()),
       size_(context.get_size()) {
-    
-    // Pre-allocate all physical memory for the stack
-    // This ensures stack has guaranteed memory availability
-    // Access VMemUnit through Context
-    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
-    for (addr32_t addr = 0; addr < size_; ++addr) {
-        // Touch each block to ensure allocation
-        if (addr % VMemUnit::BLOCK_SIZE == 0) {
-            vmem.ensure_physical_memory(context_id_, addr);
-        }
-    }
+    // Nothing is allocated here: accessors are created per operation, and
+    // the stack commits blocks itself as SP advances (see commit)
 }
 
 byte_t StackMemoryAccessor::read_byte(addr32_t address) const {
@@ -79,3 +70,64 @@ void StackMemoryAccessor::write_word(addr32_t address, word_t value) {
     write_byte(address, low);
     write_byte(address + 1, high);
 }
+
+void StackMemoryAccessor::read_span(addr32_t address, byte_t* out, uint32_t size) const {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot read from StackMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    if (address >= size_ || size_ - address < size) {
+        throw std::runtime_error("Stack address out of bounds");
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    vmem.read_range(context_id_, address, out, size);
+}
+
+byte_t* StackMemoryAccessor::write_span(addr32_t address, uint32_t size) {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot write to StackMemoryAccessor while VMemUnit is in unprotected mode");
+    }
+    
+    if (address >= size_ || size_ - address < size) {
+        throw std::runtime_error("Stack address out of bounds");
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    return vmem.write_range(context_id_, address, size);
+}
+
+void StackMemoryAccessor::commit(addr32_t from, addr32_t to) {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot commit StackMemoryAccessor memory while VMemUnit is in unprotected mode");
+    }
+    
+    if (from >= to) {
+        return;
+    }
+    if (to > size_) {
+        throw std::runtime_error("Stack address out of bounds");
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    // Stepping by block start so a range ending at 4GB cannot wrap
+    for (addr32_t block = from - from % VMemUnit::BLOCK_SIZE;; block += VMemUnit::BLOCK_SIZE) {
+        vmem.ensure_physical_memory(context_id_, block);
+        if (to - block <= VMemUnit::BLOCK_SIZE) {
+            break;
+        }
+    }
+}
+
+void StackMemoryAccessor::release(addr32_t address) {
+    if (!context_.vmem_unit_.is_protected()) {
+        throw lvm::runtime_error("Cannot release StackMemoryAccessor memory while VMemUnit is in unprotected mode");
+    }
+    
+    if (address >= size_) {
+        return;
+    }
+    
+    VMemUnit& vmem = static_cast<VMemUnit&>(context_.vmem_unit_);
+    vmem.release_physical_memory(context_id_, address);
+}
@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include "block_codec.h"
+#include "errors.h"
+#include <vector>
+
+using namespace lvm;
+
+static constexpr size_t BLOCK = 4096;
+
+// Test zero detection including non-zero bytes in the scalar tail
+TEST(BlockCodecTest, ZeroDetection) {
+    std::vector<byte_t> block(BLOCK, 0);
+    EXPECT_TRUE(block_codec::block_is_zero(block.data(), block.size()));
+
+    for (size_t pos : {size_t(0), size_t(17), size_t(1000), BLOCK - 1}) {
+        block[pos] = 0x01;
+        EXPECT_FALSE(block_codec::block_is_zero(block.data(), block.size()));
+        block[pos] = 0x00;
+    }
+
+    std::vector<byte_t> odd(37, 0);
+    EXPECT_TRUE(block_codec::block_is_zero(odd.data(), odd.size()));
+    odd[36] = 0x80;
+    EXPECT_FALSE(block_codec::block_is_zero(odd.data(), odd.size()));
+}
+
+// Test round trip of mixed fill runs and literals
+TEST(BlockCodecTest, RoundTrip) {
+    std::vector<byte_t> block(BLOCK, 0);
+    for (size_t i = 0; i < 300; ++i) {
+        block[i] = static_cast<byte_t>(i * 7);
+    }
+    for (size_t i = 2000; i < 2002; ++i) {
+        block[i] = 0x55;   // run shorter than MIN_FILL_RUN
+    }
+    block[BLOCK - 1] = 0xFF;
+
+    std::vector<byte_t> encoded;
+    ASSERT_TRUE(block_codec::compress_block(block.data(), BLOCK, encoded, BLOCK / 2));
+    EXPECT_LT(encoded.size(), BLOCK / 2);
+
+    std::vector<byte_t> decoded(BLOCK, 0xCC);
+    block_codec::decompress_block(encoded, decoded.data(), BLOCK);
+    EXPECT_EQ(decoded, block);
+}
+
+// Test incompressible data is rejected against the limit
+TEST(BlockCodecTest, RejectsIncompressible) {
+    std::vector<byte_t> block(BLOCK);
+    for (size_t i = 0; i < BLOCK; ++i) {
+        block[i] = static_cast<byte_t>((i * 131) ^ (i >> 3));
+    }
+    std::vector<byte_t> encoded;
+    EXPECT_FALSE(block_codec::compress_block(block.data(), BLOCK, encoded, BLOCK / 2));
+    EXPECT_TRUE(encoded.empty());
+}
+
+// Test truncated streams are reported
+TEST(BlockCodecTest, CorruptStreamThrows) {
+    std::vector<byte_t> block(BLOCK, 0x11);
+    std::vector<byte_t> encoded;
+    ASSERT_TRUE(block_codec::compress_block(block.data(), BLOCK, encoded, BLOCK / 2));
+    encoded.pop_back();
+
+    std::vector<byte_t> decoded(BLOCK);
+    EXPECT_THROW(block_codec::decompress_block(encoded, decoded.data(), BLOCK), lvm::runtime_error);
+}
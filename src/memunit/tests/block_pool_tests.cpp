@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "block_pool.h"
+#include "block_codec.h"
+#include "vmemunit.h"
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <thread>
+#include <vector>
+
+using namespace lvm;
+
+static constexpr size_t BLOCK = BlockPool::BLOCK_SIZE;
+
+// Test that zeroed blocks are zero even when a dirty block is recycled
+TEST(BlockPoolTest, ZeroedAllocationAfterReuse) {
+    std::vector<BlockBuffer> blocks;
+    for (size_t i = 0; i < 3 * BlockPool::CACHE_BATCH; ++i) {
+        blocks.push_back(BlockBuffer::allocate());
+        ASSERT_TRUE(block_codec::block_is_zero(blocks.back().data(), BLOCK));
+        std::memset(blocks.back().data(), 0xAB, BLOCK);
+    }
+    blocks.clear();
+
+    for (size_t i = 0; i < 3 * BlockPool::CACHE_BATCH; ++i) {
+        blocks.push_back(BlockBuffer::allocate());
+        EXPECT_TRUE(block_codec::block_is_zero(blocks.back().data(), BLOCK));
+    }
+}
+
+// Test handle ownership: moves transfer, clones copy, reset empties
+TEST(BlockPoolTest, BufferOwnership) {
+    BlockBuffer a = BlockBuffer::allocate();
+    a.data()[0] = 7;
+    a.data()[BLOCK - 1] = 9;
+
+    BlockBuffer copy = a.clone();
+    EXPECT_NE(copy.data(), a.data());
+    EXPECT_EQ(std::memcmp(copy.data(), a.data(), BLOCK), 0);
+
+    byte_t* raw = a.data();
+    BlockBuffer b = std::move(a);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(b.data(), raw);
+
+    b.reset();
+    EXPECT_TRUE(b.empty());
+}
+
+// Test that concurrent threads never receive the same block twice
+TEST(BlockPoolTest, ThreadsGetDistinctBlocks) {
+    constexpr size_t THREADS = 4;
+    constexpr size_t PER_THREAD = 500;
+    std::vector<std::vector<byte_t*>> held(THREADS);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < THREADS; ++t) {
+        workers.emplace_back([&held, t] {
+            // Churn through the cache so blocks cross between threads
+            for (size_t round = 0; round < 4; ++round) {
+                std::vector<byte_t*> temp;
+                for (size_t i = 0; i < PER_THREAD; ++i) {
+                    temp.push_back(BlockPool::allocate(false));
+                    temp.back()[0] = static_cast<byte_t>(t);
+                }
+                for (byte_t* block : temp) {
+                    BlockPool::release(block);
+                }
+            }
+            for (size_t i = 0; i < PER_THREAD; ++i) {
+                held[t].push_back(BlockPool::allocate(true));
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    std::set<byte_t*> unique;
+    for (auto& blocks : held) {
+        for (byte_t* block : blocks) {
+            EXPECT_TRUE(block_codec::block_is_zero(block, BLOCK));
+            unique.insert(block);
+        }
+    }
+    EXPECT_EQ(unique.size(), THREADS * PER_THREAD);
+    for (auto& blocks : held) {
+        BlockPool::release_batch(blocks);
+    }
+}
+
+// Test that a surplus of dirty blocks is handed back as zero pages
+TEST(BlockPoolTest, BatchReleaseTrimsDirtySurplus) {
+    std::vector<byte_t*> blocks;
+    for (size_t i = 0; i < BlockPool::DIRTY_LIMIT + 200; ++i) {
+        blocks.push_back(BlockPool::allocate(false));
+        std::memset(blocks.back(), 0x5A, BLOCK);
+    }
+    BlockPool::release_batch(blocks);
+
+    auto stats = BlockPool::stats();
+    EXPECT_LE(stats.dirty_blocks, BlockPool::DIRTY_LIMIT);
+    EXPECT_GE(stats.fresh_blocks, 200u);
+    EXPECT_GT(stats.slabs, 0u);
+
+    // Trimmed blocks come back zero without a memset
+    size_t zero = 0;
+    for (byte_t* block : blocks) {
+        zero += block_codec::block_is_zero(block, BLOCK) ? 1 : 0;
+    }
+    EXPECT_GE(zero, 200u);
+}
+
+// Test that a unit's blocks go back to the pool when it is destroyed
+TEST(BlockPoolTest, UnitTeardownReturnsBlocks) {
+    auto before = BlockPool::stats();
+    {
+        VMemUnit unit;
+        context_id_t ctx = unit.create_context(64 * BLOCK);
+        unit.set_mode(IVMemUnit::Mode::PROTECTED);
+        for (uint32_t i = 0; i < 64; ++i) {
+            unit.write_byte(ctx, i * BLOCK, 1);
+        }
+        EXPECT_EQ(unit.memory_stats().resident_blocks, 64u);
+    }
+    auto after = BlockPool::stats();
+    EXPECT_GE(after.dirty_blocks + after.fresh_blocks, 64u);
+    EXPECT_LE(after.slabs, before.slabs + 2);
+}
@@ -4,6 +4,7 @@
 #include "paged_memory_accessor.h"
 #include "vaddr.h"
 #include "errors.h"
+#include <memory>
 #include <stdexcept>
 
 using namespace lvm;
@@ -201,6 +202,290 @@ TEST_F(VMemUnitTest, ContextBoundaryValidation) {
     EXPECT_THROW(accessor->write_byte(0, 0x00), std::runtime_error);
 }
 
+// Test zero blocks are released and read back as zero
+TEST_F(VMemUnitTest, ReclaimReleasesZeroBlocks) {
+    context_id_t id = memunit.create_context(0x4000);
+    auto ctx = memunit.get_context(id);
+
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0);
+    accessor->write_byte(0x0010, 0xAA);   // block 0, stays dirty
+    accessor->write_byte(0x1010, 0xBB);   // block 1, cleared below
+    accessor->write_byte(0x1010, 0x00);
+
+    // A freshly cleared block may be written again soon, so it is only
+    // released once it has been idle as long as a cold block
+    for (uint32_t sweep = 0; sweep < VMemUnit::DEFAULT_COLD_SWEEPS; ++sweep) {
+        EXPECT_EQ(memunit.reclaim().zero_blocks_released, 0u);
+        accessor->read_byte(0x0010);
+    }
+    auto stats = memunit.reclaim();
+    EXPECT_EQ(stats.zero_blocks_released, 1u);
+    EXPECT_EQ(stats.blocks_compressed, 0u);
+    EXPECT_EQ(memunit.memory_stats().resident_blocks, 1u);
+    EXPECT_EQ(accessor->read_byte(0x0010), 0xAA);
+    EXPECT_EQ(accessor->read_byte(0x1010), 0x00);
+}
+
+// Test a budgeted reclaim visits a bounded number of blocks per call
+TEST_F(VMemUnitTest, ReclaimAdvancesIncrementally) {
+    context_id_t id = memunit.create_context(0x8000);
+    auto ctx = memunit.get_context(id);
+
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0);
+    for (addr_t block = 0; block < 8; ++block) {
+        accessor->write_byte(static_cast<addr_t>(block * VMemUnit::BLOCK_SIZE), 0x00);
+    }
+    ASSERT_EQ(memunit.memory_stats().resident_blocks, 8u);
+
+    // The first sweep only ages the blocks; it ends when the cursor wraps
+    for (int step = 0; step < 4; ++step) {
+        EXPECT_EQ(memunit.reclaim(1, 2).zero_blocks_released, 0u);
+    }
+    memunit.reclaim(1, 2);
+
+    // Each later call releases at most its budget, resuming where the
+    // previous one stopped
+    size_t released = 0;
+    for (int step = 0; step < 4; ++step) {
+        size_t now = memunit.reclaim(1, 2).zero_blocks_released;
+        EXPECT_EQ(now, 2u);
+        released += now;
+        EXPECT_EQ(memunit.memory_stats().resident_blocks, 8u - released);
+    }
+    EXPECT_EQ(accessor->read_byte(0x7000), 0x00);
+}
+
+// Test idle blocks are compressed and transparently restored
+TEST_F(VMemUnitTest, ReclaimCompressesColdBlocks) {
+    context_id_t id = memunit.create_context(0x2000);
+    auto ctx = memunit.get_context(id);
+
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0);
+    for (addr_t i = 0; i < 64; ++i) {
+        accessor->write_byte(i, static_cast<byte_t>(i));
+    }
+    accessor->write_byte(0x1000, 0x01);
+
+    // Block 1 keeps being touched, block 0 goes cold
+    for (uint32_t sweep = 0; sweep < VMemUnit::DEFAULT_COLD_SWEEPS; ++sweep) {
+        EXPECT_EQ(memunit.reclaim().blocks_compressed, 0u);
+        accessor->read_byte(0x1000);
+    }
+    EXPECT_EQ(memunit.reclaim().blocks_compressed, 1u);
+
+    auto stats = memunit.memory_stats();
+    EXPECT_EQ(stats.compressed_blocks, 1u);
+    EXPECT_EQ(stats.resident_blocks, 1u);
+    EXPECT_LT(stats.resident_bytes, 2 * VMemUnit::BLOCK_SIZE);
+
+    // First access decompresses the block again
+    for (addr_t i = 0; i < 64; ++i) {
+        EXPECT_EQ(accessor->read_byte(i), static_cast<byte_t>(i));
+    }
+    accessor->write_byte(0x0FFF, 0x7E);
+    EXPECT_EQ(accessor->read_byte(0x0FFF), 0x7E);
+    EXPECT_EQ(memunit.memory_stats().compressed_blocks, 0u);
+}
+
+// Test blocks over the resident budget are swapped out and faulted back in
+TEST_F(VMemUnitTest, SwapEvictsAndFaultsBlocks) {
+    std::string swap_path = ::testing::TempDir() + "vmemunit_swap_test.bin";
+    memunit.enable_swap(swap_path, 2);
+    EXPECT_TRUE(memunit.is_swap_enabled());
+
+    context_id_t id = memunit.create_context(0x8000);
+    auto ctx = memunit.get_context(id);
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0);
+
+    // Touch eight blocks with distinct contents
+    for (addr_t block = 0; block < 8; ++block) {
+        accessor->write_byte(block * 0x1000, static_cast<byte_t>(0x10 + block));
+        accessor->write_byte(block * 0x1000 + 0xFFF, static_cast<byte_t>(0x80 + block));
+    }
+    auto stats = memunit.memory_stats();
+    EXPECT_LE(stats.resident_blocks, 2u);
+    EXPECT_EQ(stats.resident_blocks + stats.swapped_blocks, 8u);
+
+    // Every block comes back intact, in any order
+    for (addr_t block = 8; block-- > 0;) {
+        EXPECT_EQ(accessor->read_byte(block * 0x1000), 0x10 + block);
+        EXPECT_EQ(accessor->read_byte(block * 0x1000 + 0xFFF), 0x80 + block);
+    }
+    EXPECT_LE(memunit.memory_stats().resident_blocks, 2u);
+}
+
+// Test swap budget must be usable
+TEST_F(VMemUnitTest, SwapRejectsZeroBudget) {
+    EXPECT_THROW(memunit.enable_swap(::testing::TempDir() + "vmemunit_swap_zero.bin", 0),
+                 std::invalid_argument);
+    EXPECT_FALSE(memunit.is_swap_enabled());
+}
+
+// Test identical blocks are shared across units and unshared on write
+TEST_F(VMemUnitTest, MergeDuplicateBlocksAcrossUnits) {
+    lvm::VMemUnit other;
+    auto fill = [](VMemUnit& unit, byte_t tag) {
+        context_id_t id = unit.create_context(0x3000);
+        unit.set_mode(IVMemUnit::Mode::PROTECTED);
+        auto accessor = unit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+        accessor->set_page(0);
+        for (addr_t i = 0; i < 0x100; ++i) {
+            accessor->write_byte(i, static_cast<byte_t>(i));   // block 0: same in both
+        }
+        accessor->write_byte(0x1000, tag);                      // block 1: differs
+        accessor->write_byte(0x2000, 0x01);                     // block 2: cleared to zero
+        accessor->write_byte(0x2000, 0x00);
+        return accessor;
+    };
+    auto first = fill(memunit, 0xA1);
+    auto second = fill(other, 0xB2);
+
+    auto stats = VMemUnit::merge_duplicate_blocks({&memunit, &other});
+    EXPECT_EQ(stats.blocks_scanned, 6u);
+    EXPECT_EQ(stats.blocks_merged, 3u);    // one shared copy, two zero blocks
+    EXPECT_EQ(stats.bytes_saved, 3 * VMemUnit::BLOCK_SIZE);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 1u);
+    EXPECT_EQ(memunit.memory_stats().resident_blocks, 1u);
+    EXPECT_EQ(other.memory_stats().shared_blocks, 1u);
+
+    // Writing gives the writer a private copy, the other unit is unaffected
+    first->write_byte(0x0010, 0xEE);
+    EXPECT_EQ(first->read_byte(0x0010), 0xEE);
+    EXPECT_EQ(second->read_byte(0x0010), 0x10);
+    EXPECT_EQ(second->read_byte(0x1000), 0xB2);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 0u);
+
+    // The remaining owner takes the image back on its next write
+    second->write_byte(0x0011, 0xEF);
+    EXPECT_EQ(second->read_byte(0x0011), 0xEF);
+    EXPECT_EQ(first->read_byte(0x0011), 0x11);
+}
+
+// Test a fork shares every block copy-on-write with the parent
+TEST_F(VMemUnitTest, ForkSharesBlocksCopyOnWrite) {
+    context_id_t id = memunit.create_context(0x3000);
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto parent = memunit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    parent->set_page(0);
+    parent->write_byte(0x0010, 0x11);
+    parent->write_byte(0x1010, 0x22);
+
+    lvm::VMemUnit child_unit;
+    child_unit.fork_from(memunit);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 2u);
+    EXPECT_EQ(memunit.memory_stats().resident_blocks, 0u);
+    EXPECT_EQ(child_unit.memory_stats().shared_blocks, 2u);
+
+    child_unit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto child = child_unit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    child->set_page(0);
+    EXPECT_EQ(child->read_byte(0x0010), 0x11);
+    EXPECT_EQ(child->read_byte(0x1010), 0x22);
+
+    // Each side's writes stay private to it
+    child->write_byte(0x0010, 0x33);
+    EXPECT_EQ(child->read_byte(0x0010), 0x33);
+    EXPECT_EQ(parent->read_byte(0x0010), 0x11);
+    EXPECT_EQ(child_unit.memory_stats().resident_blocks, 1u);
+    parent->write_byte(0x1010, 0x44);
+    EXPECT_EQ(parent->read_byte(0x1010), 0x44);
+    EXPECT_EQ(child->read_byte(0x1010), 0x22);
+
+    // Block 0 is only the parent's now, so its write takes the image back
+    parent->write_byte(0x0011, 0x55);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 0u);
+    EXPECT_EQ(memunit.memory_stats().resident_blocks, 2u);
+}
+
+// Test a fork under a swap budget shares swapped blocks instead of faulting
+// them in, and keeps both units within the budget
+TEST_F(VMemUnitTest, ForkStaysWithinSwapBudget) {
+    auto parent_unit = std::make_unique<lvm::VMemUnit>();
+    parent_unit->enable_swap(::testing::TempDir() + "vmemunit_fork_swap.bin", 2);
+    context_id_t id = parent_unit->create_context(0x8000);
+    parent_unit->set_mode(IVMemUnit::Mode::PROTECTED);
+    auto parent = parent_unit->get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    parent->set_page(0);
+    for (addr_t block = 0; block < 8; ++block) {
+        parent->write_byte(block * 0x1000, static_cast<byte_t>(0x10 + block));
+    }
+    size_t swapped = parent_unit->memory_stats().swapped_blocks;
+    ASSERT_GE(swapped, 6u);
+
+    auto in_budget = [](const VMemUnit& unit) {
+        auto stats = unit.memory_stats();
+        return stats.resident_blocks + stats.shared_blocks <= 2;
+    };
+    lvm::VMemUnit child_unit;
+    child_unit.fork_from(*parent_unit);
+    EXPECT_TRUE(child_unit.is_swap_enabled());
+    EXPECT_EQ(parent_unit->memory_stats().swapped_blocks, swapped);
+    EXPECT_EQ(child_unit.memory_stats().swapped_blocks, swapped);
+    EXPECT_TRUE(in_budget(*parent_unit));
+    EXPECT_TRUE(in_budget(child_unit));
+
+    child_unit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto child = child_unit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    child->set_page(0);
+    for (addr_t block = 0; block < 8; ++block) {
+        child->write_byte(block * 0x1000 + 1, 0xC0);
+        EXPECT_TRUE(in_budget(child_unit));
+    }
+    for (addr_t block = 0; block < 8; ++block) {
+        EXPECT_EQ(parent->read_byte(block * 0x1000), 0x10 + block);
+        EXPECT_EQ(parent->read_byte(block * 0x1000 + 1), 0x00);
+        EXPECT_TRUE(in_budget(*parent_unit));
+    }
+
+    // The child's slots outlive the parent that created the swap file
+    parent.reset();
+    parent_unit.reset();
+    for (addr_t block = 0; block < 8; ++block) {
+        EXPECT_EQ(child->read_byte(block * 0x1000), 0x10 + block);
+        EXPECT_EQ(child->read_byte(block * 0x1000 + 1), 0xC0);
+    }
+    EXPECT_TRUE(in_budget(child_unit));
+}
+
+// Test shared images go cold and are compressed like private blocks
+TEST_F(VMemUnitTest, ReclaimCompressesSharedImages) {
+    context_id_t id = memunit.create_context(0x2000);
+    memunit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto parent = memunit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    parent->set_page(0);
+    parent->write_byte(0x0010, 0x11);
+    parent->write_byte(0x1010, 0x22);
+
+    lvm::VMemUnit child_unit;
+    child_unit.fork_from(memunit);
+    for (uint32_t sweep = 0; sweep <= VMemUnit::DEFAULT_COLD_SWEEPS; ++sweep) {
+        child_unit.reclaim();
+    }
+    auto stats = child_unit.memory_stats();
+    EXPECT_EQ(stats.shared_blocks, 0u);
+    EXPECT_EQ(stats.compressed_blocks, 2u);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 2u);
+
+    child_unit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto child = child_unit.get_context(id)->create_paged_accessor(MemAccessMode::READ_WRITE);
+    child->set_page(0);
+    EXPECT_EQ(child->read_byte(0x0010), 0x11);
+    EXPECT_EQ(child->read_byte(0x1010), 0x22);
+
+    // The parent is now the image's only owner and writes it in place
+    parent->write_byte(0x0010, 0x33);
+    EXPECT_EQ(memunit.memory_stats().shared_blocks, 1u);
+    EXPECT_EQ(child->read_byte(0x0010), 0x11);
+}
+
 // Test vaddr validation
 TEST(VAddrTest, Validation) {
     EXPECT_TRUE(is_valid_vaddr(0));
@@ -206,3 +206,78 @@ TEST_F(PagedMemoryAccessorTest, PageAddressTranslation) {
     accessor->set_page(0x0010);
     EXPECT_EQ(accessor->read_byte(0x0000), 0xCD);
 }
+
+// Spans used by memory-operand instructions
+TEST_F(PagedMemoryAccessorTest, SpansReadAndWriteInPlace) {
+    vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
+    auto ctx = vmem_unit.get_context(context_id);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0);
+    
+    // Unallocated memory reads as zero
+    byte_t bytes[2] = {0xFF, 0xFF};
+    accessor->read_span(0x0100, bytes, 2);
+    EXPECT_EQ(bytes[0], 0x00);
+    EXPECT_EQ(bytes[1], 0x00);
+    
+    byte_t* span = accessor->write_span(0x0100, 2);
+    ASSERT_NE(span, nullptr);
+    span[0] = 0x34;
+    span[1] = 0x12;
+    EXPECT_EQ(accessor->read_word(0x0100), 0x1234);
+    
+    accessor->read_span(0x0100, bytes, 2);
+    EXPECT_EQ(bytes[0], 0x34);
+    EXPECT_EQ(bytes[1], 0x12);
+    
+    // A run across a block boundary has no single span, but still reads
+    addr_t last = static_cast<addr_t>(VMemUnit::BLOCK_SIZE - 1);
+    EXPECT_EQ(accessor->write_span(last, 2), nullptr);
+    accessor->write_word(last, 0xBEEF);
+    accessor->read_span(last, bytes, 2);
+    EXPECT_EQ(bytes[0], 0xEF);
+    EXPECT_EQ(bytes[1], 0xBE);
+}
+
+TEST_F(PagedMemoryAccessorTest, WriteSpanRequiresReadWrite) {
+    vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
+    auto ctx = vmem_unit.get_context(context_id);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_ONLY);
+    
+    EXPECT_THROW(accessor->write_span(0x0000, 2), lvm::runtime_error);
+}
+
+// Linear access used by LDX/STX
+TEST_F(PagedMemoryAccessorTest, LinearAccessIgnoresCurrentPage) {
+    vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
+    auto ctx = vmem_unit.get_context(context_id);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    accessor->set_page(0x0007);
+    
+    const byte_t word[2] = {0x34, 0x12};
+    accessor->write_linear(0x00021000, word, 2);
+    EXPECT_EQ(accessor->get_page(), 0x0007);
+    
+    accessor->set_page(0x0002);
+    EXPECT_EQ(accessor->read_word(0x1000), 0x1234);
+    
+    // Runs across a block boundary are split, not rejected
+    uint32_t last = 3 * VMemUnit::BLOCK_SIZE - 1;
+    const byte_t straddling[2] = {0xEF, 0xBE};
+    accessor->write_linear(last, straddling, 2);
+    byte_t bytes[2] = {0, 0};
+    accessor->read_linear(last, bytes, 2);
+    EXPECT_EQ(bytes[0], 0xEF);
+    EXPECT_EQ(bytes[1], 0xBE);
+    
+    EXPECT_THROW(accessor->read_linear(4 * 1024 * 1024 - 1, bytes, 2), std::runtime_error);
+}
+
+TEST_F(PagedMemoryAccessorTest, WriteLinearRequiresReadWrite) {
+    vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
+    auto ctx = vmem_unit.get_context(context_id);
+    auto accessor = ctx->create_paged_accessor(MemAccessMode::READ_ONLY);
+    
+    const byte_t value = 0x01;
+    EXPECT_THROW(accessor->write_linear(0x00010000, &value, 1), lvm::runtime_error);
+}
@@ -135,18 +135,20 @@ TEST_F(StackMemoryAccessorTest, WordBoundsChecking) {
     EXPECT_THROW(accessor->read_word(size - 1), std::runtime_error);
 }
 
-// Test pre-allocation ensures all memory available
-TEST_F(StackMemoryAccessorTest, PreAllocationComplete) {
+// Test each block is committed on its first write and keeps what was written
+TEST_F(StackMemoryAccessorTest, BlocksCommitOnFirstWrite) {
     vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
     auto ctx = vmem_unit.get_context(context_id);
     auto accessor = ctx->create_stack_accessor();
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 0u);
     
-    // Should be able to write to any address without allocation delay
     // Test addresses across different blocks
     accessor->write_byte(0, 0x01);
     accessor->write_byte(4095, 0x02);   // End of first block
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 1u);
     accessor->write_byte(4096, 0x03);   // Start of second block
     accessor->write_byte(8192, 0x04);   // Start of third block
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 3u);
     
     EXPECT_EQ(accessor->read_byte(0), 0x01);
     EXPECT_EQ(accessor->read_byte(4095), 0x02);
@@ -154,7 +156,7 @@ TEST_F(StackMemoryAccessorTest, PreAllocationComplete) {
     EXPECT_EQ(accessor->read_byte(8192), 0x04);
 }
 
-// Test default read returns zero (from pre-allocated memory)
+// Test default read returns zero (uncommitted memory)
 TEST_F(StackMemoryAccessorTest, DefaultValueZero) {
     vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
     auto ctx = vmem_unit.get_context(context_id);
@@ -215,3 +217,24 @@ TEST_F(StackMemoryAccessorTest, SmallStackContext) {
     // Cannot access beyond bounds
     EXPECT_THROW(accessor->read_byte(1024), std::runtime_error);
 }
+
+// Test accessors commit nothing until asked, and release hands blocks back
+TEST_F(StackMemoryAccessorTest, CommitAndRelease) {
+    vmem_unit.set_mode(VMemUnit::Mode::PROTECTED);
+    auto ctx = vmem_unit.get_context(context_id);
+    auto accessor = ctx->create_stack_accessor();
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 0u);
+    
+    accessor->commit(0, 4097);
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 2u);
+    accessor->commit(100, 64 * 1024);
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 16u);
+    EXPECT_THROW(accessor->commit(0, 64 * 1024 + 1), std::runtime_error);
+    
+    accessor->write_byte(100, 0x42);
+    accessor->write_byte(8192, 0x43);
+    accessor->release(4096);
+    EXPECT_EQ(vmem_unit.memory_stats().resident_blocks, 1u);
+    EXPECT_EQ(accessor->read_byte(100), 0x42);
+    EXPECT_EQ(accessor->read_byte(8192), 0);
+}
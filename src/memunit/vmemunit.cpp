@@ -3,14 +3,53 @@
 #include "errors.h"
 #include "memsize.h"
 #include "accessMode.h"
+#include "block_codec.h"
+#include "trace.h"
+#include "probes.h"
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <filesystem>
 #include <stdexcept>
 
 using namespace lvm;
 
+struct lvm::VMemUnit::ContextStorage : Context {
+    ContextStorage(IVMemUnit& vmem_unit, context_id_t id, vaddr_t base_address, uint32_t size)
+        : Context(vmem_unit, id, base_address, size) {}
+};
+
 lvm::VMemUnit::VMemUnit()
     : mode_(IVMemUnit::Mode::UNPROTECTED),
       next_context_id_(0),
       next_free_address_(0) {
+    contexts_.reserve(INITIAL_CONTEXT_SLOTS);
+}
+
+lvm::VMemUnit::~VMemUnit() {
+    // Hand every private block back to the pool in one batch rather than
+    // one release per block as the maps are torn down
+    std::vector<byte_t*> blocks;
+    blocks.reserve(resident_blocks_);
+    for (auto& [context_id, context_blocks] : physical_memory_) {
+        for (auto& [index, block] : context_blocks) {
+            if (!block.data.empty()) {
+                blocks.push_back(block.data.release());
+            }
+        }
+    }
+    BlockPool::release_batch(blocks);
+}
+
+lvm::VMemUnit::SwapFile::~SwapFile() {
+    file.close();
+    std::error_code ec;
+    std::filesystem::remove(path, ec);
+}
+
+lvm::VMemUnit::SwapSlot::~SwapSlot() {
+    std::lock_guard<std::mutex> lock(file->mutex);
+    file->free_slots.push_back(index);
 }
 
 void lvm::VMemUnit::set_mode(IVMemUnit::Mode mode) {
@@ -18,6 +57,7 @@ void lvm::VMemUnit::set_mode(IVMemUnit::Mode mode) {
 }
 
 context_id_t lvm::VMemUnit::create_context(uint32_t size) {
+    trace::Span span("create_context", "memory", "size", size);
     // Context creation only allowed in unprotected mode
     if (is_protected()) {
         throw std::runtime_error("Cannot create context in PROTECTED mode");
@@ -35,9 +75,9 @@ context_id_t lvm::VMemUnit::create_context(uint32_t size) {
     // Allocate virtual space for the context
     vaddr_t base_address = allocate_virtual_space(size);
     
-    // Create the context (using shared_ptr since constructor is private)
+    // Create the context
     context_id_t id = next_context_id_++;
-    contexts_[id] = std::shared_ptr<Context>(new Context(*this, id, base_address, size));
+    contexts_.push_back(std::make_shared<ContextStorage>(*this, id, base_address, size));
     
     return id;
 }
@@ -48,27 +88,29 @@ void lvm::VMemUnit::destroy_context(context_id_t id) {
         throw std::runtime_error("Cannot destroy context in PROTECTED mode");
     }
     
-    auto it = contexts_.find(id);
-    if (it == contexts_.end()) {
+    if (!find_context(id)) {
         throw std::invalid_argument("Context ID does not exist");
     }
     
-    contexts_.erase(it);
+    contexts_[id].reset();
     // Note: In a complete implementation, we would free the virtual space
     // and any associated physical memory here
 }
 
+Context* lvm::VMemUnit::find_context(context_id_t id) const {
+    return id < contexts_.size() ? contexts_[id].get() : nullptr;
+}
+
 std::shared_ptr<Context> lvm::VMemUnit::get_context(context_id_t id) const {
-    auto it = contexts_.find(id);
-    if (it == contexts_.end()) {
+    if (!find_context(id)) {
         return nullptr;
     }
-    return it->second;
+    return contexts_[id];
 }
 
 std::shared_ptr<Context> lvm::VMemUnit::find_context_for_address(vaddr_t addr) const {
-    for (const auto& [id, context] : contexts_) {
-        if (context->contains(addr)) {
+    for (const auto& context : contexts_) {
+        if (context && context->contains(addr)) {
             return context;
         }
     }
@@ -95,19 +137,465 @@ void lvm::VMemUnit::ensure_physical_memory(context_id_t context_id, uint32_t add
     auto& context_blocks = physical_memory_[context_id];
     if (context_blocks.find(block_index) == context_blocks.end()) {
         // Allocate new block (initialized to zero)
-        context_blocks[block_index] = std::vector<byte_t>(BLOCK_SIZE, 0);
+        PhysicalBlock& block = context_blocks[block_index];
+        block.data = BlockBuffer::allocate();
+        block.last_sweep = sweep_;
+        link_reclaim(context_id, block_index, block);
+        mark_resident(context_id, block_index, block);
+        LVM_PROBE2(block_alloc, context_id, block_index);
+    }
+}
+
+void lvm::VMemUnit::release_physical_memory(context_id_t context_id, uint32_t address) {
+    auto mem_it = physical_memory_.find(context_id);
+    if (mem_it == physical_memory_.end()) {
+        return;
+    }
+    uint32_t first_block = get_block_index(address);
+    // Clock ring entries of released blocks are dropped as the hand passes them
+    std::erase_if(mem_it->second, [&](auto& entry) {
+        auto& [index, block] = entry;
+        if (index < first_block) {
+            return false;
+        }
+        unlink_reclaim(block);
+        if (block.resident()) {
+            --resident_blocks_;
+        }
+        return true;
+    });
+}
+
+lvm::VMemUnit::PhysicalBlock* lvm::VMemUnit::find_block(context_id_t context_id, uint32_t block_index) const {
+    auto mem_it = physical_memory_.find(context_id);
+    if (mem_it == physical_memory_.end()) {
+        return nullptr;
+    }
+    auto block_it = mem_it->second.find(block_index);
+    return block_it == mem_it->second.end() ? nullptr : &block_it->second;
+}
+
+void lvm::VMemUnit::link_reclaim(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) {
+    block.reclaim_slot = static_cast<uint32_t>(reclaim_ring_.size());
+    reclaim_ring_.push_back({context_id, block_index});
+}
+
+void lvm::VMemUnit::unlink_reclaim(const PhysicalBlock& block) {
+    // Fill the hole from the back of the ring. A hole in the visited part is
+    // first filled with the last visited entry, so no unvisited entry ends up
+    // behind the hand.
+    auto move_entry = [this](size_t from, size_t to) {
+        reclaim_ring_[to] = reclaim_ring_[from];
+        find_block(reclaim_ring_[to].context_id, reclaim_ring_[to].block_index)->reclaim_slot =
+            static_cast<uint32_t>(to);
+    };
+    size_t slot = block.reclaim_slot;
+    if (slot < reclaim_hand_) {
+        --reclaim_hand_;
+        if (slot != reclaim_hand_) {
+            move_entry(reclaim_hand_, slot);
+        }
+        slot = reclaim_hand_;
+    }
+    if (slot != reclaim_ring_.size() - 1) {
+        move_entry(reclaim_ring_.size() - 1, slot);
+    }
+    reclaim_ring_.pop_back();
+}
+
+const byte_t* lvm::VMemUnit::touch_block(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) const {
+    block.last_sweep = sweep_;
+    block.referenced = true;
+    if (block.shared) {
+        return block.shared->data();
+    }
+    if (block.data.empty()) {
+        if (block.swapped) {
+            swap_in(block);
+        } else {
+            // Cold block: inflate back to a full resident block
+            block.data = BlockBuffer::allocate(false);
+            block_codec::decompress_block(*block.packed, block.data.data(), BLOCK_SIZE);
+            block.packed.reset();
+        }
+        mark_resident(context_id, block_index, block);
+    }
+    return block.data.data();
+}
+
+byte_t* lvm::VMemUnit::touch_block_for_write(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) {
+    if (block.shared) {
+        // Copy on write: the other owners keep the shared image. The last
+        // owner takes the image back without copying.
+        if (block.shared.use_count() == 1) {
+            // Pairs with the release in the other owner's reset, so its
+            // reads of the image are done before this unit writes to it
+            std::atomic_thread_fence(std::memory_order_acquire);
+            block.data = std::move(*block.shared);
+        } else {
+            block.data = block.shared->clone();
+        }
+        block.shared.reset();
+        block.last_sweep = sweep_;
+        block.referenced = true;
+        return block.data.data();
+    }
+    return const_cast<byte_t*>(touch_block(context_id, block_index, block));
+}
+
+void lvm::VMemUnit::mark_resident(context_id_t context_id, uint32_t block_index, PhysicalBlock& block) const {
+    ++resident_blocks_;
+    if (!is_swap_enabled()) {
+        return;
+    }
+    if (!block.in_clock) {
+        clock_ring_.push_back({context_id, block_index});
+        block.in_clock = true;
+        // Entries of released or compressed blocks linger until the hand
+        // passes them; drop them once they outnumber the live ones
+        if (clock_ring_.size() > 2 * max_resident_blocks_) {
+            compact_clock_ring();
+        }
+    }
+    if (resident_blocks_ > max_resident_blocks_) {
+        evict_blocks(context_id, block_index);
+    }
+}
+
+void lvm::VMemUnit::enable_swap(const std::string& path, size_t max_resident_blocks) {
+    if (is_swap_enabled()) {
+        throw lvm::runtime_error("Swap is already enabled");
+    }
+    if (max_resident_blocks == 0) {
+        throw std::invalid_argument("Swap budget must allow at least one resident block");
+    }
+    auto swap = std::make_shared<SwapFile>();
+    swap->file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if (!swap->file.is_open()) {
+        throw lvm::runtime_error("Failed to open swap file: " + path);
+    }
+    swap->path = path;
+    swap_ = std::move(swap);
+    max_resident_blocks_ = max_resident_blocks;
+
+    // Blocks allocated before swap was enabled join the clock now
+    for (auto& [context_id, context_blocks] : physical_memory_) {
+        for (auto& [index, block] : context_blocks) {
+            if (block.resident()) {
+                clock_ring_.push_back({context_id, index});
+                block.in_clock = true;
+            }
+        }
+    }
+    if (resident_blocks_ > max_resident_blocks_) {
+        evict_blocks(0, NO_BLOCK);  // no block index matches, nothing is pinned
+    }
+}
+
+void lvm::VMemUnit::evict_blocks(context_id_t keep_context, uint32_t keep_block) const {
+    // Clock sweep: referenced blocks get a second chance, the first
+    // unreferenced one is evicted. Entries that are no longer resident
+    // (released or compressed) are dropped as the hand passes them.
+    auto drop_entry = [this](size_t pos) {
+        clock_ring_[pos] = clock_ring_.back();
+        clock_ring_.pop_back();
+    };
+    size_t passes = 0;
+    while (resident_blocks_ > max_resident_blocks_ && !clock_ring_.empty()) {
+        if (clock_hand_ >= clock_ring_.size()) {
+            clock_hand_ = 0;
+            // Every bit was cleared on the previous pass, so two passes
+            // without progress mean only the kept block is left
+            if (++passes > 2) {
+                break;
+            }
+        }
+        BlockKey key = clock_ring_[clock_hand_];
+        PhysicalBlock* block = find_block(key.context_id, key.block_index);
+        if (block == nullptr || !block->resident()) {
+            if (block != nullptr) {
+                block->in_clock = false;
+            }
+            drop_entry(clock_hand_);
+            continue;
+        }
+        if (key.context_id == keep_context && key.block_index == keep_block) {
+            ++clock_hand_;
+            continue;
+        }
+        if (block->referenced) {
+            block->referenced = false;
+            ++clock_hand_;
+            continue;
+        }
+        swap_out(*block);
+        block->in_clock = false;
+        drop_entry(clock_hand_);
+        --resident_blocks_;
+        passes = 0;
+    }
+}
+
+void lvm::VMemUnit::swap_out(PhysicalBlock& block) const {
+    // A shared image goes to this unit's slot; other owners keep their copy
+    SwapFile& swap = *swap_;
+    uint32_t slot;
+    {
+        std::lock_guard<std::mutex> lock(swap.mutex);
+        if (!swap.free_slots.empty()) {
+            slot = swap.free_slots.back();
+            swap.free_slots.pop_back();
+        } else {
+            slot = swap.next_slot++;
+        }
+        swap.file.seekp(static_cast<std::streamoff>(slot) * BLOCK_SIZE);
+        swap.file.write(reinterpret_cast<const char*>(block.contents()), BLOCK_SIZE);
+        if (!swap.file) {
+            swap.free_slots.push_back(slot);
+            throw lvm::runtime_error("Failed to write block to swap file");
+        }
+    }
+    block.swapped = std::make_shared<SwapSlot>(swap_, slot);
+    block.data.reset();
+    block.shared.reset();
+}
+
+void lvm::VMemUnit::swap_in(PhysicalBlock& block) const {
+    block.data = BlockBuffer::allocate(false);
+    SwapFile& swap = *block.swapped->file;
+    {
+        std::lock_guard<std::mutex> lock(swap.mutex);
+        swap.file.seekg(static_cast<std::streamoff>(block.swapped->index) * BLOCK_SIZE);
+        swap.file.read(reinterpret_cast<char*>(block.data.data()), BLOCK_SIZE);
+        if (!swap.file) {
+            swap.file.clear();
+            throw lvm::runtime_error("Failed to read block from swap file");
+        }
+    }
+    // The slot is freed once no fork still refers to it
+    block.swapped.reset();
+}
+
+void lvm::VMemUnit::compact_clock_ring() const {
+    std::erase_if(clock_ring_, [this](const BlockKey& key) {
+        PhysicalBlock* block = find_block(key.context_id, key.block_index);
+        if (block != nullptr && block->resident()) {
+            return false;
+        }
+        if (block != nullptr) {
+            block->in_clock = false;
+        }
+        return true;
+    });
+    if (clock_hand_ >= clock_ring_.size()) {
+        clock_hand_ = 0;
+    }
+}
+
+lvm::VMemUnit::ReclaimStats lvm::VMemUnit::reclaim(uint32_t cold_after_sweeps, size_t max_blocks) {
+    ReclaimStats stats;
+    for (size_t visited = 0; visited < max_blocks; ++visited) {
+        if (reclaim_hand_ >= reclaim_ring_.size()) {
+            reclaim_hand_ = 0;
+            ++sweep_;
+            break;
+        }
+        BlockKey key = reclaim_ring_[reclaim_hand_];
+        auto& context_blocks = physical_memory_[key.context_id];
+        auto it = context_blocks.find(key.block_index);
+        PhysicalBlock& block = it->second;
+        if (!block.resident() || sweep_ - block.last_sweep < cold_after_sweeps) {
+            ++reclaim_hand_;  // compressed, swapped out or in use
+            continue;
+        }
+        // Shared images are reclaimed like private blocks; only this
+        // unit's reference goes, other owners keep theirs
+        if (block_codec::block_is_zero(block.contents(), BLOCK_SIZE)) {
+            // Reads of absent blocks return 0, so dropping it is invisible
+            unlink_reclaim(block);
+            context_blocks.erase(it);
+            --resident_blocks_;
+            ++stats.zero_blocks_released;
+            continue;
+        }
+        // Only keep the compressed image if it at least halves the block
+        std::vector<byte_t> packed;
+        if (block_codec::compress_block(block.contents(), BLOCK_SIZE, packed, BLOCK_SIZE / 2)) {
+            block.packed = std::make_shared<const std::vector<byte_t>>(std::move(packed));
+            block.data.reset();
+            block.shared.reset();
+            --resident_blocks_;
+            ++stats.blocks_compressed;
+        } else {
+            block.last_sweep = sweep_;  // retry after another idle period
+        }
+        ++reclaim_hand_;
+    }
+    return stats;
+}
+
+lvm::VMemUnit::MemoryStats lvm::VMemUnit::memory_stats() const {
+    MemoryStats stats;
+    for (const auto& [context_id, context_blocks] : physical_memory_) {
+        for (const auto& [index, block] : context_blocks) {
+            if (block.shared) {
+                ++stats.shared_blocks;
+            } else if (block.swapped) {
+                ++stats.swapped_blocks;
+            } else if (block.data.empty()) {
+                ++stats.compressed_blocks;
+                stats.resident_bytes += block.packed->size();
+            } else {
+                ++stats.resident_blocks;
+                stats.resident_bytes += BLOCK_SIZE;
+            }
+        }
+    }
+    return stats;
+}
+
+namespace {
+    // FNV-1a over a whole block, used only to bucket candidates
+    uint64_t hash_block(const byte_t* data, size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ULL;
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= data[i];
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+}
+
+lvm::VMemUnit::DedupStats lvm::VMemUnit::merge_duplicate_blocks(const std::vector<VMemUnit*>& units) {
+    using SharedImage = std::shared_ptr<BlockBuffer>;
+    DedupStats stats;
+    std::unordered_map<uint64_t, std::vector<SharedImage>> images;
+
+    // Existing shared images are candidates too, so repeated passes converge
+    for (VMemUnit* unit : units) {
+        for (auto& [context_id, context_blocks] : unit->physical_memory_) {
+            for (auto& [index, block] : context_blocks) {
+                if (block.shared) {
+                    auto& bucket = images[hash_block(block.shared->data(), BLOCK_SIZE)];
+                    if (std::find(bucket.begin(), bucket.end(), block.shared) == bucket.end()) {
+                        bucket.push_back(block.shared);
+                    }
+                }
+            }
+        }
+    }
+
+    for (VMemUnit* unit : units) {
+        for (auto& [context_id, context_blocks] : unit->physical_memory_) {
+            for (auto it = context_blocks.begin(); it != context_blocks.end();) {
+                PhysicalBlock& block = it->second;
+                if (block.data.empty()) {
+                    ++it;  // compressed, swapped or already shared
+                    continue;
+                }
+                ++stats.blocks_scanned;
+                const byte_t* data = block.data.data();
+                if (block_codec::block_is_zero(data, BLOCK_SIZE)) {
+                    unit->unlink_reclaim(block);
+                    it = context_blocks.erase(it);
+                    --unit->resident_blocks_;
+                    ++stats.blocks_merged;
+                    stats.bytes_saved += BLOCK_SIZE;
+                    continue;
+                }
+
+                auto& bucket = images[hash_block(data, BLOCK_SIZE)];
+                auto match = std::find_if(bucket.begin(), bucket.end(), [data](const SharedImage& image) {
+                    return std::memcmp(image->data(), data, BLOCK_SIZE) == 0;
+                });
+                if (match != bucket.end()) {
+                    block.shared = *match;
+                    block.data.reset();
+                    ++stats.blocks_merged;
+                    stats.bytes_saved += BLOCK_SIZE;
+                } else {
+                    // First copy seen becomes the shared image; nothing saved yet
+                    block.shared = std::make_shared<BlockBuffer>(std::move(block.data));
+                    bucket.push_back(block.shared);
+                }
+                ++it;
+            }
+        }
+    }
+
+    // Images nobody else matched go back to being private blocks
+    images.clear();
+    for (VMemUnit* unit : units) {
+        for (auto& [context_id, context_blocks] : unit->physical_memory_) {
+            for (auto& [index, block] : context_blocks) {
+                if (block.shared && block.shared.use_count() == 1) {
+                    block.data = std::move(*block.shared);
+                    block.shared.reset();
+                }
+            }
+        }
+    }
+    return stats;
+}
+
+void lvm::VMemUnit::fork_from(VMemUnit& parent) {
+    trace::Span span("fork", "memory");
+    physical_memory_.clear();
+    resident_blocks_ = 0;
+    clock_ring_.clear();
+    clock_hand_ = 0;
+    reclaim_ring_.clear();
+    reclaim_hand_ = 0;
+    swap_ = parent.swap_;
+    max_resident_blocks_ = parent.max_resident_blocks_;
+
+    // Same ids, addresses and current pages, so the CPU, stack and
+    // instruction unit of the child address the same contexts
+    contexts_.clear();
+    contexts_.reserve(parent.contexts_.size());
+    for (const auto& context : parent.contexts_) {
+        if (!context) {
+            contexts_.push_back(nullptr);
+            continue;
+        }
+        auto copy = std::make_shared<ContextStorage>(*this, context->get_id(), context->get_base_address(),
+                                                     context->get_size());
+        copy->set_current_page(context->get_current_page());
+        contexts_.push_back(std::move(copy));
+    }
+    next_context_id_ = parent.next_context_id_;
+    next_free_address_ = parent.next_free_address_;
+
+    for (auto& [context_id, parent_blocks] : parent.physical_memory_) {
+        auto& context_blocks = physical_memory_[context_id];
+        context_blocks.reserve(parent_blocks.size());
+        for (auto& [index, block] : parent_blocks) {
+            // Still resident in the parent, now as a shared image
+            if (!block.data.empty()) {
+                block.shared = std::make_shared<BlockBuffer>(std::move(block.data));
+            }
+            PhysicalBlock& copy = context_blocks[index];
+            copy.shared = block.shared;
+            copy.packed = block.packed;
+            copy.swapped = block.swapped;
+            copy.last_sweep = sweep_;
+            link_reclaim(context_id, index, copy);
+            if (copy.resident()) {
+                mark_resident(context_id, index, copy);
+            }
+        }
     }
 }
 
 byte_t lvm::VMemUnit::read_byte(context_id_t context_id, uint32_t address) const {
     // Verify context exists
-    auto ctx_it = contexts_.find(context_id);
-    if (ctx_it == contexts_.end()) {
+    Context* context = find_context(context_id);
+    if (!context) {
         throw std::invalid_argument("Context ID does not exist");
     }
     
     // Validate address is within context bounds
-    if (address >= ctx_it->second->get_size()) {
+    if (address >= context->get_size()) {
         throw std::runtime_error("Address exceeds context size");
     }
     
@@ -127,18 +615,18 @@ byte_t lvm::VMemUnit::read_byte(context_id_t context_id, uint32_t address) const
         return 0;
     }
     
-    return block_it->second[block_offset];
+    return touch_block(context_id, block_index, block_it->second)[block_offset];
 }
 
 void lvm::VMemUnit::write_byte(context_id_t context_id, uint32_t address, byte_t value) {
     // Verify context exists
-    auto ctx_it = contexts_.find(context_id);
-    if (ctx_it == contexts_.end()) {
+    Context* context = find_context(context_id);
+    if (!context) {
         throw std::invalid_argument("Context ID does not exist");
     }
     
     // Validate address is within context bounds
-    if (address >= ctx_it->second->get_size()) {
+    if (address >= context->get_size()) {
         throw std::runtime_error("Address exceeds context size");
     }
     
@@ -148,5 +636,49 @@ void lvm::VMemUnit::write_byte(context_id_t context_id, uint32_t address, byte_t
     uint32_t block_index = get_block_index(address);
     uint32_t block_offset = get_block_offset(address);
     
-    physical_memory_[context_id][block_index][block_offset] = value;
+    touch_block_for_write(context_id, block_index, physical_memory_[context_id][block_index])[block_offset] = value;
+}
+
+void lvm::VMemUnit::read_range(context_id_t context_id, uint32_t address, byte_t* out, uint32_t size) const {
+    Context* context = find_context(context_id);
+    if (!context) {
+        throw std::invalid_argument("Context ID does not exist");
+    }
+    if (size == 0 || address >= context->get_size() || context->get_size() - address < size) {
+        throw std::runtime_error("Address exceeds context size");
+    }
+
+    uint32_t block_index = get_block_index(address);
+    uint32_t block_offset = get_block_offset(address);
+    if (block_index != get_block_index(address + size - 1)) {
+        for (uint32_t i = 0; i < size; ++i) {
+            out[i] = read_byte(context_id, address + i);
+        }
+        return;
+    }
+
+    PhysicalBlock* block = find_block(context_id, block_index);
+    if (!block) {
+        std::memset(out, 0, size);
+        return;
+    }
+    std::memcpy(out, touch_block(context_id, block_index, *block) + block_offset, size);
+}
+
+byte_t* lvm::VMemUnit::write_range(context_id_t context_id, uint32_t address, uint32_t size) {
+    Context* context = find_context(context_id);
+    if (!context) {
+        throw std::invalid_argument("Context ID does not exist");
+    }
+    if (size == 0 || address >= context->get_size() || context->get_size() - address < size) {
+        throw std::runtime_error("Address exceeds context size");
+    }
+
+    uint32_t block_index = get_block_index(address);
+    if (block_index != get_block_index(address + size - 1)) {
+        return nullptr;
+    }
+    ensure_physical_memory(context_id, address);
+    PhysicalBlock* block = find_block(context_id, block_index);
+    return touch_block_for_write(context_id, block_index, *block) + get_block_offset(address);
 }
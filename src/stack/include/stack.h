@@ -3,7 +3,8 @@
  * - Frame pointer (FP) acts as a movable bottom, preserving everything below it
  * - FP sits at -1 relative to the frame (first position is FP+1)
  * - Stack pointer (SP) points to the next free position
- * - Fixed capacity allocated at creation
+ * - Fixed capacity reserved at creation; blocks are committed as SP first
+ *   reaches them and, optionally, released again when the stack shrinks
  */
 
 #pragma once
@@ -44,6 +45,10 @@ namespace lvm {
         byte_t pop_byte();
         void push_word(word_t value);
         word_t pop_word();
+        // Several words at once: values[0] goes deepest, like count push_word
+        // calls in order; pop_words fills out the same way. All or nothing.
+        void push_words(const word_t* values, addr32_t count);
+        void pop_words(word_t* out, addr32_t count);
         
         // Frame management
         void set_frame_pointer(int32_t value);
@@ -81,6 +86,18 @@ namespace lvm {
         int32_t get_fp() const override { return fp_; }
         addr32_t get_capacity() const override { return capacity_; }
 
+        // High-water mark of committed backing memory (whole blocks)
+        addr32_t get_committed() const { return committed_; }
+        // Release committed blocks well above SP when the stack shrinks, so
+        // a deep recursion does not pin its peak memory for the guest's life.
+        // One block above SP's block is kept to avoid thrashing at a boundary.
+        void set_release_on_shrink(bool enabled) { release_on_shrink_ = enabled; }
+        bool release_on_shrink() const { return release_on_shrink_; }
+
+        // Take over SP, FP and the commit state of a forked parent; the
+        // contents come with the memory unit, which is forked separately
+        void fork_from(const Stack& parent);
+
     private:
         friend class StackAccessor;
 
@@ -89,6 +106,22 @@ namespace lvm {
         addr32_t capacity_;     // Maximum capacity in bytes
         addr32_t sp_;           // Stack pointer (points to next free position)
         int32_t fp_;            // Frame pointer (movable bottom, sits at -1 relative to frame)
+        addr32_t committed_ = 0;        // Bytes of backing memory committed (block multiple)
+        bool release_on_shrink_ = false;
+        
+        // Growth and shrink checks: one comparison on the fast path
+        void commit_to(addr32_t end) {
+            if (end > committed_) {
+                commit_blocks(end);
+            }
+        }
+        void shrink_check() {
+            if (release_on_shrink_ && committed_ - sp_ > 2 * VMemUnit::BLOCK_SIZE) {
+                release_blocks();
+            }
+        }
+        void commit_blocks(addr32_t end);
+        void release_blocks();
         
         // Internal operations (called by Stack_Accessor)
         void push_byte(byte_t value);
@@ -97,6 +130,8 @@ namespace lvm {
         void push_word(word_t value);
         word_t pop_word();
         word_t peek_word() const;
+        void push_words(const word_t* values, addr32_t count);
+        void pop_words(word_t* out, addr32_t count);
         
         byte_t peek_byte_from_base(addr32_t offset) const;
         word_t peek_word_from_base(addr32_t offset) const;
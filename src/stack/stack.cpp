@@ -1,6 +1,7 @@
 #include "stack.h"
 #include "errors.h"
 #include "helpers.h"
+#include <algorithm>
 #include <stdexcept>
 
 using namespace lvm;
@@ -21,6 +22,34 @@ Stack::Stack(std::shared_ptr<IVMemUnit> vmem_unit, addr32_t capacity)
     context_id_ = vmem_unit_->create_context(capacity);
 }
 
+void Stack::fork_from(const Stack& parent) {
+    if (parent.capacity_ != capacity_) {
+        throw lvm::runtime_error("Cannot fork a stack of a different capacity");
+    }
+    sp_ = parent.sp_;
+    fp_ = parent.fp_;
+    committed_ = parent.committed_;
+    release_on_shrink_ = parent.release_on_shrink_;
+}
+
+void Stack::commit_blocks(addr32_t end) {
+    auto ctx = vmem_unit_->get_context(context_id_);
+    auto accessor = ctx->create_stack_accessor();
+    accessor->commit(committed_, end);
+    // Round up to the block boundary, staying within the capacity
+    addr32_t block_end = end + (VMemUnit::BLOCK_SIZE - end % VMemUnit::BLOCK_SIZE) % VMemUnit::BLOCK_SIZE;
+    committed_ = block_end < end ? capacity_ : std::min(block_end, capacity_);
+}
+
+void Stack::release_blocks() {
+    // Keep SP's block and the one above it
+    addr32_t keep = sp_ - sp_ % VMemUnit::BLOCK_SIZE + 2 * VMemUnit::BLOCK_SIZE;
+    auto ctx = vmem_unit_->get_context(context_id_);
+    auto accessor = ctx->create_stack_accessor();
+    accessor->release(keep);
+    committed_ = keep;
+}
+
 std::unique_ptr<StackAccessor> Stack::get_accessor(MemAccessMode mode) {
     if (!vmem_unit_->is_protected()) {
         throw lvm::runtime_error("Stack accessor can only be created in PROTECTED mode");
@@ -34,6 +63,7 @@ void Stack::push_byte(byte_t value) {
         throw lvm::runtime_error("Stack overflow");
     }
     
+    commit_to(sp_ + 1);
     auto ctx = vmem_unit_->get_context(context_id_);
     auto accessor = ctx->create_stack_accessor();
     accessor->write_byte(sp_, value);
@@ -48,7 +78,9 @@ byte_t Stack::pop_byte() {
     sp_--;
     auto ctx = vmem_unit_->get_context(context_id_);
     auto accessor = ctx->create_stack_accessor();
-    return accessor->read_byte(sp_);
+    byte_t value = accessor->read_byte(sp_);
+    shrink_check();
+    return value;
 }
 
 byte_t Stack::peek_byte() const {
@@ -66,6 +98,7 @@ void Stack::push_word(word_t value) {
         throw lvm::runtime_error("Stack overflow");
     }
     
+    commit_to(sp_ + 2);
     auto ctx = vmem_unit_->get_context(context_id_);
     auto accessor = ctx->create_stack_accessor();
     accessor->write_word(sp_, value);
@@ -80,7 +113,58 @@ word_t Stack::pop_word() {
     sp_ -= 2;
     auto ctx = vmem_unit_->get_context(context_id_);
     auto accessor = ctx->create_stack_accessor();
-    return accessor->read_word(sp_);
+    word_t value = accessor->read_word(sp_);
+    shrink_check();
+    return value;
+}
+
+void Stack::push_words(const word_t* values, addr32_t count) {
+    addr32_t size = count * sizeof(word_t);
+    if (size == 0) {
+        return;
+    }
+    if (sp_ + size > capacity_) {
+        throw lvm::runtime_error("Stack overflow");
+    }
+    
+    commit_to(sp_ + size);
+    auto ctx = vmem_unit_->get_context(context_id_);
+    auto accessor = ctx->create_stack_accessor();
+    if (byte_t* bytes = accessor->write_span(sp_, size)) {
+        for (addr32_t i = 0; i < count; ++i) {
+            bytes[2 * i] = static_cast<byte_t>(values[i] & 0xFF);
+            bytes[2 * i + 1] = static_cast<byte_t>(values[i] >> 8);
+        }
+    } else {
+        // Run straddles two blocks
+        for (addr32_t i = 0; i < count; ++i) {
+            accessor->write_word(sp_ + 2 * i, values[i]);
+        }
+    }
+    sp_ += size;
+}
+
+void Stack::pop_words(word_t* out, addr32_t count) {
+    addr32_t size = count * sizeof(word_t);
+    if (size == 0) {
+        return;
+    }
+    if (sp_ < static_cast<addr32_t>(fp_ + 1) + size) {
+        throw lvm::runtime_error("Stack underflow");
+    }
+    
+    auto ctx = vmem_unit_->get_context(context_id_);
+    auto accessor = ctx->create_stack_accessor();
+    // Read the little-endian bytes into out, then widen each word in place.
+    // SP only moves once the read has succeeded.
+    byte_t* bytes = reinterpret_cast<byte_t*>(out);
+    accessor->read_span(sp_ - size, bytes, size);
+    for (addr32_t i = 0; i < count; ++i) {
+        word_t value = combine_bytes_to_word(bytes[2 * i + 1], bytes[2 * i]);
+        out[i] = value;
+    }
+    sp_ -= size;
+    shrink_check();
 }
 
 word_t Stack::peek_word() const {
@@ -175,6 +259,7 @@ void Stack::flush() {
     // Flush only the current frame - reset sp_ to the start of the frame
     // Frame starts at fp_ + 1, so we set sp_ to that position
     sp_ = static_cast<addr32_t>(fp_ + 1);
+    shrink_check();
 }
 
 // Stack_Accessor implementation
@@ -238,6 +323,20 @@ void StackAccessor::push_byte(byte_t value) {
     stack_ref->push_byte(value);
 }
 
+void StackAccessor::push_words(const word_t* values, addr32_t count) {
+    if (mode != MemAccessMode::READ_WRITE) {
+        throw lvm::runtime_error("Attempt to push to READ_ONLY stack");
+    }
+    stack_ref->push_words(values, count);
+}
+
+void StackAccessor::pop_words(word_t* out, addr32_t count) {
+    if (mode != MemAccessMode::READ_WRITE) {
+        throw lvm::runtime_error("Attempt to pop from READ_ONLY stack");
+    }
+    stack_ref->pop_words(out, count);
+}
+
 byte_t StackAccessor::pop_byte() {
     if (mode != MemAccessMode::READ_WRITE) {
         throw lvm::runtime_error("Attempt to pop from READ_ONLY stack");
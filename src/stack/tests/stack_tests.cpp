@@ -297,3 +297,120 @@ TEST_F(StackNewTest, PeekWordFromFrame) {
     // Frame offset 3 accesses address 4-5
     EXPECT_EQ(accessor->peek_word_from_frame(3), 0xCCCC);
 }
+
+// Test multi-word push/pop matches single pushes and pops
+TEST_F(StackNewTest, PushWordsMatchesPushWord) {
+    Stack stack(vmem_unit, 1024);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    auto accessor = stack.get_accessor(MemAccessMode::READ_WRITE);
+    
+    const word_t values[] = {0x1111, 0x2233, 0x4455};
+    accessor->push_byte(0x99);
+    accessor->push_words(values, 3);
+    
+    EXPECT_EQ(accessor->get_sp(), 7);
+    EXPECT_EQ(accessor->peek_word_from_base(1), 0x1111);
+    EXPECT_EQ(accessor->peek_word_from_base(5), 0x4455);
+    EXPECT_EQ(accessor->pop_word(), 0x4455);
+    
+    accessor->push_word(0x6677);
+    word_t out[3] = {};
+    accessor->pop_words(out, 3);
+    EXPECT_EQ(out[0], 0x1111);
+    EXPECT_EQ(out[1], 0x2233);
+    EXPECT_EQ(out[2], 0x6677);
+    EXPECT_EQ(accessor->get_sp(), 1);
+}
+
+// Test multi-word bounds are checked once, before anything moves
+TEST_F(StackNewTest, MultiWordBoundsAreAllOrNothing) {
+    Stack stack(vmem_unit, 6);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    auto accessor = stack.get_accessor(MemAccessMode::READ_WRITE);
+    
+    const word_t values[] = {1, 2, 3, 4};
+    EXPECT_THROW(accessor->push_words(values, 4), lvm::runtime_error);
+    EXPECT_EQ(accessor->get_sp(), 0);
+    
+    accessor->push_words(values, 2);
+    word_t out[3] = {};
+    EXPECT_THROW(accessor->pop_words(out, 3), lvm::runtime_error);
+    EXPECT_EQ(accessor->get_sp(), 4);
+
+    // Failing to reach the stack memory leaves SP where it was too
+    vmem_unit->set_mode(VMemUnit::Mode::UNPROTECTED);
+    EXPECT_THROW(accessor->pop_words(out, 2), std::runtime_error);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    EXPECT_EQ(accessor->get_sp(), 4);
+    accessor->pop_words(out, 2);
+    EXPECT_EQ(out[0], 1);
+    EXPECT_EQ(out[1], 2);
+}
+
+// Test a run of words across a memory block boundary
+TEST_F(StackNewTest, PushWordsAcrossBlockBoundary) {
+    Stack stack(vmem_unit, VMemUnit::BLOCK_SIZE * 2);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    auto accessor = stack.get_accessor(MemAccessMode::READ_WRITE);
+    
+    for (addr32_t i = 0; i + 1 < VMemUnit::BLOCK_SIZE; ++i) {
+        accessor->push_byte(0);
+    }
+    const word_t values[] = {0xABCD, 0x1234};
+    accessor->push_words(values, 2);
+    
+    word_t out[2] = {};
+    accessor->pop_words(out, 2);
+    EXPECT_EQ(out[0], 0xABCD);
+    EXPECT_EQ(out[1], 0x1234);
+}
+
+// Test a large stack commits blocks only as SP reaches them
+TEST_F(StackNewTest, LargeStackCommitsLazily) {
+    Stack stack(vmem_unit, 16 * 1024 * 1024);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    auto accessor = stack.get_accessor(MemAccessMode::READ_WRITE);
+    EXPECT_EQ(vmem_unit->memory_stats().resident_blocks, 0u);
+    
+    accessor->push_word(0x1234);
+    EXPECT_EQ(stack.get_committed(), VMemUnit::BLOCK_SIZE);
+    for (addr32_t i = 0; i < VMemUnit::BLOCK_SIZE; i += 2) {
+        accessor->push_word(0);
+    }
+    EXPECT_EQ(stack.get_committed(), 2 * VMemUnit::BLOCK_SIZE);
+    EXPECT_EQ(vmem_unit->memory_stats().resident_blocks, 2u);
+}
+
+// Test committed blocks well above SP are released only when asked to
+TEST_F(StackNewTest, ReleaseOnShrink) {
+    Stack stack(vmem_unit, 16 * VMemUnit::BLOCK_SIZE);
+    vmem_unit->set_mode(VMemUnit::Mode::PROTECTED);
+    auto accessor = stack.get_accessor(MemAccessMode::READ_WRITE);
+    
+    accessor->push_word(0xBEEF);
+    for (addr32_t i = 2; i < 8 * VMemUnit::BLOCK_SIZE; i += 2) {
+        accessor->push_word(static_cast<word_t>(i));
+    }
+    EXPECT_EQ(vmem_unit->memory_stats().resident_blocks, 8u);
+    
+    // Without release the high-water mark stays committed
+    while (accessor->get_sp() > 6 * VMemUnit::BLOCK_SIZE) {
+        accessor->pop_word();
+    }
+    EXPECT_EQ(stack.get_committed(), 8 * VMemUnit::BLOCK_SIZE);
+    
+    // SP's block and the one above it stay; the rest goes back
+    stack.set_release_on_shrink(true);
+    accessor->flush();
+    EXPECT_EQ(accessor->get_sp(), 0u);
+    EXPECT_EQ(stack.get_committed(), 2 * VMemUnit::BLOCK_SIZE);
+    EXPECT_EQ(vmem_unit->memory_stats().resident_blocks, 2u);
+    
+    // Growing again commits fresh blocks
+    accessor->push_word(0xBEEF);
+    for (addr32_t i = 2; i < 4 * VMemUnit::BLOCK_SIZE; i += 2) {
+        accessor->push_word(static_cast<word_t>(i));
+    }
+    EXPECT_EQ(accessor->pop_word(), static_cast<word_t>(4 * VMemUnit::BLOCK_SIZE - 2));
+    EXPECT_EQ(accessor->peek_word_from_base(0), 0xBEEF);
+}
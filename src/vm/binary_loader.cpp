@@ -72,6 +72,13 @@ BinaryProgram BinaryLoader::load_from_bytes(const std::vector<byte_t>& data) {
     return program;
 }
 
+BinaryHeader BinaryLoader::load_header(const std::vector<byte_t>& data) {
+    size_t offset = 0;
+    BinaryHeader header = parse_header(data.data(), data.size(), offset);
+    validate_header(header);
+    return header;
+}
+
 BinaryHeader BinaryLoader::parse_header(const byte_t* data, size_t data_size, size_t& offset) {
     BinaryHeader header;
     
@@ -0,0 +1,212 @@
+#include "guest_scheduler.h"
+#include "trace.h"
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+using namespace lvm;
+
+GuestScheduler::GuestScheduler(unsigned threads, uint32_t quantum)
+    : quantum_(std::max(quantum, 1u)), thread_count_(std::max(threads, 1u)) {}
+
+GuestScheduler::GuestId GuestScheduler::add(vm& machine, uint32_t weight, int priority) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    GuestId id = guests_.size();
+    guests_.push_back(std::make_unique<Guest>(machine, std::max(weight, 1u), priority));
+    ++unfinished_;
+    make_ready(id, Clock::now(), false);
+    return id;
+}
+
+void GuestScheduler::run() {
+    trace::Span span("schedule", "vm");
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        started_ = Clock::now();
+        last_poll_ = started_;
+        last_dedup_ = started_;
+        for (auto& [priority, queue] : ready_) {
+            for (GuestId id : queue) {
+                guests_[id]->ready_since = started_;
+            }
+        }
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(thread_count_);
+    for (unsigned i = 0; i < thread_count_; ++i) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void GuestScheduler::wake() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        wake_requested_ = true;
+    }
+    changed_.notify_all();
+}
+
+void GuestScheduler::set_dedup_interval(Clock::duration interval) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    dedup_interval_ = interval;
+}
+
+VMemUnit::DedupStats GuestScheduler::dedup_stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dedup_totals_;
+}
+
+uint64_t GuestScheduler::dedup_passes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dedup_passes_;
+}
+
+std::vector<GuestScheduler::GuestStats> GuestScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint64_t total = 0;
+    for (const auto& guest : guests_) {
+        total += guest->stats.instructions;
+    }
+    std::vector<GuestStats> result;
+    result.reserve(guests_.size());
+    for (const auto& guest : guests_) {
+        result.push_back(guest->stats);
+        if (total != 0) {
+            result.back().cpu_share = static_cast<double>(guest->stats.instructions) / static_cast<double>(total);
+        }
+    }
+    return result;
+}
+
+void GuestScheduler::make_ready(GuestId id, Clock::time_point now, bool continue_turn) {
+    Guest& guest = *guests_[id];
+    guest.ready_since = now;
+    auto& queue = ready_[guest.priority];
+    // A guest with instructions left in its turn keeps its place at the head
+    if (continue_turn) {
+        queue.push_front(id);
+    } else {
+        queue.push_back(id);
+    }
+}
+
+void GuestScheduler::poll_parked(Clock::time_point now) {
+    last_poll_ = now;
+    wake_requested_ = false;
+    auto still_parked = std::remove_if(parked_.begin(), parked_.end(), [&](GuestId id) {
+        if (!guests_[id]->machine->input_ready()) {
+            return false;
+        }
+        make_ready(id, now, false);
+        return true;
+    });
+    parked_.erase(still_parked, parked_.end());
+}
+
+void GuestScheduler::merge_idle_memory(Clock::time_point now) {
+    last_dedup_ = now;
+    std::vector<vm*> idle;
+    for (const auto& guest : guests_) {
+        if (!guest->running && !guest->stats.finished) {
+            idle.push_back(guest->machine);
+        }
+    }
+    if (idle.empty()) {
+        return;
+    }
+    // Workers pick guests under the lock held here, so none of these can
+    // start a slice until the pass is over
+    auto stats = vm::merge_duplicate_memory(idle);
+    dedup_totals_.blocks_scanned += stats.blocks_scanned;
+    dedup_totals_.blocks_merged += stats.blocks_merged;
+    dedup_totals_.bytes_saved += stats.bytes_saved;
+    ++dedup_passes_;
+}
+
+void GuestScheduler::finish(Guest& guest, Clock::time_point now, word_t exit_status) {
+    guest.deficit = 0;
+    guest.stats.finished = true;
+    guest.stats.exit_status = exit_status;
+    guest.stats.turnaround = now - started_;
+    --unfinished_;
+}
+
+void GuestScheduler::worker_loop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    for (;;) {
+        if (unfinished_ == 0) {
+            changed_.notify_all();
+            return;
+        }
+        auto now = Clock::now();
+        if (!parked_.empty() && (wake_requested_ || now - last_poll_ >= PARK_POLL_INTERVAL)) {
+            poll_parked(now);
+        }
+        if (dedup_interval_ != Clock::duration::zero() && now - last_dedup_ >= dedup_interval_) {
+            merge_idle_memory(now);
+        }
+        auto level = std::find_if(ready_.begin(), ready_.end(), [](const auto& entry) { return !entry.second.empty(); });
+        if (level == ready_.end()) {
+            // Everything left is running elsewhere or parked
+            changed_.wait_for(lock, PARK_POLL_INTERVAL);
+            continue;
+        }
+        GuestId id = level->second.front();
+        level->second.pop_front();
+        Guest& guest = *guests_[id];
+        if (guest.deficit == 0) {
+            guest.deficit = static_cast<uint64_t>(quantum_) * guest.weight;
+        }
+        uint64_t budget = std::min<uint64_t>(guest.deficit, quantum_);
+        auto latency = now - guest.ready_since;
+        guest.stats.max_ready_latency = std::max(guest.stats.max_ready_latency, latency);
+        guest.stats.total_ready_latency += latency;
+        guest.running = true;
+        lock.unlock();
+
+        uint64_t executed = 0;
+        Cpu::SliceResult result = Cpu::SliceResult::HALTED;
+        bool failed = false;
+        std::string error;
+        auto slice_start = Clock::now();
+        try {
+            result = guest.machine->run_slice(budget, executed);
+        } catch (const std::exception& e) {
+            failed = true;
+            error = e.what();
+        }
+        auto slice_end = Clock::now();
+
+        lock.lock();
+        guest.running = false;
+        guest.stats.instructions += executed;
+        guest.stats.slices += 1;
+        guest.stats.cpu_time += slice_end - slice_start;
+        guest.deficit -= std::min(executed, guest.deficit);
+        if (failed) {
+            guest.stats.error = std::move(error);
+            finish(guest, slice_end, vm::FAILED_EXIT_STATUS);
+            changed_.notify_all();
+            continue;
+        }
+        switch (result) {
+            case Cpu::SliceResult::HALTED:
+                finish(guest, slice_end, guest.machine->exit_status());
+                changed_.notify_all();
+                break;
+            case Cpu::SliceResult::BLOCKED:
+                // The turn ends; the guest comes back once its input arrives
+                guest.deficit = 0;
+                guest.stats.parks += 1;
+                parked_.push_back(id);
+                break;
+            case Cpu::SliceResult::PREEMPTED:
+                make_ready(id, slice_end, guest.deficit != 0);
+                changed_.notify_one();
+                break;
+        }
+    }
+}
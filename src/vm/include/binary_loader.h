@@ -87,6 +87,15 @@ namespace lvm {
          * @throws runtime_error if format is invalid
          */
         BinaryProgram load_from_bytes(const std::vector<byte_t>& data);
+
+        /**
+         * Parse and validate a header on its own (used by streaming loads)
+         * 
+         * @param data Exactly header_size bytes starting at the header size field
+         * @return Validated header
+         * @throws runtime_error if the header is malformed or for another machine
+         */
+        BinaryHeader load_header(const std::vector<byte_t>& data);
         
         /**
          * Get expected machine name for this VM
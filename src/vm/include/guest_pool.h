@@ -0,0 +1,41 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace lvm {
+
+    // GuestPool: host worker threads that run forked guests
+    // - Tasks are started in submission order by whichever worker is free
+    // - A task that waits on another task should run it itself if it has not
+    //   started yet (see vm::wait), so nested forks cannot exhaust the pool
+    class GuestPool {
+    public:
+        explicit GuestPool(unsigned threads);
+        // Finishes queued tasks, then joins the workers
+        ~GuestPool();
+
+        GuestPool(const GuestPool&) = delete;
+        GuestPool& operator=(const GuestPool&) = delete;
+
+        void submit(std::function<void()> task);
+        unsigned thread_count() const { return static_cast<unsigned>(workers_.size()); }
+
+        // Process-wide pool with one worker per hardware thread. Never
+        // destroyed, so a guest still running at exit does not take the
+        // pool down underneath it.
+        static GuestPool& shared();
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable ready_;
+        std::deque<std::function<void()>> tasks_;
+        bool stopping_ = false;
+        std::vector<std::thread> workers_;
+
+        void worker_loop();
+    };
+}
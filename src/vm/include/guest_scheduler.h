@@ -0,0 +1,117 @@
+#pragma once
+#include "vm.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace lvm {
+
+    // GuestScheduler: runs many guests on a few host threads in
+    // instruction-budget slices
+    // - Priorities are strict: a guest only runs while no guest of a higher
+    //   priority is ready. Slices are at most one quantum long, so a ready
+    //   guest waits for no more than one quantum per busy worker before a
+    //   lower priority guest gives way.
+    // - Within a priority, deficit round-robin: each turn grants a guest
+    //   quantum * weight instructions, spent in slices of up to one quantum,
+    //   so CPU-bound guests share a worker in proportion to their weights.
+    // - A guest that reaches an input system call with no input ready is
+    //   parked: it holds no worker and is not queued until its input arrives.
+    //   Parked guests are polled every PARK_POLL_INTERVAL, or at once after
+    //   wake().
+    // - Optionally, every dedup interval a worker merges identical memory
+    //   blocks across the guests that are not in a slice. It holds the
+    //   scheduler lock meanwhile, so those guests stay idle; guests already
+    //   in a slice keep running and are left out of that pass.
+    // Forked children still run on the GuestPool, and a guest that waits on
+    // a child, or on streamed code, holds its worker while it waits.
+    class GuestScheduler {
+    public:
+        using GuestId = size_t;
+        using Clock = std::chrono::steady_clock;
+
+        static constexpr uint32_t DEFAULT_QUANTUM = 4096;
+        static constexpr std::chrono::milliseconds PARK_POLL_INTERVAL{1};
+
+        explicit GuestScheduler(unsigned threads, uint32_t quantum = DEFAULT_QUANTUM);
+
+        GuestScheduler(const GuestScheduler&) = delete;
+        GuestScheduler& operator=(const GuestScheduler&) = delete;
+
+        // Guests are added before run(), with a loaded program; the
+        // scheduler does not own them. Weight is clamped to at least 1;
+        // higher priority values run first.
+        GuestId add(vm& machine, uint32_t weight = 1, int priority = 0);
+
+        // Run every guest to completion on the worker threads
+        void run();
+
+        // Re-check parked guests now, e.g. right after feeding one input
+        void wake();
+
+        // Interval between memory merge passes; zero (the default) disables them
+        void set_dedup_interval(Clock::duration interval);
+        // Totals over every merge pass so far
+        VMemUnit::DedupStats dedup_stats() const;
+        uint64_t dedup_passes() const;
+
+        struct GuestStats {
+            uint64_t instructions = 0;
+            uint64_t slices = 0;
+            uint64_t parks = 0;                     // times parked waiting for input
+            Clock::duration cpu_time{};             // time spent in slices
+            Clock::duration max_ready_latency{};    // longest wait from ready to running
+            Clock::duration total_ready_latency{};
+            Clock::duration turnaround{};           // run() start to completion
+            double cpu_share = 0.0;                 // fraction of all instructions executed
+            bool finished = false;
+            word_t exit_status = 0;                 // vm::FAILED_EXIT_STATUS on a runtime error
+            std::string error;
+        };
+        // Safe to call while run() is in progress
+        std::vector<GuestStats> stats() const;
+
+    private:
+        struct Guest {
+            Guest(vm& machine, uint32_t weight, int priority)
+                : machine(&machine), weight(weight), priority(priority) {}
+            vm* machine;
+            uint32_t weight;
+            int priority;
+            uint64_t deficit = 0;   // instructions left in the current turn
+            bool running = false;   // in a slice on some worker
+            Clock::time_point ready_since;
+            GuestStats stats;
+        };
+
+        uint32_t quantum_;
+        unsigned thread_count_;
+        mutable std::mutex mutex_;
+        std::condition_variable changed_;
+        std::vector<std::unique_ptr<Guest>> guests_;
+        std::map<int, std::deque<GuestId>, std::greater<>> ready_;   // highest priority first
+        std::vector<GuestId> parked_;
+        Clock::time_point started_;
+        Clock::time_point last_poll_;
+        size_t unfinished_ = 0;
+        bool wake_requested_ = false;
+
+        Clock::duration dedup_interval_{};
+        Clock::time_point last_dedup_;
+        VMemUnit::DedupStats dedup_totals_;
+        uint64_t dedup_passes_ = 0;
+
+        void worker_loop();
+        void make_ready(GuestId id, Clock::time_point now, bool continue_turn);
+        void poll_parked(Clock::time_point now);
+        void merge_idle_memory(Clock::time_point now);
+        void finish(Guest& guest, Clock::time_point now, word_t exit_status);
+    };
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "memsize.h"
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace lvm {
+
+    /**
+     * Program archive format (Version 1.0.0), see specifications/archive-format.md
+     * 
+     * Packs many Pendragon binaries into one file:
+     * - Fixed archive header
+     * - Member index, sorted by name, with segment offsets precomputed at pack time
+     * - Open-addressed hash table over member names for O(1) lookup
+     * - Name string table
+     * - Members, each an unmodified binary image starting on a 4 KB boundary
+     */
+    struct ArchiveMember {
+        std::string_view name;
+        std::span<const byte_t> image;          // whole original binary
+        std::span<const byte_t> data_segment;
+        std::span<const byte_t> code_segment;
+    };
+
+    /**
+     * ProgramArchive - Read-only, memory-mapped view of a program archive
+     * 
+     * The archive is mapped once and validated on open; members are returned
+     * as views into the mapping, so opening a member neither reads nor copies.
+     * Views stay valid for the lifetime of the archive object.
+     */
+    class ProgramArchive {
+    public:
+        static constexpr char MAGIC[4] = {'P', 'D', 'A', 'R'};
+        static constexpr size_t MEMBER_ALIGNMENT = 4096;
+        static constexpr size_t HEADER_SIZE = 40;
+        static constexpr size_t INDEX_ENTRY_SIZE = 48;
+
+        /**
+         * Map and validate an archive
+         * 
+         * @throws runtime_error if the file cannot be mapped or is malformed
+         */
+        explicit ProgramArchive(const std::string& filename);
+        ~ProgramArchive();
+
+        ProgramArchive(const ProgramArchive&) = delete;
+        ProgramArchive& operator=(const ProgramArchive&) = delete;
+
+        size_t size() const { return member_count_; }
+        ArchiveMember member(size_t index) const;
+        std::optional<ArchiveMember> find(std::string_view name) const;
+
+        /**
+         * Pack binaries into an archive
+         * 
+         * Each image is validated with BinaryLoader so segment offsets can be
+         * precomputed; names must be unique.
+         * 
+         * @throws runtime_error on invalid images, duplicate names or write failure
+         */
+        static void write(const std::string& filename,
+                          const std::vector<std::pair<std::string, std::vector<byte_t>>>& members);
+
+        static uint64_t hash_name(std::string_view name);
+
+    private:
+        const byte_t* base_ = nullptr;
+        size_t mapped_size_ = 0;
+        uint32_t member_count_ = 0;
+        uint32_t bucket_count_ = 0;
+        const byte_t* index_ = nullptr;
+        const byte_t* buckets_ = nullptr;
+        const byte_t* names_ = nullptr;
+        size_t names_size_ = 0;
+
+        void validate();
+    };
+
+} // namespace lvm
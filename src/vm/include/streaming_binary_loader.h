@@ -0,0 +1,95 @@
+#pragma once
+
+#include "binary_loader.h"
+#include "icode_source.h"
+#include <condition_variable>
+#include <istream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace lvm {
+
+    /**
+     * StreamingBinaryLoader - Loads a Pendragon binary while it is executing
+     * 
+     * The header and data segment are read synchronously by start(); the code
+     * segment is then read by a background thread into a host buffer and
+     * handed to the instruction unit through ICodeSource, so execution can
+     * begin as soon as the first code page has arrived. Suited to images
+     * coming from a pipe or slow disk.
+     * 
+     * The data segment is complete before execution starts because data
+     * accesses, unlike instruction fetches, are not gated on arrival.
+     * 
+     * The reader thread shares the code buffer with the loader. Destroying
+     * the loader while the reader is blocked in a read detaches the reader
+     * rather than waiting for a producer that may never write again; the
+     * reader drops the buffer once that read returns.
+     */
+    class StreamingBinaryLoader : public ICodeSource {
+    public:
+        // Stream is read from the background thread and must outlive the
+        // reader, including a read still blocked after the loader is gone
+        // (std::cin)
+        explicit StreamingBinaryLoader(std::istream& input);
+        // Loader owns the stream
+        explicit StreamingBinaryLoader(std::unique_ptr<std::istream> input);
+        ~StreamingBinaryLoader();
+
+        StreamingBinaryLoader(const StreamingBinaryLoader&) = delete;
+        StreamingBinaryLoader& operator=(const StreamingBinaryLoader&) = delete;
+
+        /**
+         * Read header and data segment, then start reading code in the background
+         * 
+         * @param max_code_size Largest code segment accepted (code context capacity)
+         * @param max_data_size Largest data segment accepted (data context capacity)
+         * @throws runtime_error if the header or data segment is invalid or truncated,
+         *         or a segment size exceeds its limit
+         */
+        void start(size_t max_code_size = std::numeric_limits<size_t>::max(),
+                   size_t max_data_size = std::numeric_limits<size_t>::max());
+
+        const BinaryHeader& get_header() const { return header_; }
+        const std::vector<byte_t>& get_data_segment() const { return data_segment_; }
+
+        // ICodeSource interface implementation
+        size_t code_size() const override { return state_->code.size(); }
+        size_t wait_for(size_t end) override;
+        void copy_code(size_t offset, byte_t* out, size_t length) const override;
+
+        // Bytes read in each background read
+        static constexpr size_t READ_CHUNK_SIZE = 4096;
+
+    private:
+        // Everything the reader thread touches; it holds its own reference
+        struct ReadState {
+            explicit ReadState(std::istream& input) : input(input) {}
+            explicit ReadState(std::unique_ptr<std::istream> owned)
+                : owned_input(std::move(owned)), input(*owned_input) {}
+            std::unique_ptr<std::istream> owned_input;
+            std::istream& input;
+            std::vector<byte_t> code;   // sized up front, filled as a growing prefix
+
+            std::mutex mutex;
+            std::condition_variable arrived;
+            size_t received = 0;
+            std::string error;
+            bool stop = false;
+            bool reading = false;       // reader is inside a stream read
+        };
+
+        std::shared_ptr<ReadState> state_;
+        BinaryHeader header_;
+        std::vector<byte_t> data_segment_;
+        std::thread reader_;
+
+        void read_exact(byte_t* out, size_t size, const char* what);
+        static void read_code(std::shared_ptr<ReadState> state);
+    };
+
+} // namespace lvm
@@ -6,22 +6,85 @@
 #include "instruction_unit.h"
 #include "cpu.h"
 #include "basic_io.h"
+#include "streaming_binary_loader.h"
+#include "program_archive.h"
+#include "iprocess_control.h"
 #include <memory>
+#include <string>
 namespace lvm {
-    class vm{
+    // All per-instance state (memory unit and context table, CPU with its
+    // registers and ALU, stack, I/O and instruction unit with its return
+    // stack) lives inside one vm object. Components reference each other
+    // through non-owning pointers into the same object, so an idle guest is
+    // a single allocation plus whatever guest memory it touches.
+    class vm : public IProcessControl {
     public:
         vm(addr32_t stack_capacity, addr32_t code_capacity, addr32_t data_capacity);
+        // Waits for any forked children that were never waited for
         ~vm();
+        
+        // Components point into the instance, so it cannot be copied or moved
+        vm(const vm&) = delete;
+        vm& operator=(const vm&) = delete;
+        
         void load_program(char* fileName, addr_t load_address);
+        // Start executing before the image is fully read: code pages are
+        // mapped as they arrive from the stream ("-" for standard input)
+        void load_program_streaming(const std::string& fileName, addr_t load_address);
+        // Load a member of a mapped program archive; segments are copied
+        // straight from the mapping into guest memory
+        void load_program(const ArchiveMember& member, addr_t load_address);
         void run();
+        // Run at most budget instructions (see GuestScheduler). Output is
+        // flushed when the guest halts or blocks waiting for input.
+        Cpu::SliceResult run_slice(uint64_t budget, uint64_t& executed);
+        // Guest input comes from std::cin unless redirected
+        void set_input(std::istream& input) { basic_io.set_input(input); }
+        bool input_ready() const { return basic_io.input_ready(); }
+        // Back guest memory with a swap file, keeping at most
+        // max_resident_blocks 4 KB blocks in host memory
+        void enable_swap(const std::string& swap_path, size_t max_resident_blocks);
+        // Hand guest output to a writer thread so a slow stdout does not
+        // stall execution; policy decides what happens when the ring is full
+        void enable_async_output(AsyncOutput::FullPolicy policy);
+        // Stack memory is committed as the guest's SP reaches it; with this
+        // the blocks are handed back again once the stack shrinks well below
+        void enable_stack_release() { stack.set_release_on_shrink(true); }
+        // Share identical memory blocks across guests copy-on-write (see
+        // VMemUnit::merge_duplicate_blocks). None of them may be executing.
+        static VMemUnit::DedupStats merge_duplicate_memory(const std::vector<vm*>& machines);
+
+        // Process control (EXIT, FORK and WAIT syscalls)
+        // A fork builds a new vm whose memory shares every block of this one
+        // copy-on-write and whose CPU, stack and instruction unit continue
+        // from the same point; it runs on the shared GuestPool. Swap and
+        // asynchronous output are not inherited.
+        word_t fork() override;
+        word_t wait(word_t child) override;
+        void exit(word_t status) override;
+        // Status passed to EXIT, or 0 if the guest halted
+        word_t exit_status() const { return exit_status_; }
+        // Reported for a child that stopped with a runtime error
+        static constexpr word_t FAILED_EXIT_STATUS = 0xFFFF;
+        static constexpr size_t MAX_CHILDREN = 0xFFFF;
     private:
-        std::shared_ptr<VMemUnit> vmem_unit;
-        std::shared_ptr<Stack> stack;
-        std::shared_ptr<BasicIO> basic_io;
-        std::shared_ptr<InstructionUnit> instruction_unit;
-        std::shared_ptr<Cpu> cpu_instance;
-        std::shared_ptr<Flags> flags;
+        // Declaration order is construction order
+        VMemUnit vmem_unit;
+        Cpu cpu_instance;
+        Stack stack;
+        BasicIO basic_io;
         context_id_t code_context_id_;
         context_id_t data_context_id_;
+        InstructionUnit instruction_unit;
+        std::shared_ptr<StreamingBinaryLoader> streaming_loader;
+
+        addr32_t stack_capacity_;
+        addr32_t code_capacity_;
+        addr32_t data_capacity_;
+        word_t exit_status_ = 0;
+        struct Child;
+        std::vector<std::shared_ptr<Child>> children_;   // handle - 1 -> child, null = free
+
+        void load_data_segment(std::span<const byte_t> data_segment, addr_t load_address);
     };
 }
\ No newline at end of file
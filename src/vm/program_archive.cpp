@@ -0,0 +1,303 @@
+#include "program_archive.h"
+#include "binary_loader.h"
+#include "errors.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace lvm;
+
+static const BinaryVersion ARCHIVE_VERSION(1, 0, 0);
+
+namespace {
+    // Little-endian field access on the mapped image
+    uint32_t get_u32(const byte_t* p) {
+        return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+               (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+    }
+
+    uint64_t get_u64(const byte_t* p) {
+        return static_cast<uint64_t>(get_u32(p)) | (static_cast<uint64_t>(get_u32(p + 4)) << 32);
+    }
+
+    void put_u16(std::vector<byte_t>& out, uint16_t value) {
+        out.push_back(value & 0xFF);
+        out.push_back((value >> 8) & 0xFF);
+    }
+
+    void put_u32(std::vector<byte_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out.push_back(static_cast<byte_t>(value >> (8 * i)));
+        }
+    }
+
+    void put_u64(std::vector<byte_t>& out, uint64_t value) {
+        put_u32(out, static_cast<uint32_t>(value));
+        put_u32(out, static_cast<uint32_t>(value >> 32));
+    }
+
+    // Index entry field offsets
+    constexpr size_t ENTRY_HASH = 0;
+    constexpr size_t ENTRY_NAME_OFFSET = 8;
+    constexpr size_t ENTRY_NAME_SIZE = 12;
+    constexpr size_t ENTRY_MEMBER_OFFSET = 16;
+    constexpr size_t ENTRY_MEMBER_SIZE = 24;
+    constexpr size_t ENTRY_DATA_OFFSET = 28;
+    constexpr size_t ENTRY_DATA_SIZE = 32;
+    constexpr size_t ENTRY_CODE_OFFSET = 36;
+    constexpr size_t ENTRY_CODE_SIZE = 40;
+
+    size_t align_up(size_t value, size_t alignment) {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+}
+
+uint64_t ProgramArchive::hash_name(std::string_view name) {
+    // FNV-1a
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (char c : name) {
+        hash ^= static_cast<byte_t>(c);
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+ProgramArchive::ProgramArchive(const std::string& filename) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw runtime_error("Failed to open archive: " + filename);
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_SIZE) {
+        ::close(fd);
+        throw runtime_error("Archive too small to be valid: " + filename);
+    }
+    mapped_size_ = static_cast<size_t>(st.st_size);
+    void* mapping = ::mmap(nullptr, mapped_size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        throw runtime_error("Failed to map archive: " + filename);
+    }
+    base_ = static_cast<const byte_t*>(mapping);
+
+    try {
+        validate();
+    } catch (...) {
+        ::munmap(const_cast<byte_t*>(base_), mapped_size_);
+        throw;
+    }
+}
+
+ProgramArchive::~ProgramArchive() {
+    if (base_ != nullptr) {
+        ::munmap(const_cast<byte_t*>(base_), mapped_size_);
+    }
+}
+
+void ProgramArchive::validate() {
+    if (std::memcmp(base_, MAGIC, sizeof(MAGIC)) != 0) {
+        throw runtime_error("Not a program archive (bad magic)");
+    }
+    BinaryVersion version(base_[4], base_[5], static_cast<uint16_t>(base_[6] | (base_[7] << 8)));
+    if (version != ARCHIVE_VERSION) {
+        throw runtime_error("Unsupported archive version: " + version.to_string());
+    }
+
+    member_count_ = get_u32(base_ + 8);
+    bucket_count_ = get_u32(base_ + 12);
+    uint64_t index_offset = get_u64(base_ + 16);
+    uint64_t buckets_offset = get_u64(base_ + 24);
+    uint64_t names_offset = get_u64(base_ + 32);
+
+    // Every table must lie inside the file, in layout order. The offsets
+    // come straight from the file, so each check is written as a
+    // subtraction that cannot wrap.
+    if (index_offset < HEADER_SIZE || index_offset > buckets_offset || buckets_offset > names_offset ||
+        names_offset > mapped_size_ ||
+        member_count_ > (buckets_offset - index_offset) / INDEX_ENTRY_SIZE ||
+        bucket_count_ > (names_offset - buckets_offset) / 4) {
+        throw runtime_error("Archive tables are out of bounds");
+    }
+    if (bucket_count_ == 0 || (bucket_count_ & (bucket_count_ - 1)) != 0 || bucket_count_ < member_count_) {
+        throw runtime_error("Archive hash table size is invalid");
+    }
+    index_ = base_ + index_offset;
+    buckets_ = base_ + buckets_offset;
+    names_ = base_ + names_offset;
+
+    // Member extents are checked once here so lookups need no bounds checks
+    size_t names_size = 0;
+    for (uint32_t i = 0; i < member_count_; ++i) {
+        const byte_t* entry = index_ + i * INDEX_ENTRY_SIZE;
+        uint64_t name_end = static_cast<uint64_t>(get_u32(entry + ENTRY_NAME_OFFSET)) + get_u32(entry + ENTRY_NAME_SIZE);
+        uint64_t member_offset = get_u64(entry + ENTRY_MEMBER_OFFSET);
+        uint64_t member_size = get_u32(entry + ENTRY_MEMBER_SIZE);
+        uint64_t data_end = static_cast<uint64_t>(get_u32(entry + ENTRY_DATA_OFFSET)) + get_u32(entry + ENTRY_DATA_SIZE);
+        uint64_t code_end = static_cast<uint64_t>(get_u32(entry + ENTRY_CODE_OFFSET)) + get_u32(entry + ENTRY_CODE_SIZE);
+        if (member_offset % MEMBER_ALIGNMENT != 0 || member_offset > mapped_size_ ||
+            member_size > mapped_size_ - member_offset || data_end > member_size || code_end > member_size ||
+            name_end > mapped_size_ - names_offset) {
+            throw runtime_error("Archive member " + std::to_string(i) + " is out of bounds");
+        }
+        names_size = std::max<size_t>(names_size, name_end);
+    }
+    names_size_ = names_size;
+    for (uint32_t b = 0; b < bucket_count_; ++b) {
+        if (get_u32(buckets_ + b * 4) > member_count_) {
+            throw runtime_error("Archive hash table refers to a missing member");
+        }
+    }
+}
+
+ArchiveMember ProgramArchive::member(size_t index) const {
+    if (index >= member_count_) {
+        throw runtime_error("Archive member index out of range");
+    }
+    const byte_t* entry = index_ + index * INDEX_ENTRY_SIZE;
+    const byte_t* image = base_ + get_u64(entry + ENTRY_MEMBER_OFFSET);
+
+    ArchiveMember member;
+    member.name = std::string_view(reinterpret_cast<const char*>(names_ + get_u32(entry + ENTRY_NAME_OFFSET)),
+                                   get_u32(entry + ENTRY_NAME_SIZE));
+    member.image = {image, get_u32(entry + ENTRY_MEMBER_SIZE)};
+    member.data_segment = {image + get_u32(entry + ENTRY_DATA_OFFSET), get_u32(entry + ENTRY_DATA_SIZE)};
+    member.code_segment = {image + get_u32(entry + ENTRY_CODE_OFFSET), get_u32(entry + ENTRY_CODE_SIZE)};
+    return member;
+}
+
+std::optional<ArchiveMember> ProgramArchive::find(std::string_view name) const {
+    uint64_t hash = hash_name(name);
+    uint32_t mask = bucket_count_ - 1;
+
+    // Linear probing; an empty bucket (0) ends the chain
+    for (uint32_t probe = 0; probe < bucket_count_; ++probe) {
+        uint32_t slot = get_u32(buckets_ + ((static_cast<uint32_t>(hash) + probe) & mask) * 4);
+        if (slot == 0) {
+            break;
+        }
+        const byte_t* entry = index_ + (slot - 1) * INDEX_ENTRY_SIZE;
+        if (get_u64(entry + ENTRY_HASH) != hash) {
+            continue;
+        }
+        ArchiveMember candidate = member(slot - 1);
+        if (candidate.name == name) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+void ProgramArchive::write(const std::string& filename,
+                           const std::vector<std::pair<std::string, std::vector<byte_t>>>& members) {
+    // Sort by name for a stable, listable index
+    std::vector<size_t> order(members.size());
+    for (size_t i = 0; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return members[a].first < members[b].first;
+    });
+    for (size_t i = 1; i < order.size(); ++i) {
+        if (members[order[i]].first == members[order[i - 1]].first) {
+            throw runtime_error("Duplicate archive member name: " + members[order[i]].first);
+        }
+    }
+
+    uint32_t count = static_cast<uint32_t>(members.size());
+    uint32_t bucket_count = 1;
+    while (bucket_count < count * 2) {
+        bucket_count <<= 1;
+    }
+
+    // Names table
+    std::vector<byte_t> names;
+    std::vector<uint32_t> name_offsets;
+    for (size_t i : order) {
+        name_offsets.push_back(static_cast<uint32_t>(names.size()));
+        names.insert(names.end(), members[i].first.begin(), members[i].first.end());
+    }
+
+    uint64_t index_offset = HEADER_SIZE;
+    uint64_t buckets_offset = index_offset + static_cast<uint64_t>(count) * INDEX_ENTRY_SIZE;
+    uint64_t names_offset = buckets_offset + static_cast<uint64_t>(bucket_count) * 4;
+    uint64_t member_offset = align_up(names_offset + names.size(), MEMBER_ALIGNMENT);
+
+    std::vector<byte_t> header;
+    header.insert(header.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    header.push_back(ARCHIVE_VERSION.major);
+    header.push_back(ARCHIVE_VERSION.minor);
+    put_u16(header, ARCHIVE_VERSION.revision);
+    put_u32(header, count);
+    put_u32(header, bucket_count);
+    put_u64(header, index_offset);
+    put_u64(header, buckets_offset);
+    put_u64(header, names_offset);
+
+    // Index entries with segment offsets taken from the parsed image
+    BinaryLoader loader;
+    std::vector<byte_t> index;
+    std::vector<uint32_t> buckets(bucket_count, 0);
+    std::vector<uint64_t> offsets;
+    for (uint32_t n = 0; n < count; ++n) {
+        const auto& [name, image] = members[order[n]];
+        BinaryProgram program;
+        try {
+            program = loader.load_from_bytes(image);
+        } catch (const runtime_error& e) {
+            throw runtime_error("Invalid archive member '" + name + "': " + e.what());
+        }
+        uint32_t data_offset = program.header.header_size + 4;
+        uint32_t code_offset = data_offset + static_cast<uint32_t>(program.data_segment.size()) + 4;
+
+        uint64_t hash = hash_name(name);
+        put_u64(index, hash);
+        put_u32(index, name_offsets[n]);
+        put_u32(index, static_cast<uint32_t>(name.size()));
+        put_u64(index, member_offset);
+        put_u32(index, static_cast<uint32_t>(image.size()));
+        put_u32(index, data_offset);
+        put_u32(index, static_cast<uint32_t>(program.data_segment.size()));
+        put_u32(index, code_offset);
+        put_u32(index, static_cast<uint32_t>(program.code_segment.size()));
+        put_u32(index, 0);  // reserved
+
+        uint32_t slot = static_cast<uint32_t>(hash) & (bucket_count - 1);
+        while (buckets[slot] != 0) {
+            slot = (slot + 1) & (bucket_count - 1);
+        }
+        buckets[slot] = n + 1;
+
+        offsets.push_back(member_offset);
+        member_offset = align_up(member_offset + image.size(), MEMBER_ALIGNMENT);
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw runtime_error("Failed to create archive: " + filename);
+    }
+    std::vector<byte_t> bucket_bytes;
+    for (uint32_t slot : buckets) {
+        put_u32(bucket_bytes, slot);
+    }
+    auto emit = [&file](const std::vector<byte_t>& bytes) {
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    };
+    emit(header);
+    emit(index);
+    emit(bucket_bytes);
+    emit(names);
+    uint64_t position = names_offset + names.size();
+    for (uint32_t n = 0; n < count; ++n) {
+        std::vector<byte_t> padding(offsets[n] - position, 0);
+        emit(padding);
+        emit(members[order[n]].second);
+        position = offsets[n] + members[order[n]].second.size();
+    }
+    if (!file) {
+        throw runtime_error("Failed to write archive: " + filename);
+    }
+}
@@ -0,0 +1,123 @@
+#include "streaming_binary_loader.h"
+#include "errors.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace lvm;
+
+StreamingBinaryLoader::StreamingBinaryLoader(std::istream& input)
+    : state_(std::make_shared<ReadState>(input)) {
+}
+
+StreamingBinaryLoader::StreamingBinaryLoader(std::unique_ptr<std::istream> input)
+    : state_(std::make_shared<ReadState>(std::move(input))) {
+}
+
+StreamingBinaryLoader::~StreamingBinaryLoader() {
+    bool blocked;
+    {
+        std::lock_guard<std::mutex> lock(state_->mutex);
+        state_->stop = true;
+        blocked = state_->reading;
+    }
+    if (!reader_.joinable()) {
+        return;
+    }
+    // A reader between reads sees stop and returns at once. One blocked in
+    // a read may wait on the producer indefinitely, so leave it to finish
+    // on its own; it keeps the shared state alive until then.
+    if (blocked) {
+        reader_.detach();
+    } else {
+        reader_.join();
+    }
+}
+
+void StreamingBinaryLoader::read_exact(byte_t* out, size_t size, const char* what) {
+    if (size > 0 && !state_->input.read(reinterpret_cast<char*>(out), static_cast<std::streamsize>(size))) {
+        throw runtime_error(std::string("Unexpected end of stream reading ") + what);
+    }
+}
+
+void StreamingBinaryLoader::start(size_t max_code_size, size_t max_data_size) {
+    // Header: size field first, then the rest of the header it describes
+    std::vector<byte_t> header_bytes(2);
+    read_exact(header_bytes.data(), 2, "header size");
+    uint16_t header_size = static_cast<uint16_t>(header_bytes[0] | (header_bytes[1] << 8));
+    if (header_size < 2) {
+        throw runtime_error("Invalid header size in binary stream");
+    }
+    header_bytes.resize(header_size);
+    read_exact(header_bytes.data() + 2, header_size - 2, "header");
+    BinaryLoader loader;
+    header_ = loader.load_header(header_bytes);
+
+    // Data segment is read in full before execution starts. Sizes are
+    // checked before anything is allocated for them, so a corrupt header
+    // cannot ask for gigabytes.
+    byte_t size_bytes[4];
+    read_exact(size_bytes, 4, "data segment size");
+    uint32_t data_size = static_cast<uint32_t>(size_bytes[0]) | (static_cast<uint32_t>(size_bytes[1]) << 8) |
+                         (static_cast<uint32_t>(size_bytes[2]) << 16) | (static_cast<uint32_t>(size_bytes[3]) << 24);
+    if (data_size > max_data_size) {
+        throw runtime_error("Data segment of " + std::to_string(data_size) + " bytes exceeds the data capacity of " +
+                            std::to_string(max_data_size));
+    }
+    data_segment_.resize(data_size);
+    read_exact(data_segment_.data(), data_size, "data segment");
+
+    read_exact(size_bytes, 4, "code segment size");
+    uint32_t code_size = static_cast<uint32_t>(size_bytes[0]) | (static_cast<uint32_t>(size_bytes[1]) << 8) |
+                         (static_cast<uint32_t>(size_bytes[2]) << 16) | (static_cast<uint32_t>(size_bytes[3]) << 24);
+    if (code_size > max_code_size) {
+        throw runtime_error("Code segment of " + std::to_string(code_size) + " bytes exceeds the code capacity of " +
+                            std::to_string(max_code_size));
+    }
+    state_->code.resize(code_size);
+
+    reader_ = std::thread(&StreamingBinaryLoader::read_code, state_);
+}
+
+void StreamingBinaryLoader::read_code(std::shared_ptr<ReadState> state) {
+    auto& code = state->code;
+    size_t received = 0;
+    while (received < code.size()) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->stop) {
+                return;
+            }
+            state->reading = true;
+        }
+        size_t chunk = std::min(READ_CHUNK_SIZE, code.size() - received);
+        state->input.read(reinterpret_cast<char*>(code.data() + received), static_cast<std::streamsize>(chunk));
+        size_t got = static_cast<size_t>(state->input.gcount());
+        received += got;
+
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->reading = false;
+        state->received = received;
+        if (got < chunk) {
+            state->error = "Unexpected end of stream reading code segment";
+            state->arrived.notify_all();
+            return;
+        }
+        state->arrived.notify_all();
+    }
+}
+
+size_t StreamingBinaryLoader::wait_for(size_t end) {
+    size_t target = std::min(end, state_->code.size());
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->arrived.wait(lock, [&] { return state_->received >= target || !state_->error.empty(); });
+    if (state_->received < target) {
+        throw runtime_error(state_->error);
+    }
+    return state_->received;
+}
+
+void StreamingBinaryLoader::copy_code(size_t offset, byte_t* out, size_t length) const {
+    // Callers only copy bytes wait_for() has reported, which the reader
+    // never writes again, so no lock is needed
+    std::memcpy(out, state_->code.data() + offset, length);
+}
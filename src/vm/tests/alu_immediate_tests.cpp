@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    word_t run_guest(const std::vector<byte_t>& code) {
+        vm machine(1024, 65536, 32768);
+        ArchiveMember member{"aluimm", code, {}, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+
+    byte_t high(word_t value) { return static_cast<byte_t>(value >> 8); }
+    byte_t low(word_t value) { return static_cast<byte_t>(value & 0xFF); }
+
+    // LD AX, initial; <opcode> immediate; exit with AX
+    word_t run_on_ax(word_t initial, byte_t opcode, word_t immediate) {
+        return run_guest({
+            OPCODE_LD_REG_IMM_W, 0x01, high(initial), low(initial),
+            opcode, high(immediate), low(immediate),
+            OPCODE_PUSH_REG_W, 0x01,
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+            OPCODE_HALT,
+        });
+    }
+
+    // Runs prefix, then exits with 1 if the conditional jump is taken and 0 if not
+    word_t branch_taken(std::vector<byte_t> code, byte_t jump_opcode) {
+        word_t target = static_cast<word_t>(code.size() + 9);
+        std::vector<byte_t> tail = {
+            jump_opcode, high(target), low(target),
+            OPCODE_PUSHW_IMM_W, 0x00, 0x00,
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+            OPCODE_PUSHW_IMM_W, 0x01, 0x00,
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+            OPCODE_HALT,
+        };
+        code.insert(code.end(), tail.begin(), tail.end());
+        return run_guest(code);
+    }
+}
+
+TEST(AluImmediateTest, ArithmeticWordImmediates) {
+    EXPECT_EQ(run_on_ax(0x1234, OPCODE_ADD_IMM_W, 0x0110), 0x1344);
+    EXPECT_EQ(run_on_ax(0x1234, OPCODE_SUB_IMM_W, 0x0234), 0x1000);
+    EXPECT_EQ(run_on_ax(0x0123, OPCODE_MUL_IMM_W, 0x0010), 0x1230);
+    EXPECT_EQ(run_on_ax(100, OPCODE_DIV_IMM_W, 7), 14);
+    EXPECT_EQ(run_on_ax(100, OPCODE_REM_IMM_W, 7), 2);
+}
+
+TEST(AluImmediateTest, BitwiseWordImmediates) {
+    EXPECT_EQ(run_on_ax(0xF0F0, OPCODE_AND_IMM_W, 0x3C3C), 0x3030);
+    EXPECT_EQ(run_on_ax(0xF000, OPCODE_OR_IMM_W, 0x000F), 0xF00F);
+    EXPECT_EQ(run_on_ax(0xFFFF, OPCODE_XOR_IMM_W, 0x0F0F), 0xF0F0);
+}
+
+TEST(AluImmediateTest, ShiftAndRotateWordImmediates) {
+    EXPECT_EQ(run_on_ax(0x0001, OPCODE_SHL_IMM_W, 4), 0x0010);
+    EXPECT_EQ(run_on_ax(0x8000, OPCODE_SHR_IMM_W, 15), 0x0001);
+    EXPECT_EQ(run_on_ax(0x8001, OPCODE_ROL_IMM_W, 1), 0x0003);
+    EXPECT_EQ(run_on_ax(0x0003, OPCODE_ROR_IMM_W, 1), 0x8001);
+}
+
+TEST(AluImmediateTest, WordImmediatesSetFlags) {
+    // 0xFFFF + 1 wraps to zero with a carry out
+    std::vector<byte_t> wrap = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0xFF, 0xFF,
+        OPCODE_ADD_IMM_W, 0x00, 0x01,
+    };
+    EXPECT_EQ(branch_taken(wrap, OPCODE_JPZ_ADDR), 1);
+    EXPECT_EQ(branch_taken(wrap, OPCODE_JPC_ADDR), 1);
+
+    // 1 - 2 borrows and goes negative
+    std::vector<byte_t> borrow = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x01,
+        OPCODE_SUB_IMM_W, 0x00, 0x02,
+    };
+    EXPECT_EQ(branch_taken(borrow, OPCODE_JPC_ADDR), 1);
+    EXPECT_EQ(branch_taken(borrow, OPCODE_JPS_ADDR), 1);
+    EXPECT_EQ(branch_taken(borrow, OPCODE_JPZ_ADDR), 0);
+
+    // AND clearing every bit sets ZERO
+    std::vector<byte_t> mask = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0xF0, 0x00,
+        OPCODE_AND_IMM_W, 0x0F, 0xFF,
+    };
+    EXPECT_EQ(branch_taken(mask, OPCODE_JPZ_ADDR), 1);
+}
+
+TEST(AluImmediateTest, CompareCopiesLeftOperandIntoAX) {
+    // CMP BX, imm copies BX into AX and leaves the comparison result there:
+    // 1 if greater, 0 if equal, 0xFFFF if less. BX itself is unchanged.
+    auto compare = [](word_t bx, word_t immediate, byte_t exit_register) {
+        return run_guest({
+            OPCODE_LD_REG_IMM_W, 0x01, 0x12, 0x34,
+            OPCODE_LD_REG_IMM_W, 0x02, high(bx), low(bx),
+            OPCODE_CMP_REG_IMM_W, 0x02, high(immediate), low(immediate),
+            OPCODE_PUSH_REG_W, exit_register,
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+            OPCODE_HALT,
+        });
+    };
+    EXPECT_EQ(compare(0x0700, 0x0500, 0x01), 0x0001);
+    EXPECT_EQ(compare(0x0500, 0x0500, 0x01), 0x0000);
+    EXPECT_EQ(compare(0x0300, 0x0500, 0x01), 0xFFFF);
+    EXPECT_EQ(compare(0x0300, 0x0500, 0x02), 0x0300);
+
+    std::vector<byte_t> equal = {
+        OPCODE_LD_REG_IMM_W, 0x02, 0x05, 0x00,
+        OPCODE_CMP_REG_IMM_W, 0x02, 0x05, 0x00,
+    };
+    EXPECT_EQ(branch_taken(equal, OPCODE_JPZ_ADDR), 1);
+    std::vector<byte_t> less = {
+        OPCODE_LD_REG_IMM_W, 0x02, 0x03, 0x00,
+        OPCODE_CMP_REG_IMM_W, 0x02, 0x05, 0x00,
+    };
+    EXPECT_EQ(branch_taken(less, OPCODE_JPS_ADDR), 1);
+    EXPECT_EQ(branch_taken(less, OPCODE_JPZ_ADDR), 0);
+}
@@ -1,8 +1,22 @@
 #include <gtest/gtest.h>
 #include "binary_loader.h"
+#include "streaming_binary_loader.h"
 #include "errors.h"
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <future>
+#include <thread>
 #include <vector>
 #include <cstring>
+#include <sstream>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 using namespace lvm;
 
@@ -230,3 +244,170 @@ TEST(BinaryLoaderTest, LargeSegments) {
     EXPECT_EQ(program.code_segment[0], 0x42);
     EXPECT_EQ(program.data_segment[0], 0x99);
 }
+
+// Streaming loader tests
+
+static std::unique_ptr<std::istream> make_stream(const std::vector<byte_t>& binary) {
+    return std::make_unique<std::istringstream>(std::string(binary.begin(), binary.end()));
+}
+
+TEST(StreamingBinaryLoaderTest, StreamsCodeAfterHeaderAndData) {
+    std::vector<byte_t> data = {0xAA, 0xBB, 0xCC};
+    std::vector<byte_t> code(3 * StreamingBinaryLoader::READ_CHUNK_SIZE + 17);
+    for (size_t i = 0; i < code.size(); ++i) {
+        code[i] = static_cast<byte_t>(i * 31);
+    }
+    StreamingBinaryLoader loader(make_stream(create_test_binary("Pendragon", 1, 0, 0, "Streamed", data, code)));
+    loader.start();
+
+    EXPECT_EQ(loader.get_header().program_name, "Streamed");
+    EXPECT_EQ(loader.get_data_segment(), data);
+    EXPECT_EQ(loader.code_size(), code.size());
+
+    // Waiting past the end clamps to the code size
+    EXPECT_GE(loader.wait_for(10), 10u);
+    EXPECT_EQ(loader.wait_for(code.size() + 100), code.size());
+
+    std::vector<byte_t> copied(code.size());
+    loader.copy_code(0, copied.data(), copied.size());
+    EXPECT_EQ(copied, code);
+}
+
+TEST(StreamingBinaryLoaderTest, TruncatedCodeFailsOnWait) {
+    std::vector<byte_t> code(100, 0x01);
+    auto binary = create_test_binary("Pendragon", 1, 0, 0, "Short", {}, code);
+    binary.resize(binary.size() - 40);
+
+    StreamingBinaryLoader loader(make_stream(binary));
+    loader.start();
+    EXPECT_EQ(loader.wait_for(60), 60u);
+    EXPECT_THROW(loader.wait_for(100), runtime_error);
+}
+
+TEST(StreamingBinaryLoaderTest, InvalidHeaderFailsOnStart) {
+    StreamingBinaryLoader loader(make_stream(create_test_binary("Excalibur")));
+    EXPECT_THROW(loader.start(), runtime_error);
+}
+
+TEST(StreamingBinaryLoaderTest, OversizedSegmentsFailOnStart) {
+    std::vector<byte_t> data(64, 0x11);
+    std::vector<byte_t> code(128, 0x00);
+    auto binary = create_test_binary("Pendragon", 1, 0, 0, "Big", data, code);
+
+    StreamingBinaryLoader code_too_big(make_stream(binary));
+    EXPECT_THROW(code_too_big.start(127, 64), runtime_error);
+    StreamingBinaryLoader data_too_big(make_stream(binary));
+    EXPECT_THROW(data_too_big.start(128, 63), runtime_error);
+    StreamingBinaryLoader fits(make_stream(binary));
+    EXPECT_NO_THROW(fits.start(128, 64));
+}
+
+// Streaming into a running vm: the image comes through a FIFO whose writer
+// delivers a prefix, then holds the rest back until released. It gives up
+// waiting after RELEASE_TIMEOUT, so a loader that blocks on it fails the
+// timing checks instead of hanging the test.
+namespace {
+    class StalledProducer {
+    public:
+        static constexpr std::chrono::seconds RELEASE_TIMEOUT{3};
+
+        StalledProducer(const std::vector<byte_t>& image, size_t prefix)
+            : path_(std::filesystem::temp_directory_path() /
+                    ("lvm_stream_" + std::to_string(::getpid()) + "_" + std::to_string(next_id_++))) {
+            if (::mkfifo(path_.c_str(), 0600) != 0) {
+                throw std::runtime_error("mkfifo failed");
+            }
+            writer_ = std::thread([this, image, prefix, release = release_.get_future()] {
+                // The reader may be gone by the time the rest is released;
+                // let that write fail with EPIPE instead of killing the test
+                sigset_t pipe_signal;
+                sigemptyset(&pipe_signal);
+                sigaddset(&pipe_signal, SIGPIPE);
+                ::pthread_sigmask(SIG_BLOCK, &pipe_signal, nullptr);
+                int fd = ::open(path_.c_str(), O_WRONLY);
+                write_all(fd, image.data(), prefix);
+                release.wait_for(RELEASE_TIMEOUT);
+                write_all(fd, image.data() + prefix, image.size() - prefix);
+                ::close(fd);
+            });
+        }
+        ~StalledProducer() {
+            release();
+            writer_.join();
+            std::filesystem::remove(path_);
+        }
+        void release() {
+            if (!released_) {
+                released_ = true;
+                release_.set_value();
+            }
+        }
+        std::string path() const { return path_.string(); }
+    private:
+        static inline std::atomic<int> next_id_{0};
+        std::filesystem::path path_;
+        std::promise<void> release_;
+        bool released_ = false;
+        std::thread writer_;
+
+        static void write_all(int fd, const byte_t* bytes, size_t size) {
+            while (size > 0) {
+                ssize_t written = ::write(fd, bytes, size);
+                if (written <= 0) {
+                    return;
+                }
+                bytes += written;
+                size -= static_cast<size_t>(written);
+            }
+        }
+    };
+}
+
+TEST(StreamingLoadTest, FetchWaitsForCodeStillInFlight) {
+    // A NOP sled runs off the first mapped page; the exit sits on the third
+    std::vector<byte_t> code(2 * InstructionUnit::CODE_MAP_PAGE_SIZE + 16, OPCODE_NOP);
+    std::vector<byte_t> exit_code = {
+        OPCODE_PUSHW_IMM_W, 0x2A, 0x00,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    std::copy(exit_code.begin(), exit_code.end(), code.begin() + 2 * InstructionUnit::CODE_MAP_PAGE_SIZE);
+    auto image = create_test_binary("Pendragon", 1, 0, 0, "Streamed", {}, code);
+    size_t code_start = image.size() - code.size();
+
+    StalledProducer producer(image, code_start + InstructionUnit::CODE_MAP_PAGE_SIZE);
+    vm machine(1024, 65536, 65536);
+    machine.load_program_streaming(producer.path(), 0);
+
+    std::atomic<bool> finished{false};
+    std::thread guest([&] {
+        machine.run();
+        finished = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(finished) << "guest ran past the delivered code";
+
+    producer.release();
+    guest.join();
+    EXPECT_TRUE(finished);
+    EXPECT_EQ(machine.exit_status(), 0x2A);
+}
+
+TEST(StreamingLoadTest, HaltedGuestDoesNotWaitForStalledProducer) {
+    // The guest halts on its first instruction while most of the image is
+    // still held back; tearing the vm down must not wait for the producer
+    std::vector<byte_t> code(4 * StreamingBinaryLoader::READ_CHUNK_SIZE, OPCODE_NOP);
+    code[0] = OPCODE_HALT;
+    auto image = create_test_binary("Pendragon", 1, 0, 0, "Stalled", {}, code);
+    size_t code_start = image.size() - code.size();
+
+    StalledProducer producer(image, code_start + 9000);
+    auto started = std::chrono::steady_clock::now();
+    {
+        vm machine(1024, 65536, 65536);
+        machine.load_program_streaming(producer.path(), 0);
+        machine.run();
+        EXPECT_EQ(machine.exit_status(), 0);
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(1));
+}
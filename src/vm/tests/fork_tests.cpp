@@ -0,0 +1,116 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include "errors.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    word_t run_guest(const std::vector<byte_t>& code, const std::vector<byte_t>& data = {},
+                     size_t swap_budget = 0) {
+        vm machine(1024, 65536, 32768);
+        if (swap_budget != 0) {
+            machine.enable_swap(::testing::TempDir() + "fork_test_swap.bin", swap_budget);
+        }
+        ArchiveMember member{"fork", code, data, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+
+    // Parent and child both see the word pushed before the fork; the child
+    // overwrites data[0] and exits with data[0] + 5, the parent exits with
+    // its own data[0] plus the child's status
+    std::vector<byte_t> fork_and_write_data() {
+        return {
+            OPCODE_PUSHW_IMM_W, 0x05, 0x00,                                   // 0
+            OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,          // 3
+            OPCODE_POP_REG_W, 0x01,                                           // 6
+            OPCODE_CMP_REG_IMM_W, 0x01, 0x00, 0x00,                           // 8
+            OPCODE_JPZ_ADDR, 0x00, 0x26,                                      // 12
+            OPCODE_PUSH_REG_W, 0x01,                                          // 15
+            OPCODE_SYS_FUNC, SYSCALL_WAIT & 0xFF, SYSCALL_WAIT >> 8,          // 17
+            OPCODE_POP_REG_W, 0x02,                                           // 20
+            OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x00,                            // 22
+            OPCODE_LDAL_REG_ADDR_B, 0x01, 0x00, 0x00,                         // 26
+            OPCODE_ADD_REG_W, 0x02,                                           // 30
+            OPCODE_PUSH_REG_W, 0x01,                                          // 32
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 34
+            OPCODE_HALT,                                                      // 37
+            // child
+            OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x55,                            // 38
+            OPCODE_STAL_ADDR_REG_B, 0x00, 0x00, 0x01,                         // 42
+            OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x00,                            // 46
+            OPCODE_LDAL_REG_ADDR_B, 0x01, 0x00, 0x00,                         // 50
+            OPCODE_POP_REG_W, 0x02,                                           // 54
+            OPCODE_ADD_REG_W, 0x02,                                           // 56
+            OPCODE_PUSH_REG_W, 0x01,                                          // 58
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 60
+            OPCODE_HALT,                                                      // 63
+        };
+    }
+}
+
+TEST(ForkTest, ChildGetsCopyOfStackAndPrivateMemory) {
+    EXPECT_EQ(run_guest(fork_and_write_data(), {0x11}), 0x11 + 0x55 + 5);
+}
+
+TEST(ForkTest, ChildRunsUnderParentsSwapBudget) {
+    // Seven blocks of data against a two block budget: most of the image is
+    // in the swap file when the child forks, and the child runs from it
+    std::vector<byte_t> data(7 * VMemUnit::BLOCK_SIZE, 0x11);
+    EXPECT_EQ(run_guest(fork_and_write_data(), data, 2), 0x11 + 0x55 + 5);
+}
+
+TEST(ForkTest, NestedForksPropagateExitStatus) {
+    // Grandchild exits with 40, child adds one, parent passes it on
+    std::vector<byte_t> code = {
+        OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,          // 0
+        OPCODE_POP_REG_W, 0x01,                                           // 3
+        OPCODE_CMP_REG_IMM_W, 0x01, 0x00, 0x00,                           // 5
+        OPCODE_JPZ_ADDR, 0x00, 0x15,                                      // 9
+        OPCODE_PUSH_REG_W, 0x01,                                          // 12
+        OPCODE_SYS_FUNC, SYSCALL_WAIT & 0xFF, SYSCALL_WAIT >> 8,          // 14
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 17
+        OPCODE_HALT,                                                      // 20
+        // child
+        OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,          // 21
+        OPCODE_POP_REG_W, 0x01,                                           // 24
+        OPCODE_CMP_REG_IMM_W, 0x01, 0x00, 0x00,                           // 26
+        OPCODE_JPZ_ADDR, 0x00, 0x31,                                      // 30
+        OPCODE_PUSH_REG_W, 0x01,                                          // 33
+        OPCODE_SYS_FUNC, SYSCALL_WAIT & 0xFF, SYSCALL_WAIT >> 8,          // 35
+        OPCODE_POP_REG_W, 0x01,                                           // 38
+        OPCODE_ADD_IMM_W, 0x00, 0x01,                                     // 40
+        OPCODE_PUSH_REG_W, 0x01,                                          // 43
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 45
+        OPCODE_HALT,                                                      // 48
+        // grandchild
+        OPCODE_PUSHW_IMM_W, 0x28, 0x00,                                   // 49
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 52
+        OPCODE_HALT,                                                      // 55
+    };
+    EXPECT_EQ(run_guest(code), 41);
+}
+
+TEST(ForkTest, UnwaitedChildrenAreReapedOnDestruction) {
+    // Four children that are never waited for; halting leaves them to ~vm
+    std::vector<byte_t> code = {
+        OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,
+        OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,
+        OPCODE_SYS_FUNC, SYSCALL_FORK & 0xFF, SYSCALL_FORK >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0);
+}
+
+TEST(ForkTest, WaitRejectsUnknownHandle) {
+    std::vector<byte_t> code = {
+        OPCODE_PUSHW_IMM_W, 0x09, 0x00,
+        OPCODE_SYS_FUNC, SYSCALL_WAIT & 0xFF, SYSCALL_WAIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_THROW(run_guest(code), lvm::runtime_error);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    // Three pages of data, so linear addresses reach past 64KB
+    constexpr addr32_t DATA_CAPACITY = 0x30000;
+
+    word_t run_guest(const std::vector<byte_t>& code, addr32_t data_capacity = DATA_CAPACITY) {
+        vm machine(1024, 65536, data_capacity);
+        ArchiveMember member{"linear", code, {}, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+}
+
+TEST(LinearAddressingTest, WideAddressReachesPastFirstPage) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x12, 0x34,
+        OPCODE_STX_ADDR32_REG_W, 0x10, 0x00, 0x02, 0x00, 0x01,           // STX 0x00020010, AX
+        OPCODE_LDX_REG_ADDR32_W, 0x02, 0x10, 0x00, 0x02, 0x00,           // LDX BX, 0x00020010
+        OPCODE_PUSH_REG_W, 0x02,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x1234);
+}
+
+TEST(LinearAddressingTest, RegisterPairAndWideAddressAgree) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x03, 0x00, 0x01,                            // CX = 0x0001 (high half)
+        OPCODE_LD_REG_IMM_W, 0x04, 0xFF, 0xFF,                            // DX = 0xFFFF (low half)
+        OPCODE_LD_REG_IMM_W, 0x01, 0xBE, 0xEF,
+        OPCODE_STX_PAIR_REG_W, 0x03, 0x04, 0x01,                          // STX CX:DX, AX (straddles pages)
+        OPCODE_LDX_REG_ADDR32_W, 0x02, 0xFF, 0xFF, 0x01, 0x00,           // LDX BX, 0x0001FFFF
+        OPCODE_LD_REG_IMM_W, 0x05, 0x12, 0x00,
+        OPCODE_LDXL_REG_PAIR_B, 0x05, 0x03, 0x04,                         // EX low = byte at CX:DX
+        OPCODE_LD_REG_REG_W, 0x01, 0x02,
+        OPCODE_SUB_REG_W, 0x05,                                           // 0xBEEF - 0x12EF
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0xAC00);
+}
+
+TEST(LinearAddressingTest, ByteStoreKeepsNeighbours) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x11, 0x22,
+        OPCODE_STX_ADDR32_REG_W, 0x00, 0x00, 0x01, 0x00, 0x01,           // [0x10000] = 0x1122
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x99,
+        OPCODE_STXL_ADDR32_REG_B, 0x01, 0x00, 0x01, 0x00, 0x01,          // [0x10001] = 0x99
+        OPCODE_LDX_REG_ADDR32_W, 0x02, 0x00, 0x00, 0x01, 0x00,
+        OPCODE_PUSH_REG_W, 0x02,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x9922);
+}
+
+TEST(LinearAddressingTest, AddressBeyondDataContextIsAnError) {
+    std::vector<byte_t> code = {
+        OPCODE_LDX_REG_ADDR32_W, 0x01, 0x00, 0x00, 0x01, 0x00,           // LDX AX, 0x00010000
+        OPCODE_HALT,
+    };
+    // The default data context is a single 64KB page
+    EXPECT_ANY_THROW(run_guest(code, 32768));
+    EXPECT_NO_THROW(run_guest(code));
+}
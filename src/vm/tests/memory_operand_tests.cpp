@@ -0,0 +1,72 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include "vmemunit.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    word_t run_guest(const std::vector<byte_t>& code, const std::vector<byte_t>& data = {}) {
+        vm machine(1024, 65536, 32768);
+        ArchiveMember member{"memop", code, data, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+}
+
+TEST(MemoryOperandTest, AluReadsWordFromMemory) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x01,
+        OPCODE_ADD_MEM_W, 0x00, 0x02,                                     // AX += [2]
+        OPCODE_XOR_MEM_W, 0x00, 0x00,                                     // AX ^= [0]
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code, {0x0F, 0x00, 0x34, 0x12}), (0x1235 ^ 0x000F));
+}
+
+TEST(MemoryOperandTest, UpdatesWordInPlace) {
+    std::vector<byte_t> code = {
+        OPCODE_ADD_ADDR_IMM_W, 0x00, 0x00, 0x00, 0x05,                   // [0] += 5
+        OPCODE_INC_ADDR, 0x00, 0x00,                                      // [0]++
+        OPCODE_OR_ADDR_IMM_W, 0x00, 0x00, 0x01, 0x00,                    // [0] |= 0x100
+        OPCODE_LDA_REG_ADDR_W, 0x01, 0x00, 0x00,
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code, {0x10, 0x00}), 0x116);
+}
+
+TEST(MemoryOperandTest, UpdatesSetFlags) {
+    // DEC [0] reaches zero, so JPZ takes the branch to the exit with 0x42
+    std::vector<byte_t> code = {
+        OPCODE_DEC_ADDR, 0x00, 0x00,                                      // 0
+        OPCODE_JPZ_ADDR, 0x00, 0x0C,                                      // 3
+        OPCODE_PUSHW_IMM_W, 0x99, 0x00,                                   // 6
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 9
+        OPCODE_PUSHW_IMM_W, 0x42, 0x00,                                   // 12
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 15
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code, {0x01, 0x00}), 0x42);
+}
+
+TEST(MemoryOperandTest, StoresImmediateAcrossBlockBoundary) {
+    // The word straddles two memory blocks and takes the byte-wise path
+    constexpr addr_t address = static_cast<addr_t>(VMemUnit::BLOCK_SIZE - 1);
+    constexpr byte_t high = address >> 8, low = address & 0xFF;
+    std::vector<byte_t> code = {
+        OPCODE_STA_ADDR_IMM_W, high, low, 0xBE, 0xEE,
+        OPCODE_INC_ADDR, high, low,
+        OPCODE_LDA_REG_ADDR_W, 0x02, high, low,
+        OPCODE_PUSH_REG_W, 0x02,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0xBEEF);
+}
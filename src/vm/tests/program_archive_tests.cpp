@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+#include "program_archive.h"
+#include "errors.h"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    // Minimal valid Pendragon 1.0.0 image
+    std::vector<byte_t> make_binary(const std::vector<byte_t>& data, const std::vector<byte_t>& code) {
+        const std::string machine = "Pendragon";
+        std::vector<byte_t> binary;
+        uint16_t header_size = static_cast<uint16_t>(2 + 4 + 1 + machine.size() + 4 + 2);
+        binary = {static_cast<byte_t>(header_size & 0xFF), static_cast<byte_t>(header_size >> 8), 1, 0, 0, 0};
+        binary.push_back(static_cast<byte_t>(machine.size()));
+        binary.insert(binary.end(), machine.begin(), machine.end());
+        binary.insert(binary.end(), {1, 0, 0, 0, 0, 0});   // machine version, empty program name
+        auto put_segment = [&binary](const std::vector<byte_t>& segment) {
+            uint32_t size = static_cast<uint32_t>(segment.size());
+            for (int i = 0; i < 4; ++i) {
+                binary.push_back(static_cast<byte_t>(size >> (8 * i)));
+            }
+            binary.insert(binary.end(), segment.begin(), segment.end());
+        };
+        put_segment(data);
+        put_segment(code);
+        return binary;
+    }
+
+    std::string temp_path(const std::string& name) {
+        return ::testing::TempDir() + name;
+    }
+
+    // Overwrites one little-endian field of an archive on disk
+    template <typename T>
+    void patch(const std::string& path, size_t offset, T value) {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+}
+
+TEST(ProgramArchiveTest, PackAndFindMembers) {
+    std::string path = temp_path("archive_pack_find.par");
+    std::vector<std::pair<std::string, std::vector<byte_t>>> members;
+    for (int i = 0; i < 50; ++i) {
+        std::vector<byte_t> data(i, static_cast<byte_t>(i));
+        std::vector<byte_t> code = {0x01, static_cast<byte_t>(i), 0x00};
+        members.emplace_back("prog" + std::to_string(i), make_binary(data, code));
+    }
+    ProgramArchive::write(path, members);
+
+    ProgramArchive archive(path);
+    ASSERT_EQ(archive.size(), 50u);
+    for (int i = 0; i < 50; ++i) {
+        auto member = archive.find("prog" + std::to_string(i));
+        ASSERT_TRUE(member.has_value());
+        EXPECT_EQ(member->name, "prog" + std::to_string(i));
+        EXPECT_EQ(member->data_segment.size(), static_cast<size_t>(i));
+        ASSERT_EQ(member->code_segment.size(), 3u);
+        EXPECT_EQ(member->code_segment[1], i);
+        EXPECT_EQ(member->image.size(), members[i].second.size());
+        // Members are page aligned within the mapping
+        EXPECT_EQ((member->image.data() - archive.member(0).image.data()) % ProgramArchive::MEMBER_ALIGNMENT, 0);
+    }
+    EXPECT_FALSE(archive.find("prog50").has_value());
+    EXPECT_FALSE(archive.find("").has_value());
+
+    // Index is sorted by name
+    for (size_t i = 1; i < archive.size(); ++i) {
+        EXPECT_LT(archive.member(i - 1).name, archive.member(i).name);
+    }
+    std::remove(path.c_str());
+}
+
+TEST(ProgramArchiveTest, RejectsDuplicateAndInvalidMembers) {
+    std::string path = temp_path("archive_invalid.par");
+    auto binary = make_binary({}, {0x01});
+    EXPECT_THROW(ProgramArchive::write(path, {{"a", binary}, {"a", binary}}), runtime_error);
+    EXPECT_THROW(ProgramArchive::write(path, {{"a", {0x00, 0x01}}}), runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ProgramArchiveTest, RejectsCorruptArchive) {
+    std::string path = temp_path("archive_corrupt.par");
+    ProgramArchive::write(path, {{"a", make_binary({}, {0x01})}});
+
+    // Point the member beyond the end of the file
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(ProgramArchive::HEADER_SIZE + 16);
+        uint64_t bogus = 1ull << 40;
+        file.write(reinterpret_cast<const char*>(&bogus), sizeof(bogus));
+    }
+    EXPECT_THROW(ProgramArchive archive(path), runtime_error);
+
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not an archive at all, just text....";
+    EXPECT_THROW(ProgramArchive archive(path), runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST(ProgramArchiveTest, RejectsOffsetsThatWrapAround) {
+    // Each field is set so that offset + length wraps past 2^64 to a small
+    // value that a naive end-of-range check would accept
+    std::string path = temp_path("archive_wrap.par");
+    const size_t entry = ProgramArchive::HEADER_SIZE;
+    auto rejects = [&](auto write_field) {
+        ProgramArchive::write(path, {{"a", make_binary({}, {0x01})}});
+        write_field();
+        EXPECT_THROW(ProgramArchive archive(path), runtime_error);
+    };
+
+    // Index table: 1 entry of 48 bytes ending at 2^64
+    rejects([&] { patch<uint64_t>(path, 16, 0 - uint64_t{ProgramArchive::INDEX_ENTRY_SIZE}); });
+    // Hash table: 2 buckets of 4 bytes ending at 2^64
+    rejects([&] { patch<uint64_t>(path, 24, 0 - uint64_t{8}); });
+    // Member image: page aligned, its size carries it past 2^64
+    rejects([&] { patch<uint64_t>(path, entry + 16, 0 - uint64_t{ProgramArchive::MEMBER_ALIGNMENT}); });
+    // Name: beyond the end of the names table
+    rejects([&] { patch<uint32_t>(path, entry + 8, 0xFFFFFFF0u); });
+
+    std::remove(path.c_str());
+}
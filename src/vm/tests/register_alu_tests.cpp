@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    word_t run_guest(const std::vector<byte_t>& code) {
+        vm machine(1024, 65536, 32768);
+        ArchiveMember member{"regalu", code, {}, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+}
+
+TEST(RegisterAluTest, OperatesOnAnyRegister) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x02, 0x00, 0x06,
+        OPCODE_LD_REG_IMM_W, 0x03, 0x00, 0x07,
+        OPCODE_MUL_REG_REG_W, 0x02, 0x03,                                 // BX *= CX
+        OPCODE_ADD_REG_IMM_W, 0x02, 0x01, 0x00,                           // BX += 0x100
+        OPCODE_SHL_REG_IMM_W, 0x03, 0x00, 0x04,                           // CX <<= 4
+        OPCODE_OR_REG_REG_W, 0x02, 0x03,                                  // BX |= CX
+        OPCODE_PUSH_REG_W, 0x02,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), (0x12A | 0x70));
+}
+
+TEST(RegisterAluTest, SourceIsReadBeforeDestinationIsWritten) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x04, 0x00, 0x15,
+        OPCODE_ADD_REG_REG_W, 0x04, 0x04,                                 // DX += DX
+        OPCODE_PUSH_REG_W, 0x04,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x2A);
+}
+
+TEST(RegisterAluTest, LeavesAXAloneAndSetsFlags) {
+    // SUB EX, 3 reaches zero, so JPZ takes the branch to the exit with AX
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x42,                            // 0
+        OPCODE_LD_REG_IMM_W, 0x05, 0x00, 0x03,                            // 4
+        OPCODE_SUB_REG_IMM_W, 0x05, 0x00, 0x03,                           // 8
+        OPCODE_JPZ_ADDR, 0x00, 0x15,                                      // 12
+        OPCODE_PUSHW_IMM_W, 0x99, 0x00,                                   // 15
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 18
+        OPCODE_PUSH_REG_W, 0x01,                                          // 21
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,          // 23
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x42);
+}
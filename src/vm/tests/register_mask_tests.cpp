@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    word_t run_guest(const std::vector<byte_t>& code) {
+        vm machine(1024, 65536, 32768);
+        ArchiveMember member{"regmask", code, {}, code};
+        machine.load_program(member, 0);
+        machine.run();
+        return machine.exit_status();
+    }
+}
+
+TEST(RegisterMaskTest, PopmRestoresPushmRegisters) {
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x01,
+        OPCODE_LD_REG_IMM_W, 0x03, 0x00, 0x20,
+        OPCODE_LD_REG_IMM_W, 0x05, 0x03, 0x00,
+        OPCODE_PUSHM_MASK, 0x15,                                          // AX, CX, EX
+        OPCODE_LD_REG_IMM_W, 0x01, 0x00, 0x00,
+        OPCODE_LD_REG_IMM_W, 0x03, 0x00, 0x00,
+        OPCODE_LD_REG_IMM_W, 0x05, 0x00, 0x00,
+        OPCODE_POPM_MASK, 0x15,
+        OPCODE_ADD_REG_W, 0x03,
+        OPCODE_ADD_REG_W, 0x05,
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x0321);
+}
+
+TEST(RegisterMaskTest, PushaLaysOutWordsLikeSinglePushes) {
+    // After PUSHA the top of the stack is EX, then DX
+    std::vector<byte_t> code = {
+        OPCODE_LD_REG_IMM_W, 0x04, 0x00, 0x40,
+        OPCODE_LD_REG_IMM_W, 0x05, 0x00, 0x02,
+        OPCODE_PUSHA,
+        OPCODE_POP_REG_W, 0x01,                                           // AX = EX
+        OPCODE_POP_REG_W, 0x02,                                           // BX = DX
+        OPCODE_ADD_REG_W, 0x02,
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    EXPECT_EQ(run_guest(code), 0x42);
+}
+
+TEST(RegisterMaskTest, PopaUnderflowIsAnError) {
+    // Two words cannot fill five registers
+    std::vector<byte_t> code = {
+        OPCODE_PUSHW_IMM_W, 0x01, 0x00,
+        OPCODE_PUSHW_IMM_W, 0x02, 0x00,
+        OPCODE_POPA,
+        OPCODE_HALT,
+    };
+    EXPECT_ANY_THROW(run_guest(code));
+}
@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include "guest_scheduler.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <chrono>
+#include <istream>
+#include <memory>
+#include <mutex>
+#include <streambuf>
+#include <thread>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    // BX outer passes of an inner loop counting CX down from 0x400, then
+    // halt; DEC sets the zero flag, so each inner pass is two instructions
+    std::vector<byte_t> busy_loop(byte_t outer) {
+        return {
+            OPCODE_LD_REG_IMM_W, 0x02, 0x00, outer,                           // 0
+            OPCODE_LD_REG_IMM_W, 0x03, 0x04, 0x00,                            // 4
+            OPCODE_DEC_REG, 0x03,                                             // 8
+            OPCODE_JPNZ_ADDR, 0x00, 0x08,                                     // 10
+            OPCODE_DEC_REG, 0x02,                                             // 13
+            OPCODE_JPNZ_ADDR, 0x00, 0x04,                                     // 15
+            OPCODE_HALT,                                                      // 18
+        };
+    }
+
+    uint64_t busy_loop_length(byte_t outer) {
+        return 2 + outer * (3 + 2 * 0x400ull);
+    }
+
+    // Reads one line and exits with its length
+    std::vector<byte_t> read_line_and_exit() {
+        return {
+            OPCODE_PUSHW_IMM_W, 0x20, 0x00,
+            OPCODE_SYS_FUNC, SYSCALL_READ_LINE_ONTO_STACK & 0xFF, SYSCALL_READ_LINE_ONTO_STACK >> 8,
+            OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+            OPCODE_HALT,
+        };
+    }
+
+    std::unique_ptr<vm> make_guest(const std::vector<byte_t>& code, const std::vector<byte_t>& data = {}) {
+        auto machine = std::make_unique<vm>(1024, 65536, 65536);
+        ArchiveMember member{"guest", code, data, code};
+        machine->load_program(member, 0);
+        return machine;
+    }
+
+    // Input that another thread can append to while the guest polls it
+    class FeedBuffer : public std::streambuf {
+    public:
+        void feed(const std::string& text) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pending_ += text;
+        }
+    protected:
+        std::streamsize showmanyc() override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return static_cast<std::streamsize>(pending_.size());
+        }
+        int_type underflow() override {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (pending_.empty()) {
+                return traits_type::eof();
+            }
+            current_.swap(pending_);
+            pending_.clear();
+            setg(current_.data(), current_.data(), current_.data() + current_.size());
+            return traits_type::to_int_type(current_[0]);
+        }
+    private:
+        std::mutex mutex_;
+        std::string pending_;
+        std::string current_;
+    };
+}
+
+TEST(GuestSchedulerTest, RunsEveryGuestToCompletion) {
+    std::vector<std::unique_ptr<vm>> guests;
+    GuestScheduler scheduler(2, 1024);
+    for (int i = 0; i < 5; ++i) {
+        guests.push_back(make_guest(busy_loop(1)));
+        scheduler.add(*guests.back());
+    }
+    scheduler.run();
+
+    double total_share = 0.0;
+    for (const auto& stats : scheduler.stats()) {
+        EXPECT_TRUE(stats.finished);
+        EXPECT_TRUE(stats.error.empty());
+        EXPECT_EQ(stats.instructions, busy_loop_length(1));
+        EXPECT_GT(stats.slices, 1u);
+        total_share += stats.cpu_share;
+    }
+    EXPECT_NEAR(total_share, 1.0, 1e-9);
+}
+
+TEST(GuestSchedulerTest, WeightsSplitOneWorker) {
+    // Same work on one worker: the guest with three times the weight runs
+    // three slices for each of the other's and finishes first
+    auto light = make_guest(busy_loop(16));
+    auto heavy = make_guest(busy_loop(16));
+    GuestScheduler scheduler(1, 1024);
+    auto light_id = scheduler.add(*light, 1);
+    auto heavy_id = scheduler.add(*heavy, 3);
+    scheduler.run();
+
+    auto stats = scheduler.stats();
+    EXPECT_EQ(stats[light_id].instructions, stats[heavy_id].instructions);
+    EXPECT_LT(stats[heavy_id].turnaround, stats[light_id].turnaround);
+}
+
+TEST(GuestSchedulerTest, HigherPriorityRunsFirst) {
+    auto background = make_guest(busy_loop(16));
+    auto foreground = make_guest(busy_loop(4));
+    GuestScheduler scheduler(1, 1024);
+    auto background_id = scheduler.add(*background, 8, 0);
+    auto foreground_id = scheduler.add(*foreground, 1, 1);
+    scheduler.run();
+
+    auto stats = scheduler.stats();
+    EXPECT_LT(stats[foreground_id].turnaround, stats[background_id].turnaround);
+    // The background guest never ran before the foreground one finished
+    EXPECT_LT(stats[foreground_id].max_ready_latency, stats[background_id].max_ready_latency);
+}
+
+TEST(GuestSchedulerTest, GuestWaitingForInputIsParked) {
+    FeedBuffer buffer;
+    std::istream input(&buffer);
+    auto reader = make_guest(read_line_and_exit());
+    reader->set_input(input);
+    auto busy = make_guest(busy_loop(64));
+
+    GuestScheduler scheduler(1, 1024);
+    auto reader_id = scheduler.add(*reader, 1, 1);
+    auto busy_id = scheduler.add(*busy);
+    std::thread feeder([&] {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        buffer.feed("hello\n");
+        scheduler.wake();
+    });
+    scheduler.run();
+    feeder.join();
+
+    auto stats = scheduler.stats();
+    EXPECT_TRUE(stats[reader_id].finished);
+    EXPECT_GE(stats[reader_id].parks, 1u);
+    EXPECT_EQ(stats[reader_id].exit_status, 5);
+    // While parked the reader held no worker, so the busy guest kept running
+    EXPECT_TRUE(stats[busy_id].finished);
+    EXPECT_GT(stats[busy_id].slices, stats[reader_id].slices);
+    // Woken input is picked up within a poll interval and one slice
+    EXPECT_LT(stats[reader_id].max_ready_latency, std::chrono::milliseconds(50));
+}
+
+TEST(GuestSchedulerTest, RuntimeErrorFinishesOnlyThatGuest) {
+    auto broken = make_guest({OPCODE_SYS_FUNC, 0xFF, 0xFF});
+    auto healthy = make_guest(busy_loop(1));
+    GuestScheduler scheduler(1);
+    auto broken_id = scheduler.add(*broken);
+    auto healthy_id = scheduler.add(*healthy);
+    scheduler.run();
+
+    auto stats = scheduler.stats();
+    EXPECT_TRUE(stats[broken_id].finished);
+    EXPECT_EQ(stats[broken_id].exit_status, vm::FAILED_EXIT_STATUS);
+    EXPECT_FALSE(stats[broken_id].error.empty());
+    EXPECT_TRUE(stats[healthy_id].finished);
+    EXPECT_EQ(stats[healthy_id].exit_status, 0);
+}
+
+TEST(GuestSchedulerTest, MergesIdenticalMemoryBetweenSlices) {
+    // Every guest loads the same page of data, then loops and exits with
+    // data[0]; the merge passes share the copies while the guests run
+    std::vector<byte_t> code = busy_loop(8);
+    code.pop_back();
+    std::vector<byte_t> exit_with_data = {
+        OPCODE_LDAL_REG_ADDR_B, 0x01, 0x00, 0x00,
+        OPCODE_PUSH_REG_W, 0x01,
+        OPCODE_SYS_FUNC, SYSCALL_EXIT & 0xFF, SYSCALL_EXIT >> 8,
+        OPCODE_HALT,
+    };
+    code.insert(code.end(), exit_with_data.begin(), exit_with_data.end());
+    std::vector<byte_t> data(VMemUnit::BLOCK_SIZE, 0x5A);
+
+    std::vector<std::unique_ptr<vm>> guests;
+    GuestScheduler scheduler(1, 1024);
+    scheduler.set_dedup_interval(std::chrono::microseconds(1));
+    for (int i = 0; i < 4; ++i) {
+        guests.push_back(make_guest(code, data));
+        scheduler.add(*guests.back());
+    }
+    scheduler.run();
+
+    EXPECT_GT(scheduler.dedup_passes(), 0u);
+    auto dedup = scheduler.dedup_stats();
+    EXPECT_GE(dedup.blocks_merged, 3u);
+    EXPECT_GE(dedup.bytes_saved, 3 * VMemUnit::BLOCK_SIZE);
+    for (const auto& stats : scheduler.stats()) {
+        EXPECT_TRUE(stats.finished);
+        EXPECT_EQ(stats.exit_status, 0x5A);
+    }
+}
@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "trace.h"
+#include "vm.h"
+#include "opcodes.h"
+#include "systemcalls.h"
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    std::string read_trace(const std::string& path) {
+        std::ifstream file(path);
+        std::stringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    size_t count(const std::string& text, const std::string& needle) {
+        size_t n = 0;
+        for (size_t pos = text.find(needle); pos != std::string::npos; pos = text.find(needle, pos + 1)) {
+            ++n;
+        }
+        return n;
+    }
+
+    std::string temp_path(const std::string& name) {
+        return ::testing::TempDir() + name;
+    }
+}
+
+TEST(TraceTest, DisabledHooksRecordNothing) {
+    {
+        trace::Span span("ignored", "test");
+        trace::instant("ignored", "test");
+    }
+    std::string path = temp_path("trace_disabled.json");
+    trace::start(path);
+    trace::stop();
+
+    std::string json = read_trace(path);
+    EXPECT_NE(json.find("\"traceEvents\":["), std::string::npos);
+    EXPECT_EQ(count(json, "\"name\""), 0u);
+}
+
+TEST(TraceTest, ThreadBuffersAreMergedOnStop) {
+    std::string path = temp_path("trace_threads.json");
+    trace::start(path);
+    {
+        trace::Span outer("outer", "test");
+        std::vector<std::thread> workers;
+        for (int i = 0; i < 3; ++i) {
+            workers.emplace_back([i] {
+                trace::Span span("worker", "test", "index", i);
+                trace::instant("tick", "test");
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+    trace::stop();
+
+    std::string json = read_trace(path);
+    EXPECT_EQ(count(json, "\"name\":\"worker\""), 3u);
+    EXPECT_EQ(count(json, "\"name\":\"tick\""), 3u);
+    EXPECT_EQ(count(json, "\"name\":\"outer\""), 1u);
+    EXPECT_EQ(count(json, "\"ph\":\"X\""), 4u);
+    EXPECT_NE(json.find("\"args\":{\"index\":2}"), std::string::npos);
+
+    // Stopping again writes nothing new and keeps the file intact
+    trace::stop();
+    EXPECT_EQ(read_trace(path), json);
+}
+
+TEST(TraceTest, VmRunRecordsTimeline) {
+    std::string path = temp_path("trace_vm.json");
+    trace::start(path);
+    {
+        vm machine(1024, 65536, 32768);
+        std::vector<byte_t> code = {
+            OPCODE_PUSHW_IMM_W, 0x2A, 0x00,
+            OPCODE_SYS_FUNC, SYSCALL_DEBUG_PRINT_WORD & 0xFF, SYSCALL_DEBUG_PRINT_WORD >> 8,
+            OPCODE_PAGE_IMM_CTX, 0x01, 0x00, 0x00, 0x00,
+            OPCODE_HALT,
+        };
+        ArchiveMember member{"timeline", code, {}, code};
+        machine.load_program(member, 0);
+        machine.run();
+    }
+    trace::stop();
+
+    std::string json = read_trace(path);
+    EXPECT_EQ(count(json, "\"name\":\"create_context\""), 3u);
+    EXPECT_EQ(count(json, "\"name\":\"load\""), 1u);
+    EXPECT_EQ(count(json, "\"name\":\"run\""), 1u);
+    EXPECT_NE(json.find("\"name\":\"syscall debug_print_word\",\"cat\":\"syscall\",\"ph\":\"X\""), std::string::npos);
+    EXPECT_NE(json.find("\"name\":\"page_switch\""), std::string::npos);
+    EXPECT_NE(json.find("\"args\":{\"page\":1}"), std::string::npos);
+    EXPECT_EQ(count(json, "\"name\":\"halt\""), 1u);
+}
@@ -1,47 +1,90 @@
 #include "vm.h"
 #include "binary_loader.h"
+#include "helpers.h"
+#include "trace.h"
+#include "probes.h"
+#include "guest_pool.h"
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
 
 using namespace lvm;
 
 vm::vm(addr32_t stack_capacity, addr32_t code_capacity, addr32_t data_capacity)
-    : vmem_unit(std::make_shared<VMemUnit>())
+    // CPU first (creates the data context and flags), then the stack in
+    // UNPROTECTED mode, BasicIO over stack and memory, and finally the
+    // instruction unit over its own code context, sharing the CPU's flags
+    : cpu_instance(borrow_shared(vmem_unit), data_capacity),
+      stack(borrow_shared(vmem_unit), stack_capacity),
+      basic_io(borrow_shared(vmem_unit), borrow_shared(stack)),
+      code_context_id_(vmem_unit.create_context(code_capacity)),
+      data_context_id_(cpu_instance.get_data_context_id()),
+      instruction_unit(borrow_shared(vmem_unit), code_context_id_, stack, cpu_instance.get_flags(),
+                       borrow_shared(basic_io)),
+      stack_capacity_(stack_capacity),
+      code_capacity_(code_capacity),
+      data_capacity_(data_capacity)
 {
-    // Create CPU first (creates contexts and flags)
-    cpu_instance = std::make_shared<Cpu>(vmem_unit, stack_capacity, code_capacity);
-    
-    // Get flags from CPU to share with instruction unit
-    flags = cpu_instance->get_flags();
-    
-    // Create stack in UNPROTECTED mode
-    stack = std::make_shared<Stack>(vmem_unit, stack_capacity);
-    
-    // Create BasicIO with stack and memory
-    basic_io = std::make_shared<BasicIO>(vmem_unit, stack);
-    
-    // Create code context for instruction unit
-    code_context_id_ = vmem_unit->create_context(code_capacity);
-    
-    // Use CPU's data context (don't create a duplicate)
-    data_context_id_ = cpu_instance->get_data_context_id();
-    
-    // Create instruction unit in UNPROTECTED mode with stack interface
-    // Use CPU's flags to ensure registers and instruction unit share state
-    instruction_unit = std::make_shared<InstructionUnit>(vmem_unit, code_context_id_, *stack, flags, basic_io);
-    
     // Inject dependencies into CPU
-    cpu_instance->set_stack(stack);
-    cpu_instance->set_instruction_unit(instruction_unit);
+    cpu_instance.set_stack(borrow_shared(stack));
+    cpu_instance.set_instruction_unit(borrow_shared(instruction_unit));
+    instruction_unit.set_data_context(data_context_id_);
+    basic_io.set_data_context(data_context_id_);
+    instruction_unit.set_process_control(borrow_shared(*this));
     
     // Initialize CPU
-    cpu_instance->initialize();
+    cpu_instance.initialize();
 }
 
+// A forked guest and its result. Whichever comes first, a pool worker or
+// the parent's WAIT, runs it; the other only waits for it to finish.
+struct vm::Child {
+    enum State : int { PENDING, RUNNING, DONE };
+    std::unique_ptr<vm> machine;
+    std::atomic<int> state{PENDING};
+    word_t status = 0;
+
+    void run() {
+        int expected = PENDING;
+        if (!state.compare_exchange_strong(expected, RUNNING)) {
+            return;
+        }
+        try {
+            machine->run();
+            status = machine->exit_status();
+        } catch (const std::exception& e) {
+            std::cerr << "Forked guest failed: " << e.what() << std::endl;
+            status = FAILED_EXIT_STATUS;
+        }
+        // Drops the child's references to shared blocks as soon as it is done
+        machine.reset();
+        state.store(DONE, std::memory_order_release);
+        state.notify_all();
+    }
+
+    word_t wait() {
+        run();
+        for (int current = state.load(std::memory_order_acquire); current != DONE;
+             current = state.load(std::memory_order_acquire)) {
+            state.wait(current);
+        }
+        return status;
+    }
+};
+
 vm::~vm() {
-    // Destructor
+    for (auto& child : children_) {
+        if (child) {
+            child->wait();
+        }
+    }
 }
 
 void vm::load_program(char* fileName, addr_t load_address) {
     // Load program from binary file
+    trace::Span span("load", "vm");
     BinaryLoader loader;
     
     try {
@@ -49,25 +92,10 @@ void vm::load_program(char* fileName, addr_t load_address) {
         BinaryProgram program = loader.load_file(fileName);
         
         // Load data segment into data context if present
-        if (!program.data_segment.empty()) {
-            vmem_unit->set_mode(IVMemUnit::Mode::PROTECTED);
-            auto data_ctx = vmem_unit->get_context(data_context_id_);
-            auto data_accessor = data_ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
-            
-            // Write data segment starting at load_address
-            addr32_t current_addr = load_address;
-            for (byte_t byte : program.data_segment) {
-                page_t page = current_addr >> 16;  // High 16 bits
-                addr_t offset = current_addr & 0xFFFF;  // Low 16 bits
-                data_accessor->set_page(page);
-                data_accessor->write_byte(offset, byte);
-                current_addr++;
-            }
-            vmem_unit->set_mode(IVMemUnit::Mode::UNPROTECTED);
-        }
+        load_data_segment(program.data_segment, load_address);
 
         // Load code segment into CPU
-        cpu_instance->load_program(program.code_segment);
+        cpu_instance.load_program(program.code_segment);
         
     } catch (const runtime_error& e) {
         // Re-throw with context
@@ -75,7 +103,149 @@ void vm::load_program(char* fileName, addr_t load_address) {
     }
 }
 
+void vm::load_program(const ArchiveMember& member, addr_t load_address) {
+    trace::Span span("load", "vm");
+    try {
+        load_data_segment(member.data_segment, load_address);
+        cpu_instance.load_program(member.code_segment);
+    } catch (const runtime_error& e) {
+        throw runtime_error("Failed to load archive member '" + std::string(member.name) + "': " + e.what());
+    }
+}
+
+void vm::load_program_streaming(const std::string& fileName, addr_t load_address) {
+    // Covers header and data only; code keeps arriving while the guest runs
+    trace::Span span("load", "vm");
+    try {
+        if (fileName == "-") {
+            streaming_loader = std::make_shared<StreamingBinaryLoader>(std::cin);
+        } else {
+            auto file = std::make_unique<std::ifstream>(fileName, std::ios::binary);
+            if (!file->is_open()) {
+                throw runtime_error("Failed to open binary file: " + fileName);
+            }
+            streaming_loader = std::make_shared<StreamingBinaryLoader>(std::move(file));
+        }
+
+        // Header and data arrive first; code keeps streaming after this returns
+        streaming_loader->start(code_capacity_, data_capacity_);
+        load_data_segment(streaming_loader->get_data_segment(), load_address);
+        instruction_unit.set_code_source(streaming_loader);
+
+    } catch (const runtime_error& e) {
+        throw runtime_error("Failed to load program '" + fileName + "': " + e.what());
+    }
+}
+
+void vm::load_data_segment(std::span<const byte_t> data_segment, addr_t load_address) {
+    if (data_segment.empty()) {
+        return;
+    }
+    vmem_unit.set_mode(IVMemUnit::Mode::PROTECTED);
+    auto data_ctx = vmem_unit.get_context(data_context_id_);
+    auto data_accessor = data_ctx->create_paged_accessor(MemAccessMode::READ_WRITE);
+    
+    // Write data segment starting at load_address
+    addr32_t current_addr = load_address;
+    for (byte_t byte : data_segment) {
+        page_t page = current_addr >> 16;  // High 16 bits
+        addr_t offset = current_addr & 0xFFFF;  // Low 16 bits
+        data_accessor->set_page(page);
+        data_accessor->write_byte(offset, byte);
+        current_addr++;
+    }
+    vmem_unit.set_mode(IVMemUnit::Mode::UNPROTECTED);
+}
+
+void vm::enable_swap(const std::string& swap_path, size_t max_resident_blocks) {
+    vmem_unit.enable_swap(swap_path, max_resident_blocks);
+}
+
+void vm::enable_async_output(AsyncOutput::FullPolicy policy) {
+    basic_io.enable_async_output(STDOUT_FILENO, AsyncOutput::DEFAULT_CAPACITY, policy);
+}
+
 void vm::run() {
-    cpu_instance->run();
+    trace::Span span("run", "vm");
+    // Guest output must be out before anything the host prints afterwards
+    try {
+        cpu_instance.run();
+    } catch (...) {
+        basic_io.flush_output();
+        throw;
+    }
+    basic_io.flush_output();
+}
+
+VMemUnit::DedupStats vm::merge_duplicate_memory(const std::vector<vm*>& machines) {
+    trace::Span span("dedup", "memory");
+    std::vector<VMemUnit*> units;
+    units.reserve(machines.size());
+    for (vm* machine : machines) {
+        units.push_back(&machine->vmem_unit);
+    }
+    return VMemUnit::merge_duplicate_blocks(units);
+}
+
+Cpu::SliceResult vm::run_slice(uint64_t budget, uint64_t& executed) {
+    Cpu::SliceResult result;
+    try {
+        result = cpu_instance.run_slice(budget, executed);
+    } catch (...) {
+        basic_io.flush_output();
+        throw;
+    }
+    // A prompt must be visible before the guest waits for its answer
+    if (result != Cpu::SliceResult::PREEMPTED) {
+        basic_io.flush_output();
+    }
+    return result;
+}
+
+word_t vm::fork() {
+    trace::Span span("fork", "vm");
+    auto slot = std::find(children_.begin(), children_.end(), nullptr);
+    if (slot == children_.end() && children_.size() >= MAX_CHILDREN) {
+        throw runtime_error("Too many forked children");
+    }
+
+    // Output the parent queued before the fork comes out before the child's
+    basic_io.flush_output();
+
+    auto child = std::make_shared<Child>();
+    child->machine = std::make_unique<vm>(stack_capacity_, code_capacity_, data_capacity_);
+    vm& machine = *child->machine;
+    machine.vmem_unit.fork_from(vmem_unit);
+    machine.cpu_instance.fork_from(cpu_instance);
+    machine.stack.fork_from(stack);
+    machine.instruction_unit.fork_from(instruction_unit);
+
+    // The child's FORK result
+    machine.vmem_unit.set_mode(IVMemUnit::Mode::PROTECTED);
+    machine.stack.get_accessor(MemAccessMode::READ_WRITE)->push_word(0);
+    machine.vmem_unit.set_mode(IVMemUnit::Mode::UNPROTECTED);
+
+    size_t index = static_cast<size_t>(slot - children_.begin());
+    if (slot == children_.end()) {
+        children_.push_back(child);
+    } else {
+        *slot = child;
+    }
+    GuestPool::shared().submit([child] { child->run(); });
+    return static_cast<word_t>(index + 1);
 }
 
+word_t vm::wait(word_t child) {
+    if (child == 0 || child > children_.size() || !children_[child - 1]) {
+        throw runtime_error("Invalid child handle: " + std::to_string(child));
+    }
+    std::shared_ptr<Child> waited = std::move(children_[child - 1]);
+    trace::Span span("wait", "vm", "child", child);
+    return waited->wait();
+}
+
+void vm::exit(word_t status) {
+    exit_status_ = status;
+    LVM_PROBE1(halt, status);
+    cpu_instance.halt();
+}
@@ -2,22 +2,31 @@
 #include "assembler/parser/parser.h"
 #include "assembler/semantic/semantic_analyzer.h"
 #include "assembler/semantic/instruction_rewriter.h"
+#include "assembler/semantic/register_allocator.h"
 #include "assembler/ir/code_graph_builder.h"
+#include "assembler/ir/encoding_selector.h"
+#include "assembler/ir/dataflow_optimizer.h"
 #include "assembler/codegen/address_resolver.h"
 #include "assembler/codegen/binary_writer.h"
+#include "trace.h"
 #include <iostream>
 #include <fstream>
 #include <string>
 #include <cstring>
+#include <cstdlib>
 
 using namespace lvm;
 using namespace lvm::assembler;
 
 void print_usage(const char* program_name) {
-    std::cout << "Usage: " << program_name << " <input.asm> [-o <output.bin>] [-v]" << std::endl;
+    std::cout << "Usage: " << program_name << " <input.asm> [-o <output.bin>] [-j <threads>] [-O<level>] [--linear] [--trace <trace.json>] [-v]" << std::endl;
     std::cout << std::endl;
     std::cout << "Options:" << std::endl;
     std::cout << "  -o <file>    Output binary file (default: out.bin)" << std::endl;
+    std::cout << "  -j <n>       Worker threads for fix-up and encoding (default: all cores, 1 = serial)" << std::endl;
+    std::cout << "  -O<n>        Optimization level (default: 0; -O or -O1 merges PUSH/POP runs; 2 adds data-flow optimization)" << std::endl;
+    std::cout << "  --linear     Address data linearly with LDX/STX (no PAGE switches; run with lvm --data-size)" << std::endl;
+    std::cout << "  --trace <f>  Write a Chrome trace-event timeline of the passes" << std::endl;
     std::cout << "  -v           Verbose output" << std::endl;
     std::cout << "  -h, --help   Show this help message" << std::endl;
 }
@@ -42,6 +51,9 @@ int main(int argc, char* argv[]) {
     std::string input_file;
     std::string output_file = "out.bin";
     bool verbose = false;
+    unsigned threads = 0;
+    int opt_level = 0;
+    bool linear = false;
     
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
@@ -54,6 +66,24 @@ int main(int argc, char* argv[]) {
                 std::cerr << "Error: -o requires an argument" << std::endl;
                 return 1;
             }
+        } else if (strcmp(argv[i], "-j") == 0) {
+            if (i + 1 < argc) {
+                threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            } else {
+                std::cerr << "Error: -j requires an argument" << std::endl;
+                return 1;
+            }
+        } else if (strncmp(argv[i], "-O", 2) == 0) {
+            opt_level = argv[i][2] ? std::atoi(argv[i] + 2) : 1;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            if (i + 1 < argc) {
+                trace::start(argv[++i]);
+            } else {
+                std::cerr << "Error: --trace requires an argument" << std::endl;
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--linear") == 0) {
+            linear = true;
         } else if (strcmp(argv[i], "-v") == 0) {
             verbose = true;
         } else if (input_file.empty()) {
@@ -81,9 +111,11 @@ int main(int argc, char* argv[]) {
         
         // Pass 1: Lexer + Parser
         if (verbose) std::cout << "Pass 1: Lexing and parsing..." << std::endl;
+        trace::Span parse_span("lex/parse", "asm");
         Lexer lexer(source);
         Parser parser(lexer);
         auto ast = parser.parse();
+        parse_span.end();
         
         if (parser.has_errors()) {
             std::cerr << "Parse errors:" << std::endl;
@@ -95,14 +127,37 @@ int main(int argc, char* argv[]) {
         
         // Pass 1.5: Rewrite syntactic sugar
         if (verbose) std::cout << "Pass 1.5: Rewriting syntactic sugar..." << std::endl;
+        trace::Span rewrite_span("rewrite", "asm");
         InstructionRewriter rewriter;
         rewriter.rewrite(*ast);
+        rewrite_span.end();
+        
+        // Pass 1.6: Map virtual registers onto AX-EX
+        if (verbose) std::cout << "Pass 1.6: Allocating virtual registers..." << std::endl;
+        trace::Span allocate_span("regalloc", "asm");
+        RegisterAllocator allocator;
+        bool allocated = allocator.allocate(*ast);
+        allocate_span.end();
+        if (!allocated) {
+            std::cerr << "Register allocation errors:" << std::endl;
+            for (const auto& error : allocator.errors()) {
+                std::cerr << "  " << error.to_string() << std::endl;
+            }
+            return 1;
+        }
+        if (verbose && allocator.spilled_count() > 0) {
+            std::cout << "  Spilled " << allocator.spilled_count() << " virtual register(s)" << std::endl;
+        }
         
         // Pass 2: Semantic analysis
         if (verbose) std::cout << "Pass 2: Semantic analysis..." << std::endl;
         SymbolTable symbol_table;
         SemanticAnalyzer analyzer(symbol_table);
-        if (!analyzer.analyze(*ast)) {
+        analyzer.set_linear_addressing(linear);
+        trace::Span semantic_span("semantic", "asm");
+        bool analyzed = analyzer.analyze(*ast);
+        semantic_span.end();
+        if (!analyzed) {
             std::cerr << "Semantic errors:" << std::endl;
             for (const auto& error : analyzer.errors()) {
                 std::cerr << "  " << error.to_string() << std::endl;
@@ -112,8 +167,11 @@ int main(int argc, char* argv[]) {
         
         // Pass 3: Build code graph
         if (verbose) std::cout << "Pass 3: Building code graph..." << std::endl;
+        trace::Span graph_span("graph", "asm");
         CodeGraphBuilder builder(symbol_table, &analyzer);
+        builder.set_linear_addressing(linear);
         auto graph = builder.build(*ast);
+        graph_span.end();
         
         if (builder.has_errors()) {
             std::cerr << "Code graph errors:" << std::endl;
@@ -123,10 +181,42 @@ int main(int argc, char* argv[]) {
             return 1;
         }
         
+        // Pass 3.3: Copy propagation and dead write elimination
+        if (opt_level >= 2) {
+            if (verbose) std::cout << "Pass 3.3: Data-flow optimization..." << std::endl;
+            trace::Span optimize_span("optimize", "asm");
+            DataflowOptimizer optimizer;
+            uint32_t optimized = optimizer.optimize(*graph);
+            optimize_span.end();
+            if (verbose) {
+                std::cout << "  Propagated " << optimizer.propagated_count() << " copy operand(s), removed "
+                          << optimizer.removed_count() << " dead write(s) and "
+                          << optimizer.dead_store_count() << " dead store(s), saved "
+                          << optimized << " byte(s)" << std::endl;
+            }
+        }
+        
+        // Pass 3.5: Pick the shortest equivalent encodings before layout
+        if (verbose) std::cout << "Pass 3.5: Selecting encodings..." << std::endl;
+        trace::Span select_span("select", "asm");
+        EncodingSelector selector(opt_level >= 1);
+        uint32_t saved = selector.select(*graph);
+        select_span.end();
+        if (verbose && saved > 0) {
+            std::cout << "  Shortened " << selector.rewritten_count() << " instruction(s), merged "
+                      << selector.merged_count() << " push/pop run(s), saved "
+                      << saved << " byte(s)" << std::endl;
+        }
+        
         // Pass 4: Resolve addresses
         if (verbose) std::cout << "Pass 4: Resolving addresses..." << std::endl;
         AddressResolver resolver(symbol_table, *graph);
-        if (!resolver.resolve()) {
+        resolver.set_thread_count(threads);
+        resolver.set_linear_addressing(linear);
+        trace::Span resolve_span("resolve", "asm");
+        bool resolved = resolver.resolve();
+        resolve_span.end();
+        if (!resolved) {
             std::cerr << "Address resolution errors:" << std::endl;
             for (const auto& error : resolver.errors()) {
                 std::cerr << "  " << error << std::endl;
@@ -137,6 +227,7 @@ int main(int argc, char* argv[]) {
         // Pass 5: Generate binary
         if (verbose) std::cout << "Pass 5: Generating binary..." << std::endl;
         BinaryWriter writer;
+        writer.set_thread_count(threads);
         
         // Extract program name from input filename
         std::string program_name = input_file;
@@ -149,7 +240,9 @@ int main(int argc, char* argv[]) {
             program_name = program_name.substr(0, last_dot);
         }
         
+        trace::Span write_span("write", "asm");
         writer.write_binary(*graph, output_file, program_name);
+        write_span.end();
         
         if (verbose) {
             std::cout << "Successfully assembled to: " << output_file << std::endl;
@@ -0,0 +1,88 @@
+// Micro-benchmark for ALU instruction dispatch.
+// Runs a tight loop of mixed-form ALU/compare instructions through the CPU
+// and reports executed instructions per second.
+#include "vmemunit.h"
+#include "stack.h"
+#include "instruction_unit.h"
+#include "basic_io.h"
+#include "cpu.h"
+#include "opcodes.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    void emit_word(std::vector<byte_t>& code, word_t value) {
+        code.push_back(static_cast<byte_t>(value >> 8));
+        code.push_back(static_cast<byte_t>(value & 0xFF));
+    }
+
+    // Outer loop on DX, inner loop of 65535 iterations on CX
+    std::vector<byte_t> build_program(word_t outer_iterations, size_t& instructions_per_inner) {
+        std::vector<byte_t> code;
+        code.push_back(OPCODE_LD_REG_IMM_W); code.push_back(REG_DX); emit_word(code, outer_iterations);
+        code.push_back(OPCODE_LD_REG_IMM_W); code.push_back(REG_BX); emit_word(code, 0x1234);
+        addr_t outer = static_cast<addr_t>(code.size());
+        code.push_back(OPCODE_LD_REG_IMM_W); code.push_back(REG_CX); emit_word(code, 0xFFFF);
+        addr_t inner = static_cast<addr_t>(code.size());
+
+        code.push_back(OPCODE_ADD_IMM_W); emit_word(code, 0x0101);
+        code.push_back(OPCODE_ADD_REG_W); code.push_back(REG_BX);
+        code.push_back(OPCODE_ADB_IMM_B); code.push_back(0x11);
+        code.push_back(OPCODE_SBL_REG_B); code.push_back(REG_CX);
+        code.push_back(OPCODE_XOR_IMM_W); emit_word(code, 0x5A5A);
+        code.push_back(OPCODE_ANH_REG_B); code.push_back(REG_BX);
+        code.push_back(OPCODE_SLB_IMM_B); code.push_back(0x01);
+        code.push_back(OPCODE_ROR_REG_W); code.push_back(REG_DX);
+        code.push_back(OPCODE_CMP_REG_IMM_W); code.push_back(REG_BX); emit_word(code, 0x1234);
+        code.push_back(OPCODE_CPL_REG_REG); code.push_back(REG_CX); code.push_back(REG_BX);
+        code.push_back(OPCODE_DEC_REG); code.push_back(REG_CX);
+        code.push_back(OPCODE_JPNZ_ADDR); emit_word(code, inner);
+        instructions_per_inner = 12;
+
+        code.push_back(OPCODE_DEC_REG); code.push_back(REG_DX);
+        code.push_back(OPCODE_JPNZ_ADDR); emit_word(code, outer);
+        code.push_back(OPCODE_HALT);
+        return code;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    word_t outer_iterations = argc > 1 ? static_cast<word_t>(std::atoi(argv[1])) : 16;
+    if (outer_iterations == 0) {
+        std::cerr << "Iteration count must be between 1 and 65535" << std::endl;
+        return 1;
+    }
+
+    const addr32_t stack_capacity = 4096;
+    const addr32_t code_capacity = 65536;
+
+    // Wire up components the same way vm does
+    auto vmem_unit = std::make_shared<VMemUnit>();
+    auto cpu = std::make_shared<Cpu>(vmem_unit);
+    auto stack = std::make_shared<Stack>(vmem_unit, stack_capacity);
+    auto basic_io = std::make_shared<BasicIO>(vmem_unit, stack);
+    context_id_t code_context = vmem_unit->create_context(code_capacity);
+    auto instruction_unit = std::make_shared<InstructionUnit>(
+        vmem_unit, code_context, *stack, cpu->get_flags(), basic_io);
+    cpu->set_stack(stack);
+    cpu->set_instruction_unit(instruction_unit);
+    cpu->initialize();
+
+    size_t per_inner = 0;
+    cpu->load_program(build_program(outer_iterations, per_inner));
+
+    auto start = std::chrono::steady_clock::now();
+    cpu->run();
+    auto end = std::chrono::steady_clock::now();
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double instructions = static_cast<double>(outer_iterations) * (65535.0 * per_inner + 3) + 3;
+    std::cout << "Executed " << static_cast<uint64_t>(instructions) << " instructions in "
+              << seconds << " s (" << (instructions / seconds / 1e6) << " M instr/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,60 @@
+// Micro-benchmark for physical block allocation under multi-instance hosting.
+// Each thread repeatedly creates a memory unit, touches every block of a
+// context (forcing a block allocation per 4 KB) and destroys the unit.
+// Reports aggregate blocks per second for 1, 2, 4, ... threads.
+#include "vmemunit.h"
+#include "block_pool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    void churn(size_t units, uint32_t blocks_per_unit) {
+        for (size_t u = 0; u < units; ++u) {
+            VMemUnit unit;
+            context_id_t ctx = unit.create_context(blocks_per_unit * static_cast<uint32_t>(VMemUnit::BLOCK_SIZE));
+            unit.set_mode(IVMemUnit::Mode::PROTECTED);
+            for (uint32_t b = 0; b < blocks_per_unit; ++b) {
+                unit.write_byte(ctx, b * static_cast<uint32_t>(VMemUnit::BLOCK_SIZE), static_cast<byte_t>(b));
+            }
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t units = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000;
+    uint32_t blocks_per_unit = argc > 2 ? static_cast<uint32_t>(std::atol(argv[2])) : 64;
+    unsigned max_threads = argc > 3 ? static_cast<unsigned>(std::atol(argv[3]))
+                                    : std::max(1u, std::thread::hardware_concurrency());
+    if (units == 0 || blocks_per_unit == 0) {
+        std::cerr << "Unit and block counts must be at least 1" << std::endl;
+        return 1;
+    }
+
+    double single = 0;
+    for (unsigned threads = 1; threads <= max_threads; threads *= 2) {
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t) {
+            workers.emplace_back(churn, units, blocks_per_unit);
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        double rate = static_cast<double>(units) * blocks_per_unit * threads / seconds;
+        if (threads == 1) {
+            single = rate;
+        }
+        std::cout << threads << " thread(s): " << rate << " blocks/s (" << (rate / single) << "x)" << std::endl;
+    }
+
+    auto stats = BlockPool::stats();
+    std::cout << "Pool: " << stats.slabs << " slabs, " << stats.fresh_blocks << " fresh and "
+              << stats.dirty_blocks << " dirty free blocks" << std::endl;
+    return 0;
+}
@@ -0,0 +1,73 @@
+// Micro-benchmark for VM instance footprint.
+// Creates and destroys idle vm instances and reports instances per second,
+// heap allocations per instance and bytes per instance.
+#include "vm.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <vector>
+
+using namespace lvm;
+
+namespace {
+    size_t allocation_count = 0;
+    size_t allocated_bytes = 0;
+}
+
+// Count every heap allocation made while the benchmark runs
+void* operator new(std::size_t size) {
+    allocation_count++;
+    allocated_bytes += size;
+    if (void* p = std::malloc(size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+int main(int argc, char* argv[]) {
+    size_t instances = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000;
+    if (instances == 0) {
+        std::cerr << "Instance count must be at least 1" << std::endl;
+        return 1;
+    }
+
+    const addr32_t stack_capacity = 4096;
+    const addr32_t code_capacity = 65536;
+    const addr32_t data_capacity = 65536;
+
+    // Footprint of idle instances held at the same time
+    std::vector<std::unique_ptr<vm>> live;
+    live.reserve(instances);
+    size_t count_before = allocation_count;
+    size_t bytes_before = allocated_bytes;
+    for (size_t i = 0; i < instances; ++i) {
+        live.push_back(std::make_unique<vm>(stack_capacity, code_capacity, data_capacity));
+    }
+    double allocations = static_cast<double>(allocation_count - count_before) / instances;
+    double bytes = static_cast<double>(allocated_bytes - bytes_before) / instances;
+    live.clear();
+
+    // Create/destroy throughput
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < instances; ++i) {
+        vm instance(stack_capacity, code_capacity, data_capacity);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(end - start).count();
+
+    std::cout << "sizeof(vm): " << sizeof(vm) << " bytes" << std::endl;
+    std::cout << "Per instance: " << allocations << " allocations, " << bytes << " bytes" << std::endl;
+    std::cout << "Created and destroyed " << instances << " instances in " << seconds << " s ("
+              << (instances / seconds) << " instances/s)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,84 @@
+#include "program_archive.h"
+#include "errors.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace lvm;
+
+void print_usage(const char* program_name) {
+    std::cout << "Usage: " << program_name << " -o <archive> <input.bin | name=input.bin>..." << std::endl;
+    std::cout << "       " << program_name << " -l <archive>" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -o <file>    Pack inputs into archive (member name defaults to file stem)" << std::endl;
+    std::cout << "  -l <file>    List archive members" << std::endl;
+    std::cout << "  -h, --help   Show this help message" << std::endl;
+}
+
+std::vector<byte_t> read_binary(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw runtime_error("Failed to open file: " + filename);
+    }
+    return std::vector<byte_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+int main(int argc, char* argv[]) {
+    std::string output_file;
+    std::string list_file;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            print_usage(argv[0]);
+            return 0;
+        } else if (strcmp(argv[i], "-o") == 0 || strcmp(argv[i], "-l") == 0) {
+            if (i + 1 >= argc) {
+                std::cerr << "Error: " << argv[i] << " requires an argument" << std::endl;
+                return 1;
+            }
+            (argv[i][1] == 'o' ? output_file : list_file) = argv[i + 1];
+            ++i;
+        } else {
+            inputs.push_back(argv[i]);
+        }
+    }
+
+    try {
+        if (!list_file.empty()) {
+            ProgramArchive archive(list_file);
+            for (size_t i = 0; i < archive.size(); ++i) {
+                ArchiveMember member = archive.member(i);
+                std::cout << member.name << "  data " << member.data_segment.size()
+                          << " bytes, code " << member.code_segment.size() << " bytes" << std::endl;
+            }
+            return 0;
+        }
+
+        if (output_file.empty() || inputs.empty()) {
+            std::cerr << "Error: Need -o <archive> and at least one input" << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+
+        std::vector<std::pair<std::string, std::vector<byte_t>>> members;
+        for (const auto& input : inputs) {
+            auto separator = input.find('=');
+            std::string name = separator == std::string::npos
+                ? std::filesystem::path(input).stem().string()
+                : input.substr(0, separator);
+            std::string path = separator == std::string::npos ? input : input.substr(separator + 1);
+            members.emplace_back(name, read_binary(path));
+        }
+        ProgramArchive::write(output_file, members);
+        std::cout << "Packed " << members.size() << " programs into " << output_file << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}